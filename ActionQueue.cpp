@@ -0,0 +1,254 @@
+#include "ActionQueue.h"
+#include "OfflineCache.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUuid>
+
+namespace {
+const int kInitialRetryDelayMs = 1000;
+const int kMaxRetryDelayMs = 60000;
+
+QJsonObject actionToJson(const ActionQueue::Action &action)
+{
+    QJsonObject json;
+    json["id"] = action.id;
+    json["method"] = QString::fromLatin1(action.method);
+    json["url"] = action.url.toString();
+    json["body"] = QString::fromUtf8(action.body);
+    return json;
+}
+}
+
+ActionQueue::ActionQueue(NetworkService *network, const QString &name, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_retryTimer(new QTimer(this))
+    , m_inFlight(0)
+    , m_online(true)
+    , m_waitingForAuth(false)
+{
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/offline";
+    QDir().mkpath(directory);
+    m_journalPath = directory + "/" + name + ".journal";
+
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &ActionQueue::sendNext);
+
+    loadJournal();
+}
+
+ActionQueue::~ActionQueue()
+{
+}
+
+int ActionQueue::pendingCount() const
+{
+    return m_actions.size();
+}
+
+bool ActionQueue::online() const
+{
+    return m_online;
+}
+
+QList<ActionQueue::Action> ActionQueue::pendingActions() const
+{
+    return m_actions;
+}
+
+void ActionQueue::setAuthToken(const QString &token)
+{
+    m_authToken = token;
+    if (m_waitingForAuth && !m_authToken.isEmpty()) {
+        m_waitingForAuth = false;
+        sendNext();
+    }
+}
+
+QString ActionQueue::enqueue(const QByteArray &method, const QUrl &url, const QByteArray &body)
+{
+    Action action;
+    action.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    action.method = method;
+    action.url = url;
+    action.body = body;
+
+    // Journal first, then send: the action survives a crash or restart
+    appendToJournal(action);
+    m_actions.append(action);
+    emit pendingCountChanged();
+
+    sendNext();
+    return action.id;
+}
+
+void ActionQueue::clear()
+{
+    m_retryTimer->stop();
+    if (m_inFlight) {
+        m_network->cancel(m_inFlight);
+        m_inFlight = 0;
+    }
+    m_actions.clear();
+    m_waitingForAuth = false;
+    QFile::remove(m_journalPath);
+    emit pendingCountChanged();
+}
+
+void ActionQueue::flush()
+{
+    m_retryTimer->stop();
+    sendNext();
+}
+
+void ActionQueue::sendNext()
+{
+    // Strictly in order: only the head of the queue is ever on the wire
+    if (m_inFlight || m_actions.isEmpty() || m_waitingForAuth || m_retryTimer->isActive()) {
+        return;
+    }
+
+    const Action &action = m_actions.first();
+    QNetworkRequest request(action.url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    if (!m_authToken.isEmpty()) {
+        request.setRawHeader("Authorization", QString("Bearer %1").arg(m_authToken).toUtf8());
+    }
+    m_sentToken = m_authToken;
+
+    m_inFlight = m_network->send(action.method, request, action.body, NetworkService::Normal, this, [this](QNetworkReply *reply) {
+        handleNetworkReply(reply);
+    });
+}
+
+void ActionQueue::handleNetworkReply(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    m_inFlight = 0;
+
+    if (m_actions.isEmpty()) {
+        return;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (OfflineCache::isConnectivityError(reply) || status >= 500 || status == 408 || status == 429) {
+        setOnline(!OfflineCache::isConnectivityError(reply));
+        m_actions.first().attempts++;
+        scheduleRetry();
+        return;
+    }
+
+    setOnline(true);
+
+    if (status == 401) {
+        // Renewed while this was on the wire: just send it again
+        if (!m_authToken.isEmpty() && m_authToken != m_sentToken) {
+            sendNext();
+            return;
+        }
+        // Hold the queue until a fresh token arrives instead of dropping user actions
+        m_waitingForAuth = true;
+        emit authenticationRequired(m_sentToken);
+        return;
+    }
+
+    const Action action = m_actions.takeFirst();
+    rewriteJournal();
+    emit pendingCountChanged();
+
+    if (reply->error() == QNetworkReply::NoError) {
+        emit actionCompleted(action.id, action.method, action.url, reply->readAll());
+    } else {
+        // The server refused the action; retrying would not help
+        emit actionRejected(action.id, action.method, action.url, reply->errorString());
+    }
+
+    sendNext();
+}
+
+void ActionQueue::scheduleRetry()
+{
+    const int attempts = m_actions.isEmpty() ? 0 : m_actions.first().attempts;
+    const int exponent = qMin(attempts - 1, 6);
+    const int baseDelay = qMin(kInitialRetryDelayMs << qMax(exponent, 0), kMaxRetryDelayMs);
+
+    // +/-20% jitter so many clients coming back online do not retry in lockstep
+    const double jitter = 0.8 + QRandomGenerator::global()->bounded(0.4);
+    m_retryTimer->start(int(baseDelay * jitter));
+}
+
+void ActionQueue::setOnline(bool online)
+{
+    if (m_online != online) {
+        m_online = online;
+        emit onlineChanged();
+    }
+}
+
+void ActionQueue::loadJournal()
+{
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        // A torn final line from a crash mid-append is simply skipped
+        const QJsonObject json = QJsonDocument::fromJson(line).object();
+        if (json.isEmpty()) {
+            continue;
+        }
+
+        Action action;
+        action.id = json["id"].toString();
+        action.method = json["method"].toString().toLatin1();
+        action.url = QUrl(json["url"].toString());
+        action.body = json["body"].toString().toUtf8();
+        m_actions.append(action);
+    }
+
+    if (!m_actions.isEmpty()) {
+        emit pendingCountChanged();
+        QTimer::singleShot(0, this, &ActionQueue::sendNext);
+    }
+}
+
+void ActionQueue::appendToJournal(const Action &action)
+{
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return;
+    }
+    file.write(QJsonDocument(actionToJson(action)).toJson(QJsonDocument::Compact));
+    file.write("\n");
+    file.flush();
+}
+
+void ActionQueue::rewriteJournal()
+{
+    if (m_actions.isEmpty()) {
+        QFile::remove(m_journalPath);
+        return;
+    }
+
+    QSaveFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    for (const Action &action : m_actions) {
+        file.write(QJsonDocument(actionToJson(action)).toJson(QJsonDocument::Compact));
+        file.write("\n");
+    }
+    file.commit();
+}
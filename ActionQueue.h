@@ -0,0 +1,72 @@
+#ifndef ACTIONQUEUE_H
+#define ACTIONQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QNetworkReply>
+#include <QTimer>
+#include <QUrl>
+#include "NetworkService.h"
+
+// Durable write-ahead queue for user mutations (favorite add/remove...).
+// Every action is journaled to disk before it is sent and replayed strictly
+// in order, with exponential backoff while the backend is unreachable.
+class ActionQueue : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int pendingCount READ pendingCount NOTIFY pendingCountChanged)
+    Q_PROPERTY(bool online READ online NOTIFY onlineChanged)
+
+public:
+    struct Action {
+        QString id;
+        QByteArray method;
+        QUrl url;
+        QByteArray body;
+        int attempts = 0;
+    };
+
+    explicit ActionQueue(NetworkService *network, const QString &name, QObject *parent = nullptr);
+    ~ActionQueue();
+
+    int pendingCount() const;
+    bool online() const;
+    QList<Action> pendingActions() const;
+
+    void setAuthToken(const QString &token);
+    QString enqueue(const QByteArray &method, const QUrl &url, const QByteArray &body = QByteArray());
+    void clear();
+
+public slots:
+    void flush();
+
+signals:
+    void pendingCountChanged();
+    void onlineChanged();
+    void actionCompleted(const QString &id, const QByteArray &method, const QUrl &url, const QByteArray &response);
+    void actionRejected(const QString &id, const QByteArray &method, const QUrl &url, const QString &error);
+    // The head action was refused with this token; the queue waits for setAuthToken()
+    void authenticationRequired(const QString &token);
+
+private:
+    NetworkService *m_network;
+    QTimer *m_retryTimer;
+    QList<Action> m_actions;
+    QString m_journalPath;
+    QString m_authToken;
+    // The token the in-flight action went out with
+    QString m_sentToken;
+    quint64 m_inFlight;
+    bool m_online;
+    bool m_waitingForAuth;
+
+    void sendNext();
+    void handleNetworkReply(QNetworkReply *reply);
+    void scheduleRetry();
+    void setOnline(bool online);
+    void loadJournal();
+    void appendToJournal(const Action &action);
+    void rewriteJournal();
+};
+
+#endif // ACTIONQUEUE_H
@@ -0,0 +1,101 @@
+#include "ApiBatch.h"
+#include <QJsonDocument>
+#include <QUrlQuery>
+
+void ApiBatch::add(const QString &id, const QString &op, const QJsonObject &params)
+{
+    QJsonObject request;
+    request["id"] = id;
+    request["op"] = op;
+    if (!params.isEmpty()) {
+        request["params"] = params;
+    }
+    m_requests.append(request);
+    m_ids.append(id);
+}
+
+bool ApiBatch::isEmpty() const
+{
+    return m_ids.isEmpty();
+}
+
+QStringList ApiBatch::ids() const
+{
+    return m_ids;
+}
+
+QByteArray ApiBatch::body() const
+{
+    QJsonObject json;
+    json["requests"] = m_requests;
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+ApiBatch::Responses ApiBatch::split(const NetworkResponse &response) const
+{
+    Responses responses;
+
+    const QJsonObject results = response.json().object()["responses"].toObject();
+    for (const QString &id : m_ids) {
+        if (!response.ok()) {
+            // Offline, timed out or rejected: each part falls back as its own request would
+            responses.insert(id, response);
+        } else if (!results.contains(id)) {
+            NetworkResponse missing = response;
+            missing.error = QNetworkReply::UnknownContentError;
+            missing.body.clear();
+            missing.errorString = "Missing from batch response";
+            responses.insert(id, missing);
+        } else {
+            responses.insert(id, part(response, results[id].toObject()));
+        }
+    }
+    return responses;
+}
+
+NetworkResponse ApiBatch::part(const NetworkResponse &batch, const QJsonObject &result)
+{
+    NetworkResponse response;
+    response.url = batch.url;
+    response.status = result["status"].toInt();
+
+    const QJsonValue body = result["body"];
+    if (body.isArray()) {
+        response.body = QJsonDocument(body.toArray()).toJson(QJsonDocument::Compact);
+    } else if (body.isObject()) {
+        response.body = QJsonDocument(body.toObject()).toJson(QJsonDocument::Compact);
+    }
+
+    // Same errors QNetworkReply reports for these statuses on a plain request
+    if (response.status >= 200 && response.status < 300) {
+        return response;
+    }
+    switch (response.status) {
+    case 401:
+        response.error = QNetworkReply::AuthenticationRequiredError;
+        break;
+    case 403:
+        response.error = QNetworkReply::ContentAccessDenied;
+        break;
+    case 404:
+        response.error = QNetworkReply::ContentNotFoundError;
+        break;
+    default:
+        response.error = response.status >= 500 ? QNetworkReply::InternalServerError
+                                                : QNetworkReply::UnknownContentError;
+        break;
+    }
+    response.errorString = result["error"].toString();
+    return response;
+}
+
+QJsonObject ApiBatch::paramsOf(const QUrl &url)
+{
+    QJsonObject params;
+    const QList<QPair<QString, QString>> items = QUrlQuery(url).queryItems(QUrl::FullyDecoded);
+    // Kept as text, exactly as the GET would send them; the server converts
+    for (const QPair<QString, QString> &item : items) {
+        params[item.first] = item.second;
+    }
+    return params;
+}
@@ -0,0 +1,37 @@
+#ifndef APIBATCH_H
+#define APIBATCH_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+#include <QUrl>
+#include "AsyncReply.h"
+
+// Sub-requests for the backend's POST /batch endpoint, which answers several
+// reads in one round trip. Each part comes back as its own NetworkResponse,
+// so the code handling the equivalent GET can take it unchanged; when the
+// batch as a whole fails, every part carries that failure.
+class ApiBatch
+{
+public:
+    using Responses = QHash<QString, NetworkResponse>;
+
+    void add(const QString &id, const QString &op, const QJsonObject &params = QJsonObject());
+    bool isEmpty() const;
+    QStringList ids() const;
+    QByteArray body() const;
+
+    Responses split(const NetworkResponse &response) const;
+
+    // The query of an equivalent GET as sub-request parameters
+    static QJsonObject paramsOf(const QUrl &url);
+
+private:
+    QJsonArray m_requests;
+    QStringList m_ids;
+
+    static NetworkResponse part(const NetworkResponse &batch, const QJsonObject &result);
+};
+
+#endif // APIBATCH_H
@@ -4,33 +4,101 @@
 #include <QJsonArray>
 #include <QUrlQuery>
 #include <QSettings>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+// Requests are snapped to a ~1 km grid so prefetched and live queries share cache keys
+const double kTileDegrees = 0.01;
+// Half the cell diagonal: what snapping can move the query centre by
+const int kTileSlackMeters = 800;
+
+// Typeahead shows this many local matches and asks the server below the threshold
+const int kTypeaheadLimit = 50;
+const int kTypeaheadServerThreshold = 5;
+const int kTypeaheadDebounceMs = 300;
+
+// The user is waiting on these
+const int kInteractiveTimeoutMs = 15000;
+// Refreshes may sit behind other traffic in the scheduler
+const int kBackgroundTimeoutMs = 30000;
+
+double snapToTile(double degrees)
+{
+    return qRound(degrees / kTileDegrees) * kTileDegrees;
+}
+
+QVector<RestaurantModel::Row> rowsOf(const QJsonArray &results)
+{
+    QVector<RestaurantModel::Row> rows;
+    rows.reserve(results.size());
+    for (const QJsonValue &value : results) {
+        const QJsonObject obj = value.toObject();
+        rows.append({ obj["id"].toString(), obj["distance"].toDouble(0.0) });
+    }
+    return rows;
+}
+}
 
-AppController::AppController(QObject *parent)
+AppController::AppController(NetworkService *network, RestaurantStore *store, LocationService *location,
+                             TokenManager *tokens, QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
-    , m_positionSource(QGeoPositionInfoSource::createDefaultSource(this))
-    , m_restaurantModel(new RestaurantModel(this))
+    , m_network(network)
+    , m_store(store)
+    , m_location(location)
+    , m_tokens(tokens)
+    , m_deferredStarted(false)
+    , m_restaurantModel(new RestaurantModel(store, this))
+    , m_favoritesModel(new RestaurantModel(store, this))
     , m_loading(false)
     , m_error("")
     , m_locationPermissionGranted(false)
     , m_userLatitude(0.0)
     , m_userLongitude(0.0)
     , m_baseUrl("http://localhost:8000/api")
-    , m_authToken("")
-    , m_isAuthenticated(false)
+    , m_offline(false)
+    , m_hasLiveResults(false)
+    , m_showingNearby(true)
+    , m_offlineCache("restaurants")
+    , m_prefetchEngine(new PrefetchEngine(network, &m_offlineCache, this))
+    , m_resultRadius(5000)
+    , m_typeaheadTimer(new QTimer(this))
 {
-    connect(m_networkManager, &QNetworkAccessManager::finished, this, &AppController::handleNetworkReply);
+    m_prefetchEngine->setRequestFactory([this](const QUrl &url) {
+        return createRequest(url);
+    });
+    // Prefetched areas feed the local search index too
+    connect(m_prefetchEngine, &PrefetchEngine::prefetched, this, [this](const QUrl &, const QByteArray &data) {
+        m_store->ingest(QJsonDocument::fromJson(data).array());
+    });
 
-    if (m_positionSource) {
-        connect(m_positionSource, &QGeoPositionInfoSource::positionUpdated, this, &AppController::onPositionUpdated);
-        connect(m_positionSource, &QGeoPositionInfoSource::errorOccurred, this, &AppController::onPositionError);
-    }
+    m_favoritesModel->setFollowFavorites(true);
+
+    m_typeaheadTimer->setSingleShot(true);
+    m_typeaheadTimer->setInterval(kTypeaheadDebounceMs);
+    connect(m_typeaheadTimer, &QTimer::timeout, this, [this]() {
+        searchRestaurants(m_typeaheadQuery);
+    });
 
     // Restore settings
     QSettings settings;
     m_locationPermissionGranted = settings.value("locationPermission", false).toBool();
-    m_authToken = settings.value("authToken", "").toString();
-    m_isAuthenticated = !m_authToken.isEmpty();
+
+    connect(m_location, &LocationService::positionChanged, this, &AppController::onPositionChanged);
+    connect(m_location, &LocationService::movedSignificantly, this, &AppController::onMovedSignificantly);
+    connect(m_location, &LocationService::errorOccurred, this, &AppController::setError);
+
+    // Where the previous run left off: searches can start before any fix
+    if (m_locationPermissionGranted && m_location->hasPosition()) {
+        m_userLatitude = m_location->coordinate().latitude();
+        m_userLongitude = m_location->coordinate().longitude();
+    }
+
+    // Show the last list we saw until the backend answers
+    const QByteArray cached = m_offlineCache.load("nearby/last");
+    if (!cached.isEmpty()) {
+        handleRestaurantResponse(QJsonDocument::fromJson(cached));
+    }
 }
 
 AppController::~AppController()
@@ -52,6 +120,11 @@ RestaurantModel* AppController::restaurantModel()
     return m_restaurantModel;
 }
 
+RestaurantModel* AppController::favoritesModel()
+{
+    return m_favoritesModel;
+}
+
 bool AppController::locationPermissionGranted() const
 {
     return m_locationPermissionGranted;
@@ -64,10 +137,10 @@ void AppController::setLocationPermissionGranted(bool granted)
         QSettings settings;
         settings.setValue("locationPermission", granted);
 
-        if (granted && m_positionSource) {
-            m_positionSource->startUpdates();
-        } else if (m_positionSource) {
-            m_positionSource->stopUpdates();
+        if (granted && m_deferredStarted) {
+            m_location->start();
+        } else if (!granted) {
+            m_location->stop();
         }
 
         emit locationPermissionGrantedChanged();
@@ -84,20 +157,37 @@ double AppController::userLongitude() const
     return m_userLongitude;
 }
 
-QString AppController::authToken() const
+bool AppController::offline() const
 {
-    return m_authToken;
+    return m_offline;
 }
 
-bool AppController::isAuthenticated() const
+bool AppController::hasLocation() const
 {
-    return m_isAuthenticated;
+    return m_userLatitude != 0.0 || m_userLongitude != 0.0;
+}
+
+void AppController::startDeferred()
+{
+    if (m_deferredStarted) {
+        return;
+    }
+    m_deferredStarted = true;
+
+    // Plugin loading and connection setup are kept off the path to the first frame
+    m_network->prewarm(QUrl(m_baseUrl));
+    initialize();
+}
+
+void AppController::setBaseUrl(const QString &url)
+{
+    m_baseUrl = url;
 }
 
 void AppController::initialize()
 {
-    if (m_locationPermissionGranted && m_positionSource) {
-        m_positionSource->startUpdates();
+    if (m_locationPermissionGranted && m_deferredStarted) {
+        m_location->start();
     }
 }
 
@@ -108,31 +198,71 @@ void AppController::searchRestaurants(const QString &query, int radius, const QS
         return;
     }
 
+    m_resultRadius = radius;
+    m_showingNearby = false;
+    m_prefetchEngine->noteActivity();
+
+    const QUrl url = searchUrl({query, radius, cuisineType, rating}, m_userLatitude, m_userLongitude);
+    if (serveFromCache(url)) {
+        return;
+    }
+
     setLoading(true);
+    runRestaurantFetch(url, NetworkService::Interactive);
+}
 
-    QUrl url(m_baseUrl + "/restaurants/search");
-    QUrlQuery urlQuery;
-    urlQuery.addQueryItem("latitude", QString::number(m_userLatitude));
-    urlQuery.addQueryItem("longitude", QString::number(m_userLongitude));
-    urlQuery.addQueryItem("radius", QString::number(radius));
+void AppController::typeahead(const QString &text)
+{
+    m_typeaheadTimer->stop();
 
-    if (!query.isEmpty()) {
-        urlQuery.addQueryItem("query", query);
+    if (SearchIndex::fold(text).isEmpty()) {
+        refreshRestaurants();
+        return;
     }
 
-    if (!cuisineType.isEmpty()) {
-        urlQuery.addQueryItem("cuisine", cuisineType);
+    // Answer from the local index on every keystroke
+    const bool hasLocation = m_userLatitude != 0.0 || m_userLongitude != 0.0;
+    const QGeoCoordinate origin(m_userLatitude, m_userLongitude);
+    const QVector<SearchIndex::Match> matches = m_store->search(text, kTypeaheadLimit);
+
+    QVector<RestaurantModel::Row> rows;
+    rows.reserve(matches.size());
+    for (const SearchIndex::Match &match : matches) {
+        const Restaurant *restaurant = m_store->find(match.id);
+        if (!restaurant) {
+            continue;
+        }
+        double distance = restaurant->distance;
+        if (hasLocation) {
+            distance = origin.distanceTo(QGeoCoordinate(restaurant->latitude, restaurant->longitude));
+            if (distance > m_resultRadius) {
+                continue;
+            }
+        }
+        rows.append({ match.id, distance });
     }
+    m_showingNearby = false;
+    m_restaurantModel->setRows(rows);
 
-    if (rating > 0) {
-        urlQuery.addQueryItem("min_rating", QString::number(rating));
+    // Only go to the server when the local set cannot answer the query
+    if (rows.size() < kTypeaheadServerThreshold && SearchIndex::fold(text).size() >= 3) {
+        m_typeaheadQuery = text;
+        m_typeaheadTimer->start();
     }
+}
 
-    url.setQuery(urlQuery);
-
-    QNetworkRequest request = createRequest(url);
+void AppController::prefetchSearch(const QString &query, int radius, const QString &cuisineType, int rating)
+{
+    for (const SearchSpec &spec : qAsConst(m_prefetchSearches)) {
+        if (spec.query == query && spec.radius == radius && spec.cuisineType == cuisineType && spec.rating == rating) {
+            return;
+        }
+    }
+    m_prefetchSearches.append({query, radius, cuisineType, rating});
 
-    m_networkManager->get(request);
+    // Force a reschedule for the current area
+    m_prefetchTile.clear();
+    scheduleAreaPrefetch();
 }
 
 void AppController::refreshRestaurants()
@@ -154,171 +284,168 @@ QNetworkRequest AppController::createRequest(const QUrl &url)
 {
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    if (!m_authToken.isEmpty()) {
-        request.setRawHeader("Authorization", QString("Bearer %1").arg(m_authToken).toUtf8());
-    }
+    m_tokens->authorize(request);
     return request;
 }
 
-void AppController::login(const QString &username, const QString &password)
+void AppController::handleRestaurantResponse(const QJsonDocument &doc)
 {
-    setLoading(true);
-
-    QUrl url(m_baseUrl + "/auth/login");
-    QNetworkRequest request = createRequest(url);
-
-    QJsonObject json;
-    json["username"] = username;
-    json["password"] = password;
+    if (doc.isNull()) {
+        setError("Invalid response from server");
+        return;
+    }
 
-    QNetworkReply *reply = m_networkManager->post(request, QJsonDocument(json).toJson());
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        handleAuthResponse(QJsonDocument::fromJson(reply->readAll()));
-        reply->deleteLater();
-    });
-}
+    const QJsonArray results = doc.isArray() ? doc.array() : doc.object()["results"].toArray();
+    m_store->ingest(results);
 
-void AppController::logout()
-{
-    setAuthToken("");
-    setAuthenticated(false);
-    QSettings settings;
-    settings.remove("authToken");
+    if (doc.isArray() || (doc.isObject() && doc.object().contains("results"))) {
+        m_restaurantModel->setRows(rowsOf(localizeResults(results)));
+    }
 }
 
-void AppController::registerUser(const QString &username, const QString &password, const QString &email)
+QVector<RestaurantModel::Row> AppController::localNearby() const
 {
-    setLoading(true);
-
-    QUrl url(m_baseUrl + "/auth/register");
-    QNetworkRequest request = createRequest(url);
+    QVector<RestaurantModel::Row> rows;
+    if (m_userLatitude == 0.0 && m_userLongitude == 0.0) {
+        return rows;
+    }
 
-    QJsonObject json;
-    json["username"] = username;
-    json["password"] = password;
-    json["email"] = email;
+    // Merge the geohash cells around us instead of scanning the whole catalog
+    const QGeoCoordinate origin(m_userLatitude, m_userLongitude);
+    const QVector<QString> ids = m_store->candidates(m_userLatitude, m_userLongitude, m_resultRadius);
+    rows.reserve(ids.size());
+    for (const QString &id : ids) {
+        const Restaurant *restaurant = m_store->find(id);
+        if (!restaurant) {
+            continue;
+        }
+        const double distance = origin.distanceTo(QGeoCoordinate(restaurant->latitude, restaurant->longitude));
+        if (distance <= m_resultRadius) {
+            rows.append({ id, distance });
+        }
+    }
 
-    QNetworkReply *reply = m_networkManager->post(request, QJsonDocument(json).toJson());
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        handleAuthResponse(QJsonDocument::fromJson(reply->readAll()));
-        reply->deleteLater();
+    std::sort(rows.begin(), rows.end(), [](const RestaurantModel::Row &a, const RestaurantModel::Row &b) {
+        return a.distance < b.distance;
     });
+    return rows;
 }
 
-void AppController::handleAuthResponse(const QJsonDocument &doc)
+QJsonArray AppController::localizeResults(const QJsonArray &results) const
 {
-    setLoading(false);
-
-    if (doc.isNull()) {
-        emit loginFailed("Invalid response from server");
-        return;
+    if (m_userLatitude == 0.0 && m_userLongitude == 0.0) {
+        return results;
     }
 
-    QJsonObject obj = doc.object();
-    if (obj.contains("error")) {
-        emit loginFailed(obj["error"].toString());
-        return;
+    // Cached and snapped responses were computed for another centre: redo distances from here
+    const QGeoCoordinate origin(m_userLatitude, m_userLongitude);
+    QList<QJsonObject> rows;
+    rows.reserve(results.size());
+    for (const QJsonValue &value : results) {
+        QJsonObject obj = value.toObject();
+        const double distance = origin.distanceTo(QGeoCoordinate(obj["latitude"].toDouble(), obj["longitude"].toDouble()));
+        if (distance > m_resultRadius) {
+            continue;
+        }
+        obj["distance"] = distance;
+        rows.append(obj);
     }
 
-    if (obj.contains("token")) {
-        setAuthToken(obj["token"].toString());
-        setAuthenticated(true);
-        QSettings settings;
-        settings.setValue("authToken", m_authToken);
-        emit loginSuccessful();
+    std::sort(rows.begin(), rows.end(), [](const QJsonObject &a, const QJsonObject &b) {
+        return a["distance"].toDouble() < b["distance"].toDouble();
+    });
+
+    QJsonArray localized;
+    for (const QJsonObject &obj : qAsConst(rows)) {
+        localized.append(obj);
     }
+    return localized;
 }
 
-void AppController::handleRestaurantResponse(const QJsonDocument &doc)
+AsyncFlow AppController::runRestaurantFetch(QUrl url, NetworkService::Priority priority)
 {
-    if (doc.isNull()) {
-        setError("Invalid response from server");
-        return;
-    }
-
-    if (doc.isArray()) {
-        m_restaurantModel->updateFromJson(doc.array());
-    } else if (doc.isObject() && doc.object().contains("results")) {
-        m_restaurantModel->updateFromJson(doc.object()["results"].toArray());
-    }
+    // The newest list request wins; an older answer would overwrite it
+    m_restaurantRequest.cancel();
+    AsyncReply fetch = AsyncReply::get(m_network, createRequest(url), priority, this,
+                                       priority == NetworkService::Interactive ? kInteractiveTimeoutMs
+                                                                               : kBackgroundTimeoutMs);
+    m_restaurantRequest = fetch;
+    // A nearby answer still due from a batch is older than this request
+    m_batchNearbyUrl.clear();
+
+    applyRestaurantResponse(url, co_await fetch);
 }
 
-void AppController::handleNetworkReply(QNetworkReply *reply)
+void AppController::applyRestaurantResponse(const QUrl &url, const NetworkResponse &response)
 {
+    if (response.cancelled) {
+        return;
+    }
     setLoading(false);
 
-    if (reply->error() != QNetworkReply::NoError) {
-        if (reply->error() == QNetworkReply::AuthenticationRequiredError) {
-            setAuthenticated(false);
-            setAuthToken("");
-            QSettings settings;
-            settings.remove("authToken");
-            emit loginFailed("Session expired. Please login again.");
-        } else {
-            setError("Network error: " + reply->errorString());
+    if (!response.ok()) {
+        if (response.connectivityError) {
+            setOffline(true);
+
+            // Serve the cached copy of this query, else what we know around here, else the last list
+            QByteArray cached = m_offlineCache.load(url.toString());
+            if (cached.isEmpty() && url.path().endsWith("/nearby")) {
+                const QVector<RestaurantModel::Row> local = localNearby();
+                if (!local.isEmpty()) {
+                    m_restaurantModel->setRows(local);
+                    return;
+                }
+            }
+            if (cached.isEmpty()) {
+                cached = m_offlineCache.load("nearby/last");
+            }
+            if (!cached.isEmpty()) {
+                handleRestaurantResponse(QJsonDocument::fromJson(cached));
+                return;
+            }
         }
-        reply->deleteLater();
+
+        setError("Network error: " + response.errorString);
         return;
     }
 
-    QByteArray data = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-
-    if (reply->url().toString().contains("/auth")) {
-        handleAuthResponse(doc);
-    } else if (reply->url().toString().contains("/restaurants")) {
-        handleRestaurantResponse(doc);
+    setOffline(false);
+    const QJsonDocument doc = response.json();
+    if (!doc.isNull()) {
+        m_hasLiveResults = true;
+        m_offlineCache.store(url.toString(), response.body);
+        if (url.path().endsWith("/nearby")) {
+            m_offlineCache.store("nearby/last", response.body);
+        }
     }
-
-    reply->deleteLater();
+    handleRestaurantResponse(doc);
 }
 
-void AppController::setAuthToken(const QString &token)
+void AppController::setOffline(bool offline)
 {
-    if (m_authToken != token) {
-        m_authToken = token;
-        emit authTokenChanged();
+    if (m_offline != offline) {
+        m_offline = offline;
+        emit offlineChanged();
     }
 }
 
-void AppController::setAuthenticated(bool authenticated)
+void AppController::onPositionChanged()
 {
-    if (m_isAuthenticated != authenticated) {
-        m_isAuthenticated = authenticated;
-        emit isAuthenticatedChanged();
-    }
+    // Every refinement updates distances; only real moves refetch
+    const QGeoCoordinate coordinate = m_location->coordinate();
+    updateUserLocation(coordinate.latitude(), coordinate.longitude());
 }
 
-void AppController::onPositionUpdated(const QGeoPositionInfo &info)
+void AppController::onMovedSignificantly()
 {
-    QGeoCoordinate coord = info.coordinate();
-    updateUserLocation(coord.latitude(), coord.longitude());
+    scheduleAreaPrefetch();
 
-    // Initial fetch once we have location
-    if (m_restaurantModel->rowCount() == 0) {
+    // Follow the user with nearby results, but never replace a search they ran
+    if (m_showingNearby || !m_hasLiveResults) {
         fetchNearbyRestaurants();
     }
 }
 
-void AppController::onPositionError(QGeoPositionInfoSource::Error error)
-{
-    QString errorMsg;
-
-    switch (error) {
-    case QGeoPositionInfoSource::AccessError:
-        errorMsg = "Location access denied. Please check your permissions.";
-        break;
-    case QGeoPositionInfoSource::ClosedError:
-        errorMsg = "Location service has been closed.";
-        break;
-    default:
-        errorMsg = "Location service error occurred.";
-        break;
-    }
-
-    setError(errorMsg);
-}
-
 void AppController::setLoading(bool loading)
 {
     if (m_loading != loading) {
@@ -345,21 +472,149 @@ void AppController::updateUserLocation(double latitude, double longitude)
 }
 
 void AppController::fetchNearbyRestaurants()
+{
+    QUrl url;
+    if (prepareNearby(&url)) {
+        runRestaurantFetch(url, NetworkService::Normal);
+    }
+}
+
+bool AppController::prepareNearby(QUrl *url)
 {
     if (m_userLatitude == 0.0 && m_userLongitude == 0.0) {
-        return;
+        return false;
+    }
+
+    m_resultRadius = 5000;  // Default 5km radius
+    m_showingNearby = true;
+    m_prefetchEngine->noteActivity();
+
+    *url = nearbyUrl(m_userLatitude, m_userLongitude, m_resultRadius);
+    if (serveFromCache(*url)) {
+        return false;
+    }
+
+    // Prefetched neighbouring areas usually cover this spot already
+    const QVector<RestaurantModel::Row> local = localNearby();
+    if (!local.isEmpty()) {
+        m_restaurantModel->setRows(local);
     }
 
     setLoading(true);
+    return true;
+}
+
+void AppController::appendBatch(ApiBatch &batch)
+{
+    QUrl url;
+    if (!prepareNearby(&url)) {
+        return;
+    }
+
+    // The batch answer replaces the list, so nothing older may land after it
+    m_restaurantRequest.cancel();
+    m_batchNearbyUrl = url;
+    batch.add("nearby", "nearby", ApiBatch::paramsOf(url));
+}
+
+void AppController::applyBatch(const ApiBatch::Responses &responses)
+{
+    // Superseded by a newer list request while the batch was out
+    if (m_batchNearbyUrl.isEmpty() || !responses.contains("nearby")) {
+        return;
+    }
+
+    // Cached under the GET's URL, so offline and freshness checks find it either way
+    const QUrl url = m_batchNearbyUrl;
+    m_batchNearbyUrl.clear();
+    applyRestaurantResponse(url, responses.value("nearby"));
+}
 
+QUrl AppController::searchUrl(const SearchSpec &spec, double latitude, double longitude) const
+{
+    QUrl url(m_baseUrl + "/restaurants/search");
+    QUrlQuery urlQuery;
+    urlQuery.addQueryItem("latitude", QString::number(snapToTile(latitude), 'f', 4));
+    urlQuery.addQueryItem("longitude", QString::number(snapToTile(longitude), 'f', 4));
+    urlQuery.addQueryItem("radius", QString::number(spec.radius + kTileSlackMeters));
+
+    if (!spec.query.isEmpty()) {
+        urlQuery.addQueryItem("query", spec.query);
+    }
+
+    if (!spec.cuisineType.isEmpty()) {
+        urlQuery.addQueryItem("cuisine", spec.cuisineType);
+    }
+
+    if (spec.rating > 0) {
+        urlQuery.addQueryItem("min_rating", QString::number(spec.rating));
+    }
+
+    // Lists only need the slim rows; details come per restaurant when opened
+    urlQuery.addQueryItem("fields", "list");
+    url.setQuery(urlQuery);
+    return url;
+}
+
+QUrl AppController::nearbyUrl(double latitude, double longitude, int radius) const
+{
     QUrl url(m_baseUrl + "/restaurants/nearby");
     QUrlQuery urlQuery;
-    urlQuery.addQueryItem("latitude", QString::number(m_userLatitude));
-    urlQuery.addQueryItem("longitude", QString::number(m_userLongitude));
-    urlQuery.addQueryItem("radius", "5000");  // Default 5km radius
+    urlQuery.addQueryItem("latitude", QString::number(snapToTile(latitude), 'f', 4));
+    urlQuery.addQueryItem("longitude", QString::number(snapToTile(longitude), 'f', 4));
+    urlQuery.addQueryItem("radius", QString::number(radius + kTileSlackMeters));
+    urlQuery.addQueryItem("fields", "list");
     url.setQuery(urlQuery);
+    return url;
+}
+
+bool AppController::serveFromCache(const QUrl &url)
+{
+    const QByteArray cached = m_offlineCache.load(url.toString());
+    if (cached.isEmpty()) {
+        return false;
+    }
+
+    // Show what we have right away; only skip the network if it is still fresh
+    handleRestaurantResponse(QJsonDocument::fromJson(cached));
+    if (!m_prefetchEngine->isFresh(url)) {
+        return false;
+    }
+    // Fresh: an older request still in flight must not replace this list
+    m_restaurantRequest.cancel();
+    m_batchNearbyUrl.clear();
+    setLoading(false);
+    m_hasLiveResults = true;
+    return true;
+}
 
-    QNetworkRequest request = createRequest(url);
+void AppController::scheduleAreaPrefetch()
+{
+    if (m_userLatitude == 0.0 && m_userLongitude == 0.0) {
+        return;
+    }
+
+    const double tileLatitude = snapToTile(m_userLatitude);
+    const double tileLongitude = snapToTile(m_userLongitude);
+    const QString tile = QString::number(tileLatitude, 'f', 4) + "," + QString::number(tileLongitude, 'f', 4);
+    if (tile == m_prefetchTile) {
+        return;
+    }
+    m_prefetchTile = tile;
+
+    // Most likely next taps first: the quick filters here, then the surrounding cells
+    QList<QUrl> urls;
+    for (const SearchSpec &spec : qAsConst(m_prefetchSearches)) {
+        urls.append(searchUrl(spec, tileLatitude, tileLongitude));
+    }
+    urls.append(nearbyUrl(tileLatitude, tileLongitude, 5000));
+    for (int dLat = -1; dLat <= 1; ++dLat) {
+        for (int dLon = -1; dLon <= 1; ++dLon) {
+            if (dLat != 0 || dLon != 0) {
+                urls.append(nearbyUrl(tileLatitude + dLat * kTileDegrees, tileLongitude + dLon * kTileDegrees, 5000));
+            }
+        }
+    }
 
-    m_networkManager->get(request);
+    m_prefetchEngine->schedule(urls);
 }
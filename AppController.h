@@ -2,11 +2,16 @@
 #define APPCONTROLLER_H
 
 #include <QObject>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
-#include <QGeoPositionInfoSource>
-#include <QGeoPositionInfo>
 #include "ResturantModel.h"
+#include "RestaurantStore.h"
+#include "OfflineCache.h"
+#include "NetworkService.h"
+#include "ApiBatch.h"
+#include "AsyncReply.h"
+#include "LocationService.h"
+#include "TokenManager.h"
+#include "PrefetchEngine.h"
 
 class AppController : public QObject
 {
@@ -14,75 +19,110 @@ class AppController : public QObject
     Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
     Q_PROPERTY(QString error READ error NOTIFY errorChanged)
     Q_PROPERTY(RestaurantModel* restaurantModel READ restaurantModel CONSTANT)
+    Q_PROPERTY(RestaurantModel* favoritesModel READ favoritesModel CONSTANT)
     Q_PROPERTY(bool locationPermissionGranted READ locationPermissionGranted WRITE setLocationPermissionGranted NOTIFY locationPermissionGrantedChanged)
     Q_PROPERTY(double userLatitude READ userLatitude NOTIFY userLocationChanged)
     Q_PROPERTY(double userLongitude READ userLongitude NOTIFY userLocationChanged)
-    Q_PROPERTY(QString authToken READ authToken NOTIFY authTokenChanged)
-    Q_PROPERTY(bool isAuthenticated READ isAuthenticated NOTIFY isAuthenticatedChanged)
+    Q_PROPERTY(bool offline READ offline NOTIFY offlineChanged)
 
 public:
-    explicit AppController(QObject *parent = nullptr);
+    AppController(NetworkService *network, RestaurantStore *store, LocationService *location,
+                  TokenManager *tokens, QObject *parent = nullptr);
     ~AppController();
 
     bool loading() const;
     QString error() const;
     RestaurantModel* restaurantModel();
+    RestaurantModel* favoritesModel();
     bool locationPermissionGranted() const;
     void setLocationPermissionGranted(bool granted);
     double userLatitude() const;
     double userLongitude() const;
-    QString authToken() const;
-    bool isAuthenticated() const;
+    bool offline() const;
+    bool hasLocation() const;
+
+    // Starts positioning and warms up connections; call after the first frame
+    void startDeferred();
+    // Backend the list and search requests go to
+    void setBaseUrl(const QString &url);
+
+    // Nearby as part of a combined request, and its answer
+    void appendBatch(ApiBatch &batch);
+    void applyBatch(const ApiBatch::Responses &responses);
 
 public slots:
     void initialize();
     void searchRestaurants(const QString &query, int radius = 5000, const QString &cuisineType = "", int rating = 0);
+    void typeahead(const QString &text);
+    void prefetchSearch(const QString &query, int radius = 5000, const QString &cuisineType = "", int rating = 0);
     void refreshRestaurants();
     void clearError();
     void requestLocationPermission();
-    void login(const QString &username, const QString &password);
-    void logout();
-    void registerUser(const QString &username, const QString &password, const QString &email);
 
 signals:
     void loadingChanged();
     void errorChanged();
     void locationPermissionGrantedChanged();
     void userLocationChanged();
-    void authTokenChanged();
-    void isAuthenticatedChanged();
-    void loginSuccessful();
-    void loginFailed(const QString &error);
-    void registrationSuccessful();
-    void registrationFailed(const QString &error);
+    void offlineChanged();
 
 private slots:
-    void handleNetworkReply(QNetworkReply *reply);
-    void onPositionUpdated(const QGeoPositionInfo &info);
-    void onPositionError(QGeoPositionInfoSource::Error error);
+    void onPositionChanged();
+    void onMovedSignificantly();
 
 private:
-    QNetworkAccessManager *m_networkManager;
-    QGeoPositionInfoSource *m_positionSource;
+    struct SearchSpec {
+        QString query;
+        int radius;
+        QString cuisineType;
+        int rating;
+    };
+
+    NetworkService *m_network;
+    RestaurantStore *m_store;
+    LocationService *m_location;
+    TokenManager *m_tokens;
+    bool m_deferredStarted;
     RestaurantModel *m_restaurantModel;
+    RestaurantModel *m_favoritesModel;
     bool m_loading;
     QString m_error;
     bool m_locationPermissionGranted;
     double m_userLatitude;
     double m_userLongitude;
     QString m_baseUrl;
-    QString m_authToken;
-    bool m_isAuthenticated;
+    bool m_offline;
+    bool m_hasLiveResults;
+    // The list shows nearby results, so it follows the user as they move
+    bool m_showingNearby;
+    OfflineCache m_offlineCache;
+    PrefetchEngine *m_prefetchEngine;
+    QList<SearchSpec> m_prefetchSearches;
+    QString m_prefetchTile;
+    int m_resultRadius;
+    QTimer *m_typeaheadTimer;
+    QString m_typeaheadQuery;
+    // In-flight list request; a newer one supersedes it
+    AsyncReply m_restaurantRequest;
+    // Nearby sent in a batch and not yet answered or superseded
+    QUrl m_batchNearbyUrl;
 
     void setLoading(bool loading);
     void setError(const QString &error);
     void updateUserLocation(double latitude, double longitude);
     void fetchNearbyRestaurants();
-    void setAuthToken(const QString &token);
-    void setAuthenticated(bool authenticated);
+    bool prepareNearby(QUrl *url);
+    QUrl searchUrl(const SearchSpec &spec, double latitude, double longitude) const;
+    QUrl nearbyUrl(double latitude, double longitude, int radius) const;
+    bool serveFromCache(const QUrl &url);
+    void scheduleAreaPrefetch();
+    void setOffline(bool offline);
     QNetworkRequest createRequest(const QUrl &url);
-    void handleAuthResponse(const QJsonDocument &doc);
+    AsyncFlow runRestaurantFetch(QUrl url, NetworkService::Priority priority);
+    void applyRestaurantResponse(const QUrl &url, const NetworkResponse &response);
     void handleRestaurantResponse(const QJsonDocument &doc);
+    QJsonArray localizeResults(const QJsonArray &results) const;
+    QVector<RestaurantModel::Row> localNearby() const;
 };
 
 #endif // APPCONTROLLER_H
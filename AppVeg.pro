@@ -1,13 +1,41 @@
 QT += quick
 QT += positioning
+QT += network
+
+# Compile QML ahead of time into the binary (qmlcachegen); nothing is parsed at startup
+CONFIG += qtquickcompiler
+
+# Network flows are written as C++20 coroutines (AsyncReply.h); GCC 10 still needs the flag
+CONFIG += c++2a
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+        ActionQueue.cpp \
+        ApiBatch.cpp \
         AppController.cpp \
+        AsyncReply.cpp \
+        CatalogFile.cpp \
+        DetailService.cpp \
+        FrameBudgetIncubator.cpp \
+        GeoHashIndex.cpp \
+        ImageService.cpp \
+        LocationService.cpp \
+        NetworkHealth.cpp \
+        NetworkService.cpp \
+        OfflineCache.cpp \
+        PhotoModel.cpp \
+        PrefetchEngine.cpp \
+        RemoteImageProvider.cpp \
+        RestaurantStore.cpp \
         ResturantModel.cpp \
+        SearchIndex.cpp \
+        StartupOrchestrator.cpp \
+        StartupTimeline.cpp \
+        TokenManager.cpp \
         UserController.cpp \
         main.cpp
 
@@ -30,6 +58,26 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 HEADERS += \
+    ActionQueue.h \
+    ApiBatch.h \
     AppController.h \
+    AsyncReply.h \
+    CatalogFile.h \
+    DetailService.h \
+    FrameBudgetIncubator.h \
+    GeoHashIndex.h \
+    ImageService.h \
+    LocationService.h \
+    NetworkHealth.h \
+    NetworkService.h \
+    OfflineCache.h \
+    PhotoModel.h \
+    PrefetchEngine.h \
+    RemoteImageProvider.h \
+    RestaurantStore.h \
     ResturantModel.h \
+    SearchIndex.h \
+    StartupOrchestrator.h \
+    StartupTimeline.h \
+    TokenManager.h \
     UserController.h
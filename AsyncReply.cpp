@@ -0,0 +1,189 @@
+#include "AsyncReply.h"
+#include <QPointer>
+#include <QTimer>
+#include "OfflineCache.h"
+
+struct AsyncReply::State
+{
+    NetworkService *network = nullptr;
+    QPointer<QObject> context;
+    quint64 id = 0;
+    bool finished = false;
+    NetworkResponse response;
+    std::coroutine_handle<> waiter;
+    QMetaObject::Connection contextDestroyed;
+};
+
+bool NetworkResponse::ok() const
+{
+    return error == QNetworkReply::NoError && !cancelled && !timedOut;
+}
+
+QJsonDocument NetworkResponse::json() const
+{
+    return QJsonDocument::fromJson(body);
+}
+
+AsyncReply::AsyncReply()
+{
+}
+
+AsyncReply AsyncReply::get(NetworkService *network, const QNetworkRequest &request,
+                           NetworkService::Priority priority, QObject *context, int timeoutMs)
+{
+    return send(network, "GET", request, QByteArray(), priority, context, timeoutMs);
+}
+
+AsyncReply AsyncReply::post(NetworkService *network, const QNetworkRequest &request, const QByteArray &body,
+                            NetworkService::Priority priority, QObject *context, int timeoutMs)
+{
+    return send(network, "POST", request, body, priority, context, timeoutMs);
+}
+
+AsyncReply AsyncReply::send(NetworkService *network, const QByteArray &verb, const QNetworkRequest &request,
+                            const QByteArray &body, NetworkService::Priority priority, QObject *context,
+                            int timeoutMs)
+{
+    AsyncReply reply;
+    reply.m_state = std::make_shared<State>();
+    reply.m_state->network = network;
+    reply.m_state->context = context;
+
+    // The host keeps failing: answer now so the caller falls back to cached data instead of waiting
+    if (!network->health()->allowRequest(request.url())) {
+        NetworkResponse response;
+        response.error = QNetworkReply::UnknownNetworkError;
+        response.errorString = "Server unreachable";
+        response.url = request.url();
+        response.connectivityError = true;
+        response.circuitOpen = true;
+        finish(reply.m_state, response);
+        return reply;
+    }
+
+    const std::weak_ptr<State> weak = reply.m_state;
+    reply.m_state->id = network->send(verb, request, body, priority, context, [weak, url = request.url()](QNetworkReply *networkReply) {
+        NetworkResponse response;
+        if (!networkReply) {
+            // Dropped by the scheduler (backgrounded speculative work)
+            response.error = QNetworkReply::OperationCanceledError;
+            response.cancelled = true;
+            response.url = url;
+            if (const std::shared_ptr<State> state = weak.lock()) {
+                finish(state, response);
+            }
+            return;
+        }
+        response.error = networkReply->error();
+        response.status = networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        response.body = networkReply->readAll();
+        response.errorString = networkReply->errorString();
+        response.url = networkReply->url();
+        response.connectivityError = OfflineCache::isConnectivityError(networkReply);
+        response.timedOut = NetworkService::isTimedOut(networkReply)
+                            || response.error == QNetworkReply::TimeoutError;
+        // Aborted by something other than the transfer timeout
+        response.cancelled = response.error == QNetworkReply::OperationCanceledError && !response.timedOut;
+        networkReply->deleteLater();
+
+        if (const std::shared_ptr<State> state = weak.lock()) {
+            finish(state, response);
+        }
+    });
+
+    if (reply.m_state->id == 0) {
+        // Dropped by the scheduler (backgrounded speculative work)
+        NetworkResponse response;
+        response.cancelled = true;
+        response.url = request.url();
+        finish(reply.m_state, response);
+    } else if (timeoutMs > 0) {
+        QTimer::singleShot(timeoutMs, context, [weak]() {
+            const std::shared_ptr<State> state = weak.lock();
+            if (!state || state->finished) {
+                return;
+            }
+            state->network->cancel(state->id);
+
+            NetworkResponse response;
+            response.error = QNetworkReply::TimeoutError;
+            response.errorString = "Request timed out";
+            response.connectivityError = true;
+            response.timedOut = true;
+            finish(state, response);
+        });
+    }
+    return reply;
+}
+
+bool AsyncReply::isNull() const
+{
+    return !m_state;
+}
+
+bool AsyncReply::isFinished() const
+{
+    return m_state && m_state->finished;
+}
+
+void AsyncReply::cancel()
+{
+    if (!m_state || m_state->finished) {
+        return;
+    }
+    m_state->network->cancel(m_state->id);
+
+    NetworkResponse response;
+    response.error = QNetworkReply::OperationCanceledError;
+    response.cancelled = true;
+    finish(m_state, response);
+}
+
+bool AsyncReply::await_ready() const noexcept
+{
+    return !m_state || m_state->finished;
+}
+
+void AsyncReply::await_suspend(std::coroutine_handle<> handle)
+{
+    m_state->waiter = handle;
+
+    // Nothing will resume a flow whose owner is gone; free its frame instead
+    const std::weak_ptr<State> weak = m_state;
+    if (m_state->context) {
+        m_state->contextDestroyed = QObject::connect(m_state->context.data(), &QObject::destroyed, [weak]() {
+            const std::shared_ptr<State> state = weak.lock();
+            if (state && state->waiter) {
+                const std::coroutine_handle<> waiter = state->waiter;
+                state->waiter = nullptr;
+                waiter.destroy();
+            }
+        });
+    }
+}
+
+NetworkResponse AsyncReply::await_resume() const
+{
+    if (!m_state) {
+        NetworkResponse response;
+        response.cancelled = true;
+        return response;
+    }
+    return m_state->response;
+}
+
+void AsyncReply::finish(const std::shared_ptr<State> &state, NetworkResponse response)
+{
+    if (state->finished) {
+        return;
+    }
+    state->finished = true;
+    state->response = response;
+    QObject::disconnect(state->contextDestroyed);
+
+    if (state->waiter) {
+        const std::coroutine_handle<> waiter = state->waiter;
+        state->waiter = nullptr;
+        waiter.resume();
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef ASYNCREPLY_H
+#define ASYNCREPLY_H
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QMetaObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QString>
+#include <QUrl>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include "NetworkService.h"
+
+// Everything a coroutine needs from a finished request; the QNetworkReply
+// itself is already gone by the time the awaiting code resumes.
+struct NetworkResponse
+{
+    QNetworkReply::NetworkError error = QNetworkReply::NoError;
+    int status = 0;
+    QByteArray body;
+    QString errorString;
+    QUrl url;
+    // No HTTP response at all: no route, DNS, timeout...
+    bool connectivityError = false;
+    bool cancelled = false;
+    bool timedOut = false;
+    // Never sent: the host's circuit is open (see NetworkHealth)
+    bool circuitOpen = false;
+
+    bool ok() const;
+    QJsonDocument json() const;
+};
+
+// A request scheduled through NetworkService that a coroutine can co_await.
+// The request starts when the AsyncReply is created, so several can be in
+// flight before the first co_await. Copies share the same request.
+//
+// If the context object is destroyed while a coroutine waits, the coroutine
+// frame is destroyed instead of resumed, so flows may use `this` freely.
+class AsyncReply
+{
+public:
+    AsyncReply();
+
+    static AsyncReply get(NetworkService *network, const QNetworkRequest &request,
+                          NetworkService::Priority priority, QObject *context, int timeoutMs = 0);
+    static AsyncReply post(NetworkService *network, const QNetworkRequest &request, const QByteArray &body,
+                           NetworkService::Priority priority, QObject *context, int timeoutMs = 0);
+    static AsyncReply send(NetworkService *network, const QByteArray &verb, const QNetworkRequest &request,
+                           const QByteArray &body, NetworkService::Priority priority, QObject *context,
+                           int timeoutMs = 0);
+
+    bool isNull() const;
+    bool isFinished() const;
+    // Resumes the waiting coroutine with cancelled set; no-op once finished
+    void cancel();
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> handle);
+    NetworkResponse await_resume() const;
+
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+
+    static void finish(const std::shared_ptr<State> &state, NetworkResponse response);
+};
+
+// Return type of fire-and-forget coroutines started from slots. Flows run
+// eagerly until their first co_await and free themselves when they finish.
+struct AsyncFlow
+{
+    struct promise_type
+    {
+        AsyncFlow get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+#endif // ASYNCREPLY_H
@@ -0,0 +1,289 @@
+#include "CatalogFile.h"
+#include <cstring>
+#include <algorithm>
+#include "GeoHashIndex.h"
+
+struct CatalogFile::Header {
+    char magic[8];
+    quint32 version;
+    quint32 rowCount;
+    quint32 cellCount;
+    quint32 precision;
+    quint64 photoCount;
+    quint64 rowsOffset;
+    quint64 cellsOffset;
+    quint64 idsOffset;
+    quint64 photosOffset;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+};
+
+struct CatalogFile::StringRef {
+    quint32 offset;
+    quint32 length;
+};
+
+struct CatalogFile::RowRecord {
+    StringRef id;
+    StringRef name;
+    StringRef address;
+    StringRef phoneNumber;
+    StringRef website;
+    StringRef cuisineType;
+    StringRef description;
+    double latitude;
+    double longitude;
+    quint32 firstPhoto;
+    quint16 photoCount;
+    quint8 rating;
+    quint8 flags;
+};
+
+struct CatalogFile::CellRecord {
+    quint64 key;
+    quint32 firstRow;
+    quint32 rowCount;
+};
+
+namespace {
+const char kMagic[8] = { 'V', 'E', 'G', 'C', 'A', 'T', 0, 0 };
+const quint8 kVeganFlag = 0x1;
+const quint8 kVegetarianFlag = 0x2;
+// Past 12 characters a geohash cell index no longer fits in 32 bits per axis
+const quint32 kMaxPrecision = 12;
+
+bool sectionFits(quint64 offset, quint64 count, quint64 recordSize, quint64 fileSize)
+{
+    return offset % 8 == 0 && offset <= fileSize && count <= (fileSize - offset) / recordSize;
+}
+}
+
+CatalogFile::CatalogFile()
+    : m_data(nullptr)
+    , m_header(nullptr)
+    , m_rows(nullptr)
+    , m_cells(nullptr)
+    , m_ids(nullptr)
+    , m_photos(nullptr)
+    , m_strings(nullptr)
+    , m_photoCount(0)
+{
+    // The file format is the in-memory layout; keep them in lockstep with build_catalog.py
+    static_assert(sizeof(Header) == 80, "catalog header layout");
+    static_assert(sizeof(RowRecord) == 80, "catalog row layout");
+    static_assert(sizeof(CellRecord) == 16, "catalog cell layout");
+}
+
+CatalogFile::~CatalogFile()
+{
+    close();
+}
+
+bool CatalogFile::open(const QString &path)
+{
+    close();
+
+    if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN) {
+        return fail("Catalog files are little-endian only");
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+
+    const quint64 fileSize = quint64(m_file.size());
+    if (fileSize < sizeof(Header)) {
+        return fail("Catalog file is truncated");
+    }
+
+    m_data = m_file.map(0, m_file.size());
+    if (!m_data) {
+        return fail(m_file.errorString());
+    }
+
+    const Header *header = reinterpret_cast<const Header *>(m_data);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        return fail("Not a catalog file");
+    }
+    if (header->version != Version) {
+        return fail(QString("Unsupported catalog version %1").arg(header->version));
+    }
+
+    // Validate every section once so row reads need no bounds checks beyond the string pool
+    if (!sectionFits(header->rowsOffset, header->rowCount, sizeof(RowRecord), fileSize)
+            || !sectionFits(header->cellsOffset, header->cellCount, sizeof(CellRecord), fileSize)
+            || !sectionFits(header->idsOffset, header->rowCount, sizeof(quint32), fileSize)
+            || !sectionFits(header->photosOffset, header->photoCount, sizeof(StringRef), fileSize)
+            || header->stringsOffset > fileSize
+            || header->stringsSize > fileSize - header->stringsOffset
+            || header->precision < 1 || header->precision > kMaxPrecision) {
+        return fail("Catalog file is corrupt");
+    }
+
+    m_header = header;
+    m_rows = reinterpret_cast<const RowRecord *>(m_data + header->rowsOffset);
+    m_cells = reinterpret_cast<const CellRecord *>(m_data + header->cellsOffset);
+    m_ids = reinterpret_cast<const quint32 *>(m_data + header->idsOffset);
+    m_photos = reinterpret_cast<const StringRef *>(m_data + header->photosOffset);
+    m_strings = reinterpret_cast<const char *>(m_data + header->stringsOffset);
+    m_photoCount = header->photoCount;
+    return true;
+}
+
+void CatalogFile::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+    }
+    m_file.close();
+
+    m_data = nullptr;
+    m_header = nullptr;
+    m_rows = nullptr;
+    m_cells = nullptr;
+    m_ids = nullptr;
+    m_photos = nullptr;
+    m_strings = nullptr;
+    m_photoCount = 0;
+}
+
+bool CatalogFile::isOpen() const
+{
+    return m_header != nullptr;
+}
+
+QString CatalogFile::errorString() const
+{
+    return m_error;
+}
+
+bool CatalogFile::fail(const QString &error)
+{
+    close();
+    m_error = error;
+    return false;
+}
+
+int CatalogFile::size() const
+{
+    return m_header ? int(m_header->rowCount) : 0;
+}
+
+QByteArray CatalogFile::bytes(const StringRef &ref) const
+{
+    if (quint64(ref.offset) + ref.length > m_header->stringsSize) {
+        return QByteArray();
+    }
+    // Points into the mapping; valid while the file is open
+    return QByteArray::fromRawData(m_strings + ref.offset, int(ref.length));
+}
+
+QString CatalogFile::string(const StringRef &ref) const
+{
+    if (quint64(ref.offset) + ref.length > m_header->stringsSize) {
+        return QString();
+    }
+    return QString::fromUtf8(m_strings + ref.offset, int(ref.length));
+}
+
+int CatalogFile::indexOf(const QString &id) const
+{
+    if (!m_header) {
+        return -1;
+    }
+
+    // The id index is sorted by raw UTF-8 bytes, so compare bytes too
+    const QByteArray key = id.toUtf8();
+    const quint32 *begin = m_ids;
+    const quint32 *end = m_ids + m_header->rowCount;
+    const quint32 *it = std::lower_bound(begin, end, key, [this](quint32 row, const QByteArray &value) {
+        return row < m_header->rowCount && bytes(m_rows[row].id) < value;
+    });
+    if (it == end || *it >= m_header->rowCount || bytes(m_rows[*it].id) != key) {
+        return -1;
+    }
+    return int(*it);
+}
+
+QString CatalogFile::id(int row) const
+{
+    if (row < 0 || row >= size()) {
+        return QString();
+    }
+    return string(m_rows[row].id);
+}
+
+QByteArray CatalogFile::nameBytes(int row) const
+{
+    if (row < 0 || row >= size()) {
+        return QByteArray();
+    }
+    return bytes(m_rows[row].name);
+}
+
+QByteArray CatalogFile::descriptionBytes(int row) const
+{
+    if (row < 0 || row >= size()) {
+        return QByteArray();
+    }
+    return bytes(m_rows[row].description);
+}
+
+Restaurant CatalogFile::restaurant(int row) const
+{
+    Restaurant restaurant;
+    if (row < 0 || row >= size()) {
+        return restaurant;
+    }
+
+    const RowRecord &record = m_rows[row];
+    restaurant.id = string(record.id);
+    restaurant.name = string(record.name);
+    restaurant.address = string(record.address);
+    restaurant.phoneNumber = string(record.phoneNumber);
+    restaurant.website = string(record.website);
+    restaurant.cuisineType = string(record.cuisineType);
+    restaurant.description = string(record.description);
+    restaurant.latitude = record.latitude;
+    restaurant.longitude = record.longitude;
+    restaurant.rating = record.rating;
+    restaurant.isVegan = record.flags & kVeganFlag;
+    restaurant.isVegetarian = record.flags & kVegetarianFlag;
+    restaurant.distance = 0.0;
+    restaurant.isFavorite = false;
+    restaurant.detailed = true;
+
+    if (quint64(record.firstPhoto) + record.photoCount <= m_photoCount) {
+        for (quint32 i = 0; i < record.photoCount; ++i) {
+            restaurant.photos.append(string(m_photos[record.firstPhoto + i]));
+        }
+    }
+    return restaurant;
+}
+
+QVector<int> CatalogFile::candidates(double latitude, double longitude, double radiusMeters) const
+{
+    QVector<int> rows;
+    if (!m_header) {
+        return rows;
+    }
+
+    const GeoHashIndex grid(int(m_header->precision));
+    const QVector<quint64> keys = grid.covering(latitude, longitude, radiusMeters);
+    const CellRecord *begin = m_cells;
+    const CellRecord *end = m_cells + m_header->cellCount;
+    for (quint64 key : keys) {
+        const CellRecord *cell = std::lower_bound(begin, end, key, [](const CellRecord &record, quint64 value) {
+            return record.key < value;
+        });
+        if (cell == end || cell->key != key) {
+            continue;
+        }
+        const quint64 last = qMin<quint64>(quint64(cell->firstRow) + cell->rowCount, m_header->rowCount);
+        for (quint64 row = cell->firstRow; row < last; ++row) {
+            rows.append(int(row));
+        }
+    }
+    return rows;
+}
@@ -0,0 +1,68 @@
+#ifndef CATALOGFILE_H
+#define CATALOGFILE_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include "ResturantModel.h"
+
+// Read-only view of an offline restaurant catalog (.vcat) built by
+// backend/python/build_catalog.py. The file is memory-mapped and rows are
+// read in place, so opening a whole-city catalog costs no parsing.
+//
+// Layout, little-endian, every section 8-byte aligned:
+//   header   magic "VEGCAT\0\0", version, row/cell counts, section offsets
+//   rows     fixed-width records, sorted by geohash cell
+//   cells    (cell key, first row, row count), sorted by key
+//   ids      row numbers sorted by id bytes
+//   photos   string references, a contiguous run per row
+//   strings  UTF-8 pool that every string reference points into
+class CatalogFile
+{
+public:
+    static const quint32 Version = 1;
+
+    CatalogFile();
+    ~CatalogFile();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    int size() const;
+    // Row number of the id, or -1
+    int indexOf(const QString &id) const;
+    QString id(int row) const;
+    // UTF-8 of the searchable fields, pointing into the mapping; nothing else is decoded
+    QByteArray nameBytes(int row) const;
+    QByteArray descriptionBytes(int row) const;
+    // Decodes one row; strings are only converted here
+    Restaurant restaurant(int row) const;
+
+    // Rows in the cells overlapping the circle; callers apply the exact distance
+    QVector<int> candidates(double latitude, double longitude, double radiusMeters) const;
+
+private:
+    struct Header;
+    struct StringRef;
+    struct RowRecord;
+    struct CellRecord;
+
+    QFile m_file;
+    const uchar *m_data;
+    const Header *m_header;
+    const RowRecord *m_rows;
+    const CellRecord *m_cells;
+    const quint32 *m_ids;
+    const StringRef *m_photos;
+    const char *m_strings;
+    quint64 m_photoCount;
+    QString m_error;
+
+    bool fail(const QString &error);
+    QString string(const StringRef &ref) const;
+    QByteArray bytes(const StringRef &ref) const;
+};
+
+#endif // CATALOGFILE_H
@@ -0,0 +1,208 @@
+#include "DetailService.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <utility>
+#include "RestaurantStore.h"
+#include "TokenManager.h"
+
+namespace {
+// A few screens' worth of rows plus recently opened pages
+const int kDefaultCapacity = 200;
+// The backend's limit for one batch request
+const int kMaxBatchSize = 8;
+
+const int kLoadTimeoutMs = 15000;
+const int kPrefetchTimeoutMs = 30000;
+}
+
+DetailService::DetailService(NetworkService *network, RestaurantStore *store, TokenManager *tokens, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_store(store)
+    , m_tokens(tokens)
+    , m_offlineCache("details")
+    , m_baseUrl("http://localhost:8000/api")
+    , m_capacity(kDefaultCapacity)
+    , m_prefetching(false)
+{
+}
+
+int DetailService::capacity() const
+{
+    return m_capacity;
+}
+
+void DetailService::setCapacity(int capacity)
+{
+    m_capacity = qMax(1, capacity);
+    while (m_recent.size() > m_capacity) {
+        dropOldest();
+    }
+}
+
+void DetailService::load(const QString &id)
+{
+    if (id.isEmpty()) {
+        return;
+    }
+
+    if (!needsFetch(id)) {
+        // Keep what the user is looking at away from eviction
+        if (m_recent.contains(id)) {
+            touch(id);
+        }
+        return;
+    }
+    runLoad(id);
+}
+
+AsyncFlow DetailService::runLoad(QString id)
+{
+    // Opening another restaurant supersedes this one. A prefetch for the same id
+    // may still be queued behind other traffic, so the user's request goes out anyway.
+    m_loadRequest.cancel();
+    // Waits out a token renewal instead of going out with the old token
+    co_await m_tokens->ready(this);
+    const QString token = m_tokens->token();
+    AsyncReply fetch = requestDetail(id);
+    NetworkResponse response = co_await fetch;
+
+    // One renewal however many requests were turned away, then one retry
+    if (response.error == QNetworkReply::AuthenticationRequiredError && co_await m_tokens->renew(this, token)) {
+        AsyncReply retry = requestDetail(id);
+        response = co_await retry;
+    }
+    apply(id, response);
+}
+
+void DetailService::prefetch(const QStringList &ids)
+{
+    if (m_prefetching) {
+        m_queued = ids;
+        return;
+    }
+    runPrefetch(ids);
+}
+
+AsyncFlow DetailService::runPrefetch(QStringList ids)
+{
+    ApiBatch batch;
+    for (const QString &id : qAsConst(ids)) {
+        if (batch.ids().size() >= kMaxBatchSize) {
+            break;
+        }
+        if (!needsFetch(id) || m_pending.contains(id)) {
+            continue;
+        }
+        QJsonObject params;
+        params["restaurant_id"] = id;
+        batch.add(id, "restaurant", params);
+    }
+
+    if (!batch.isEmpty()) {
+        const QStringList requested = batch.ids();
+        for (const QString &id : requested) {
+            m_pending.insert(id);
+        }
+
+        m_prefetching = true;
+        co_await m_tokens->ready(this);
+        const QString token = m_tokens->token();
+        AsyncReply request = requestBatch(batch);
+        NetworkResponse response = co_await request;
+        if (response.error == QNetworkReply::AuthenticationRequiredError && co_await m_tokens->renew(this, token)) {
+            AsyncReply retry = requestBatch(batch);
+            response = co_await retry;
+        }
+        m_prefetching = false;
+
+        const ApiBatch::Responses responses = batch.split(response);
+        for (const QString &id : requested) {
+            m_pending.remove(id);
+            // Offline prefetches leave nothing behind; the page falls back to disk when opened
+            if (!response.connectivityError) {
+                apply(id, responses.value(id));
+            }
+        }
+    }
+
+    if (!m_queued.isEmpty()) {
+        runPrefetch(std::exchange(m_queued, QStringList()));
+    }
+}
+
+void DetailService::apply(const QString &id, const NetworkResponse &response)
+{
+    if (response.cancelled) {
+        return;
+    }
+
+    QByteArray body = response.body;
+    if (response.ok()) {
+        m_offlineCache.store(id, body);
+    } else if (response.connectivityError) {
+        body = m_offlineCache.load(id);
+    }
+
+    const QJsonObject obj = QJsonDocument::fromJson(body).object();
+    if (obj.isEmpty() || !needsFetch(id)) {
+        return;
+    }
+
+    // The store merges the full record and tells every page showing it
+    m_store->ingest(QJsonArray{ obj });
+    touch(id);
+}
+
+bool DetailService::needsFetch(const QString &id) const
+{
+    const Restaurant *restaurant = m_store->find(id);
+    return !restaurant || !restaurant->detailed;
+}
+
+void DetailService::touch(const QString &id)
+{
+    // Recently opened rows stay in the store, not only their details
+    if (!m_recent.removeOne(id)) {
+        m_store->retain(id);
+    }
+    m_recent.append(id);
+    while (m_recent.size() > m_capacity) {
+        dropOldest();
+    }
+}
+
+void DetailService::dropOldest()
+{
+    const QString id = m_recent.takeFirst();
+    m_store->releaseDetails(id);
+    m_store->release(id);
+}
+
+QNetworkRequest DetailService::createRequest(const QUrl &url) const
+{
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    m_tokens->authorize(request);
+    return request;
+}
+
+AsyncReply DetailService::requestDetail(const QString &id)
+{
+    m_loadRequest.cancel();
+    m_loadRequest = AsyncReply::get(m_network, createRequest(detailUrl(id)), NetworkService::Interactive,
+                                    this, kLoadTimeoutMs);
+    return m_loadRequest;
+}
+
+AsyncReply DetailService::requestBatch(const ApiBatch &batch)
+{
+    return AsyncReply::post(m_network, createRequest(QUrl(m_baseUrl + "/batch")), batch.body(),
+                            NetworkService::Prefetch, this, kPrefetchTimeoutMs);
+}
+
+QUrl DetailService::detailUrl(const QString &id) const
+{
+    return QUrl(m_baseUrl + "/restaurants/" + id);
+}
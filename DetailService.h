@@ -0,0 +1,68 @@
+#ifndef DETAILSERVICE_H
+#define DETAILSERVICE_H
+
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include "ApiBatch.h"
+#include "AsyncReply.h"
+#include "NetworkService.h"
+#include "OfflineCache.h"
+
+class RestaurantStore;
+class TokenManager;
+
+// Full restaurant records on demand. List responses carry slim rows only;
+// this fetches the rest by id when a detail page opens, and ahead of time for
+// the rows on screen, so the page usually opens with everything in place.
+//
+// Details live in the shared RestaurantStore. The service keeps a bounded LRU
+// of the ids whose details it fetched and releases the heavy fields of the
+// least recently used ones from the store, so scrolling a long list does not
+// keep every description and photo list in memory.
+class DetailService : public QObject
+{
+    Q_OBJECT
+
+public:
+    DetailService(NetworkService *network, RestaurantStore *store, TokenManager *tokens, QObject *parent = nullptr);
+
+    int capacity() const;
+    void setCapacity(int capacity);
+
+public slots:
+    // The detail page for this restaurant is open
+    void load(const QString &id);
+    // Rows on screen; fetched in one batch request at prefetch priority
+    void prefetch(const QStringList &ids);
+
+private:
+    NetworkService *m_network;
+    RestaurantStore *m_store;
+    TokenManager *m_tokens;
+    OfflineCache m_offlineCache;
+    QString m_baseUrl;
+    int m_capacity;
+    // Ids whose details we hold, least recently used first
+    QStringList m_recent;
+    // Requested and not yet answered
+    QSet<QString> m_pending;
+    // Visible rows that arrived while a prefetch batch was out; only the latest set counts
+    QStringList m_queued;
+    bool m_prefetching;
+    AsyncReply m_loadRequest;
+
+    bool needsFetch(const QString &id) const;
+    QNetworkRequest createRequest(const QUrl &url) const;
+    QUrl detailUrl(const QString &id) const;
+    AsyncReply requestDetail(const QString &id);
+    AsyncReply requestBatch(const ApiBatch &batch);
+    AsyncFlow runLoad(QString id);
+    AsyncFlow runPrefetch(QStringList ids);
+    void apply(const QString &id, const NetworkResponse &response);
+    void touch(const QString &id);
+    // Releases the least recently used row's details and its hold on the row
+    void dropOldest();
+};
+
+#endif // DETAILSERVICE_H
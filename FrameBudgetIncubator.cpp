@@ -0,0 +1,102 @@
+#include "FrameBudgetIncubator.h"
+#include <QQuickWindow>
+#include <QScreen>
+#include <QTimer>
+
+namespace {
+// Share of the frame interval incubation may use; the rest is for animation and sync
+const double kBudgetShare = 0.33;
+// A frame this much longer than the interval counts as missed
+const double kMissedFrameFactor = 1.5;
+// Used before a window is attached
+const int kDetachedBudgetMs = 5;
+}
+
+FrameBudgetIncubator::FrameBudgetIncubator(QObject *parent)
+    : QObject(parent)
+    , m_frameInterval(1000.0 / 60.0)
+    , m_budget(int(m_frameInterval * kBudgetShare))
+    , m_maxBudget(m_budget)
+    , m_incubatedThisFrame(false)
+{
+}
+
+void FrameBudgetIncubator::setWindow(QQuickWindow *window)
+{
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = window;
+    if (!window) {
+        return;
+    }
+
+    const qreal refreshRate = window->screen() ? window->screen()->refreshRate() : 60.0;
+    m_frameInterval = 1000.0 / (refreshRate > 0 ? refreshRate : 60.0);
+    m_maxBudget = qMax(1, int(m_frameInterval * kBudgetShare));
+    m_budget = m_maxBudget;
+
+    connect(window, &QQuickWindow::afterAnimating, this, &FrameBudgetIncubator::onAfterAnimating);
+    // Emitted on the render thread with the threaded loop; queued back to us
+    connect(window, &QQuickWindow::frameSwapped, this, &FrameBudgetIncubator::onFrameSwapped, Qt::QueuedConnection);
+
+    if (incubatingObjectCount() > 0) {
+        window->update();
+    }
+}
+
+int FrameBudgetIncubator::budget() const
+{
+    return m_budget;
+}
+
+void FrameBudgetIncubator::incubatingObjectCountChanged(int count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (m_window) {
+        // Make sure a frame comes to do the work
+        m_window->update();
+    } else {
+        QTimer::singleShot(0, this, [this]() {
+            incubateFor(kDetachedBudgetMs);
+        });
+    }
+}
+
+void FrameBudgetIncubator::onAfterAnimating()
+{
+    m_incubatedThisFrame = false;
+    if (incubatingObjectCount() == 0) {
+        return;
+    }
+
+    incubateFor(m_budget);
+    m_incubatedThisFrame = true;
+
+    if (incubatingObjectCount() > 0 && m_window) {
+        m_window->update();
+    }
+}
+
+void FrameBudgetIncubator::onFrameSwapped()
+{
+    if (!m_frameTimer.isValid()) {
+        m_frameTimer.start();
+        return;
+    }
+
+    const double elapsed = m_frameTimer.restart();
+    if (!m_incubatedThisFrame) {
+        return;
+    }
+
+    // Back off quickly on a missed frame, recover one millisecond at a time
+    if (elapsed > m_frameInterval * kMissedFrameFactor) {
+        m_budget = qMax(1, m_budget / 2);
+    } else if (m_budget < m_maxBudget) {
+        ++m_budget;
+    }
+}
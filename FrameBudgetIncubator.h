@@ -0,0 +1,42 @@
+#ifndef FRAMEBUDGETINCUBATOR_H
+#define FRAMEBUDGETINCUBATOR_H
+
+#include <QObject>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QQmlIncubationController>
+
+class QQuickWindow;
+
+// Drives asynchronous QML incubation (ListView cache buffer delegates, async
+// Loaders) from the window's frame loop with a time budget per frame. The
+// budget shrinks when frames are missed while objects are incubating and
+// recovers once frames are on time again.
+class FrameBudgetIncubator : public QObject, public QQmlIncubationController
+{
+    Q_OBJECT
+
+public:
+    explicit FrameBudgetIncubator(QObject *parent = nullptr);
+
+    // Must be installed on the engine before the window is created, then attached
+    void setWindow(QQuickWindow *window);
+    int budget() const;
+
+protected:
+    void incubatingObjectCountChanged(int count) override;
+
+private slots:
+    void onAfterAnimating();
+    void onFrameSwapped();
+
+private:
+    QPointer<QQuickWindow> m_window;
+    QElapsedTimer m_frameTimer;
+    double m_frameInterval;
+    int m_budget;
+    int m_maxBudget;
+    bool m_incubatedThisFrame;
+};
+
+#endif // FRAMEBUDGETINCUBATOR_H
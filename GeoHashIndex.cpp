@@ -0,0 +1,145 @@
+#include "GeoHashIndex.h"
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+const double kMetersPerDegree = 111320.0;
+const char kBase32[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+
+quint64 cellKey(qint64 latIndex, qint64 lonIndex)
+{
+    return (quint64(latIndex) << 32) | quint64(lonIndex);
+}
+}
+
+GeoHashIndex::GeoHashIndex(int precision)
+    : m_precision(precision)
+{
+    bits(precision, m_latBits, m_lonBits);
+}
+
+void GeoHashIndex::bits(int precision, int &latBits, int &lonBits)
+{
+    // Geohash gives longitude the odd bit
+    const int total = 5 * precision;
+    latBits = total / 2;
+    lonBits = total - latBits;
+}
+
+void GeoHashIndex::clear()
+{
+    m_cells.clear();
+    m_cellById.clear();
+}
+
+quint64 GeoHashIndex::cellOf(double latitude, double longitude) const
+{
+    const qint64 latCells = qint64(1) << m_latBits;
+    const qint64 lonCells = qint64(1) << m_lonBits;
+    const qint64 latIndex = qBound<qint64>(0, qFloor((latitude + 90.0) / 180.0 * latCells), latCells - 1);
+    const qint64 lonIndex = ((qFloor((longitude + 180.0) / 360.0 * lonCells) % lonCells) + lonCells) % lonCells;
+    return cellKey(latIndex, lonIndex);
+}
+
+void GeoHashIndex::insert(const QString &id, double latitude, double longitude)
+{
+    const quint64 cell = cellOf(latitude, longitude);
+    const auto existing = m_cellById.constFind(id);
+    if (existing != m_cellById.constEnd()) {
+        if (existing.value() == cell) {
+            return;
+        }
+        remove(id);
+    }
+
+    m_cells[cell].append(id);
+    m_cellById.insert(id, cell);
+}
+
+void GeoHashIndex::remove(const QString &id)
+{
+    const auto it = m_cellById.find(id);
+    if (it == m_cellById.end()) {
+        return;
+    }
+
+    const auto cell = m_cells.find(it.value());
+    if (cell != m_cells.end()) {
+        cell->removeOne(id);
+        if (cell->isEmpty()) {
+            m_cells.erase(cell);
+        }
+    }
+    m_cellById.erase(it);
+}
+
+bool GeoHashIndex::contains(const QString &id) const
+{
+    return m_cellById.contains(id);
+}
+
+int GeoHashIndex::size() const
+{
+    return m_cellById.size();
+}
+
+QVector<QString> GeoHashIndex::candidates(double latitude, double longitude, double radiusMeters) const
+{
+    QVector<QString> ids;
+    const QVector<quint64> cells = covering(latitude, longitude, radiusMeters);
+    for (quint64 key : cells) {
+        const auto cell = m_cells.constFind(key);
+        if (cell != m_cells.constEnd()) {
+            ids += cell.value();
+        }
+    }
+    return ids;
+}
+
+QVector<quint64> GeoHashIndex::covering(double latitude, double longitude, double radiusMeters) const
+{
+    const double dLat = radiusMeters / kMetersPerDegree;
+    // Clamp near the poles where a degree of longitude shrinks to nothing
+    const double dLon = radiusMeters / (kMetersPerDegree * qMax(qCos(qDegreesToRadians(latitude)), 0.01));
+
+    const qint64 lonCells = qint64(1) << m_lonBits;
+    const qint64 lowLat = qint64(cellOf(qMax(latitude - dLat, -90.0), longitude) >> 32);
+    const qint64 highLat = qint64(cellOf(qMin(latitude + dLat, 90.0), longitude) >> 32);
+    const qint64 lowLon = qFloor((longitude - dLon + 180.0) / 360.0 * lonCells);
+    const qint64 highLon = qFloor((longitude + dLon + 180.0) / 360.0 * lonCells);
+    const qint64 lonSpan = qMin(highLon - lowLon + 1, lonCells);
+
+    QVector<quint64> cells;
+    for (qint64 latIndex = lowLat; latIndex <= highLat; ++latIndex) {
+        for (qint64 step = 0; step < lonSpan; ++step) {
+            const qint64 lonIndex = (((lowLon + step) % lonCells) + lonCells) % lonCells;
+            cells.append(cellKey(latIndex, lonIndex));
+        }
+    }
+    return cells;
+}
+
+QString GeoHashIndex::encode(double latitude, double longitude, int precision)
+{
+    int latBits = 0;
+    int lonBits = 0;
+    bits(precision, latBits, lonBits);
+
+    const GeoHashIndex grid(precision);
+    const quint64 cell = grid.cellOf(latitude, longitude);
+    const quint64 latIndex = cell >> 32;
+    const quint64 lonIndex = cell & 0xffffffffu;
+
+    // Interleave longitude first, most significant bit first
+    QString hash;
+    int value = 0;
+    for (int bit = 0; bit < 5 * precision; ++bit) {
+        const quint64 source = (bit % 2 == 0) ? (lonIndex >> --lonBits) : (latIndex >> --latBits);
+        value = (value << 1) | int(source & 1);
+        if (bit % 5 == 4) {
+            hash.append(QLatin1Char(kBase32[value]));
+            value = 0;
+        }
+    }
+    return hash;
+}
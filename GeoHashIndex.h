@@ -0,0 +1,42 @@
+#ifndef GEOHASHINDEX_H
+#define GEOHASHINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Client-side spatial buckets over the restaurant catalog. Restaurants are
+// grouped by geohash cell so a nearby lookup merges the few cells covering
+// the radius instead of scanning everything we have seen.
+class GeoHashIndex
+{
+public:
+    // Precision 6 cells are roughly 1.2 x 0.6 km
+    explicit GeoHashIndex(int precision = 6);
+
+    void clear();
+    void insert(const QString &id, double latitude, double longitude);
+    void remove(const QString &id);
+    bool contains(const QString &id) const;
+    int size() const;
+
+    // Ids in the cells overlapping the circle; callers apply the exact distance
+    QVector<QString> candidates(double latitude, double longitude, double radiusMeters) const;
+
+    // Cell keys are (latitude index << 32) | longitude index at this precision
+    quint64 cellOf(double latitude, double longitude) const;
+    QVector<quint64> covering(double latitude, double longitude, double radiusMeters) const;
+
+    static QString encode(double latitude, double longitude, int precision);
+
+private:
+    int m_precision;
+    int m_latBits;
+    int m_lonBits;
+    QHash<quint64, QVector<QString>> m_cells;
+    QHash<QString, quint64> m_cellById;
+
+    static void bits(int precision, int &latBits, int &lonBits);
+};
+
+#endif // GEOHASHINDEX_H
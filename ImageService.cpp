@@ -0,0 +1,247 @@
+#include "ImageService.h"
+#include "RemoteImageProvider.h"
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+const int kDefaultMemoryCacheKb = 32 * 1024;
+const qint64 kDefaultDiskCacheBytes = 64 * 1024 * 1024;
+const int kTrimEveryWrites = 32;
+}
+
+ImageService::ImageService(NetworkService *network, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_memoryCache(kDefaultMemoryCacheKb)
+    , m_diskDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/images")
+    , m_diskCacheSize(kDefaultDiskCacheBytes)
+    , m_diskWrites(0)
+{
+    QDir().mkpath(m_diskDirectory);
+
+    // Decoding is CPU bound; two workers keep it off the GUI thread without starving it
+    m_decodePool.setMaxThreadCount(2);
+}
+
+ImageService::~ImageService()
+{
+    m_decodePool.waitForDone();
+
+    // Nothing will finish the remaining responses otherwise
+    for (auto it = m_waiting.begin(); it != m_waiting.end(); ++it) {
+        for (RemoteImageResponse *response : qAsConst(it.value())) {
+            response->finish(QImage());
+        }
+    }
+}
+
+void ImageService::setMemoryCacheSize(int kilobytes)
+{
+    m_memoryCache.setMaxCost(kilobytes);
+}
+
+void ImageService::setDiskCacheSize(qint64 bytes)
+{
+    m_diskCacheSize = bytes;
+}
+
+void ImageService::request(RemoteImageResponse *response)
+{
+    // The image provider calls us from the QML image loader thread
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, response]() {
+            request(response);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    const QUrl url = response->url();
+    const QSize size = response->requestedSize();
+    const QString key = cacheKey(url, size);
+
+    if (QImage *image = m_memoryCache.object(key)) {
+        response->finish(*image);
+        return;
+    }
+
+    // Somebody already asked for the same image at the same size: wait with them.
+    // The entry stays until deliver(), even if cancel() emptied it, so it marks a load in flight.
+    const bool loading = m_waiting.contains(key);
+    m_waiting[key].append(response);
+    if (loading) {
+        return;
+    }
+
+    const QString path = diskPath(url);
+    m_decodePool.start([this, key, url, size, path]() {
+        QFile file(path);
+        if (file.exists() && file.open(QIODevice::ReadWrite)) {
+            const QByteArray data = file.readAll();
+            // Bump the timestamp so disk trimming evicts least recently used files first
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            file.close();
+
+            const QImage image = decodeImage(data, size);
+            if (!image.isNull()) {
+                QMetaObject::invokeMethod(this, [this, key, image]() {
+                    deliver(key, image);
+                }, Qt::QueuedConnection);
+                return;
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, key, url, size]() {
+            fetch(key, url, size);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImageService::cancel(RemoteImageResponse *response)
+{
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, response]() {
+            cancel(response);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // Already delivered responses are no longer in any list. An emptied list
+    // is kept: its load is still running and deliver() removes it.
+    for (auto it = m_waiting.begin(); it != m_waiting.end(); ++it) {
+        if (it.value().removeOne(response)) {
+            response->finish(QImage());
+            return;
+        }
+    }
+}
+
+QImage ImageService::decodeImage(const QByteArray &data, const QSize &requestedSize)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+
+    QImageReader reader(&buffer);
+    reader.setAutoTransform(true);
+
+    // Let the decoder scale (JPEG/SVG do it much cheaper than a full decode + resize)
+    const QSize sourceSize = reader.size();
+    if (!sourceSize.isEmpty() && (requestedSize.width() > 0 || requestedSize.height() > 0)) {
+        QSize target = requestedSize;
+        if (target.width() <= 0) {
+            target.setWidth(sourceSize.width() * target.height() / sourceSize.height());
+        } else if (target.height() <= 0) {
+            target.setHeight(sourceSize.height() * target.width() / sourceSize.width());
+        } else {
+            target = sourceSize.scaled(target, Qt::KeepAspectRatio);
+        }
+        reader.setScaledSize(target);
+    }
+
+    return reader.read();
+}
+
+QString ImageService::cacheKey(const QUrl &url, const QSize &size) const
+{
+    return QString("%1@%2x%3").arg(url.toString()).arg(size.width()).arg(size.height());
+}
+
+QString ImageService::diskPath(const QUrl &url) const
+{
+    const QByteArray hash = QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1).toHex();
+    return m_diskDirectory + "/" + QString::fromLatin1(hash);
+}
+
+void ImageService::fetch(const QString &key, const QUrl &url, const QSize &size)
+{
+    // Several sizes of one URL share a single download
+    QList<QPair<QString, QSize>> &targets = m_fetching[url];
+    targets.append(qMakePair(key, size));
+    if (targets.size() > 1) {
+        return;
+    }
+
+    m_network->get(QNetworkRequest(url), NetworkService::Normal, this, [this, url](QNetworkReply *reply) {
+        handleReply(url, reply);
+    });
+}
+
+void ImageService::handleReply(const QUrl &url, QNetworkReply *reply)
+{
+    const QList<QPair<QString, QSize>> targets = m_fetching.take(url);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        for (const auto &target : targets) {
+            deliver(target.first, QImage());
+        }
+        reply->deleteLater();
+        return;
+    }
+
+    const QByteArray data = reply->readAll();
+    reply->deleteLater();
+
+    const QString path = diskPath(url);
+    const QString directory = m_diskDirectory;
+    const qint64 maxDiskBytes = m_diskCacheSize;
+    const bool trim = (m_diskWrites.fetchAndAddRelaxed(1) % kTrimEveryWrites) == 0;
+
+    m_decodePool.start([this, data, path, directory, maxDiskBytes, trim, targets]() {
+        QSaveFile file(path);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(data);
+            file.commit();
+        }
+        if (trim) {
+            trimDiskCache(directory, maxDiskBytes);
+        }
+
+        for (const auto &target : targets) {
+            const QImage image = decodeImage(data, target.second);
+            const QString key = target.first;
+            QMetaObject::invokeMethod(this, [this, key, image]() {
+                deliver(key, image);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void ImageService::deliver(const QString &key, const QImage &image)
+{
+    if (!image.isNull()) {
+        m_memoryCache.insert(key, new QImage(image), int(qMax<qsizetype>(1, image.sizeInBytes() / 1024)));
+    }
+
+    const QList<RemoteImageResponse *> waiting = m_waiting.take(key);
+    for (RemoteImageResponse *response : waiting) {
+        response->finish(image);
+    }
+}
+
+void ImageService::trimDiskCache(const QString &directory, qint64 maxBytes)
+{
+    QFileInfoList files = QDir(directory).entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo &info : qAsConst(files)) {
+        total += info.size();
+    }
+
+    // Oldest first
+    for (const QFileInfo &info : qAsConst(files)) {
+        if (total <= maxBytes) {
+            break;
+        }
+        total -= info.size();
+        QFile::remove(info.absoluteFilePath());
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef IMAGESERVICE_H
+#define IMAGESERVICE_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QSize>
+#include <QThreadPool>
+#include <QUrl>
+#include "NetworkService.h"
+
+class RemoteImageResponse;
+
+// Loads remote images (restaurant photos) for QML: a bounded in-memory LRU of
+// decoded images, a disk cache of the encoded bytes, de-duplication of
+// concurrent requests and decoding to the requested size on worker threads.
+class ImageService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageService(NetworkService *network, QObject *parent = nullptr);
+    ~ImageService();
+
+    void setMemoryCacheSize(int kilobytes);
+    void setDiskCacheSize(qint64 bytes);
+
+    // Thread-safe. Every response is finished exactly once, on the service's thread.
+    void request(RemoteImageResponse *response);
+    void cancel(RemoteImageResponse *response);
+
+    static QImage decodeImage(const QByteArray &data, const QSize &requestedSize);
+
+private:
+    NetworkService *m_network;
+    QCache<QString, QImage> m_memoryCache;
+    QHash<QString, QList<RemoteImageResponse *>> m_waiting;
+    QHash<QUrl, QList<QPair<QString, QSize>>> m_fetching;
+    QThreadPool m_decodePool;
+    QString m_diskDirectory;
+    qint64 m_diskCacheSize;
+    QAtomicInt m_diskWrites;
+
+    QString cacheKey(const QUrl &url, const QSize &size) const;
+    QString diskPath(const QUrl &url) const;
+    void fetch(const QString &key, const QUrl &url, const QSize &size);
+    void handleReply(const QUrl &url, QNetworkReply *reply);
+    void deliver(const QString &key, const QImage &image);
+    static void trimDiskCache(const QString &directory, qint64 maxBytes);
+};
+
+#endif // IMAGESERVICE_H
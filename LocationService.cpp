@@ -0,0 +1,261 @@
+#include "LocationService.h"
+#include <QSettings>
+#include <QtMath>
+
+namespace {
+// Beyond this the network fix is not worth waiting for
+const int kCoarseTimeoutMs = 3000;
+const int kTrackingIntervalMs = 5000;
+// Used when a fix carries no accuracy
+const double kUnknownAccuracy = 5000.0;
+// An older fix is replaced even by a less accurate one
+const qint64 kStaleSeconds = 120;
+const qint64 kSaveIntervalSeconds = 60;
+}
+
+LocationService::LocationService(QObject *parent)
+    : QObject(parent)
+    , m_source(nullptr)
+    , m_phase(Idle)
+    , m_accuracy(kUnknownAccuracy)
+    , m_refetchDistance(250.0)
+{
+    restore();
+}
+
+LocationService::~LocationService()
+{
+    save();
+}
+
+void LocationService::setSource(QGeoPositionInfoSource *source)
+{
+    if (m_source == source) {
+        return;
+    }
+
+    const bool wasActive = isActive();
+    stop();
+    if (m_source) {
+        m_source->deleteLater();
+    }
+    m_source = nullptr;
+
+    attach(source);
+    if (wasActive) {
+        start();
+    }
+}
+
+QGeoPositionInfoSource *LocationService::source() const
+{
+    return m_source;
+}
+
+void LocationService::attach(QGeoPositionInfoSource *source)
+{
+    m_source = source;
+    if (!m_source) {
+        return;
+    }
+
+    m_source->setParent(this);
+    connect(m_source, &QGeoPositionInfoSource::positionUpdated, this, &LocationService::onPositionUpdated);
+    connect(m_source, &QGeoPositionInfoSource::errorOccurred, this, &LocationService::onSourceError);
+}
+
+double LocationService::refetchDistance() const
+{
+    return m_refetchDistance;
+}
+
+void LocationService::setRefetchDistance(double meters)
+{
+    m_refetchDistance = qMax(0.0, meters);
+}
+
+bool LocationService::hasPosition() const
+{
+    return m_coordinate.isValid();
+}
+
+QGeoCoordinate LocationService::coordinate() const
+{
+    return m_coordinate;
+}
+
+double LocationService::accuracy() const
+{
+    return m_accuracy;
+}
+
+QDateTime LocationService::timestamp() const
+{
+    return m_timestamp;
+}
+
+bool LocationService::isActive() const
+{
+    return m_phase != Idle;
+}
+
+void LocationService::start()
+{
+    if (m_phase != Idle) {
+        return;
+    }
+
+    if (!m_source) {
+        attach(QGeoPositionInfoSource::createDefaultSource(this));
+        if (!m_source) {
+            emit errorOccurred("Location service is not available.");
+            return;
+        }
+    }
+
+    // Free and instant: whatever the platform fixed last, if newer than ours
+    const QGeoPositionInfo last = m_source->lastKnownPosition();
+    if (last.isValid()) {
+        onPositionUpdated(last);
+    }
+
+    // A cell/Wi-Fi fix arrives in a second or two; a cold satellite lock can take a minute
+    m_phase = Coarse;
+    emit activeChanged();
+    m_source->setPreferredPositioningMethods(QGeoPositionInfoSource::NonSatellitePositioningMethods);
+    m_source->requestUpdate(kCoarseTimeoutMs);
+}
+
+void LocationService::stop()
+{
+    if (m_phase == Idle) {
+        return;
+    }
+
+    m_phase = Idle;
+    if (m_source) {
+        m_source->stopUpdates();
+    }
+    save();
+    emit activeChanged();
+}
+
+void LocationService::startTracking()
+{
+    if (m_phase != Coarse) {
+        return;
+    }
+
+    m_phase = Tracking;
+    m_source->setPreferredPositioningMethods(QGeoPositionInfoSource::AllPositioningMethods);
+    m_source->setUpdateInterval(kTrackingIntervalMs);
+    m_source->startUpdates();
+}
+
+void LocationService::onPositionUpdated(const QGeoPositionInfo &info)
+{
+    if (info.isValid()) {
+        const QDateTime timestamp = info.timestamp().isValid() ? info.timestamp() : QDateTime::currentDateTimeUtc();
+        accept(info.coordinate(), accuracyOf(info), timestamp);
+    }
+
+    // The coarse fix is in; keep refining
+    startTracking();
+}
+
+void LocationService::onSourceError(QGeoPositionInfoSource::Error error)
+{
+    switch (error) {
+    case QGeoPositionInfoSource::UpdateTimeoutError:
+        // No quick fix available: wait for the precise one instead
+        startTracking();
+        return;
+    case QGeoPositionInfoSource::AccessError:
+        emit errorOccurred("Location access denied. Please check your permissions.");
+        break;
+    case QGeoPositionInfoSource::ClosedError:
+        emit errorOccurred("Location service has been closed.");
+        break;
+    default:
+        emit errorOccurred("Location service error occurred.");
+        break;
+    }
+}
+
+bool LocationService::accept(const QGeoCoordinate &coordinate, double accuracy, const QDateTime &timestamp)
+{
+    if (!coordinate.isValid()) {
+        return false;
+    }
+
+    // Progressive improvement: take a fix when it is more accurate, when ours is
+    // stale, or when it is clearly elsewhere even allowing for both error circles
+    if (m_coordinate.isValid()) {
+        const bool newer = !m_timestamp.isValid() || timestamp > m_timestamp;
+        const bool moreAccurate = accuracy <= m_accuracy;
+        const bool stale = m_timestamp.isValid() && m_timestamp.secsTo(timestamp) > kStaleSeconds;
+        const bool moved = m_coordinate.distanceTo(coordinate) > accuracy + m_accuracy;
+        if (!newer || !(moreAccurate || stale || moved)) {
+            return false;
+        }
+    }
+
+    m_coordinate = coordinate;
+    m_accuracy = accuracy;
+    m_timestamp = timestamp;
+    emit positionChanged();
+
+    // A fix only counts as a move once it is beyond its own uncertainty
+    if (!m_anchor.isValid() || m_anchor.distanceTo(coordinate) > qMax(m_refetchDistance, accuracy)) {
+        m_anchor = coordinate;
+        emit movedSignificantly();
+    }
+
+    if (!m_lastSaved.isValid() || m_lastSaved.secsTo(QDateTime::currentDateTimeUtc()) > kSaveIntervalSeconds) {
+        save();
+    }
+    return true;
+}
+
+double LocationService::accuracyOf(const QGeoPositionInfo &info)
+{
+    if (!info.hasAttribute(QGeoPositionInfo::HorizontalAccuracy)) {
+        return kUnknownAccuracy;
+    }
+    const double accuracy = info.attribute(QGeoPositionInfo::HorizontalAccuracy);
+    return qIsNaN(accuracy) || accuracy <= 0.0 ? kUnknownAccuracy : accuracy;
+}
+
+void LocationService::restore()
+{
+    QSettings settings;
+    if (!settings.contains("location/latitude")) {
+        return;
+    }
+
+    const QGeoCoordinate coordinate(settings.value("location/latitude").toDouble(),
+                                    settings.value("location/longitude").toDouble());
+    if (!coordinate.isValid()) {
+        return;
+    }
+
+    m_coordinate = coordinate;
+    m_accuracy = settings.value("location/accuracy", kUnknownAccuracy).toDouble();
+    m_timestamp = settings.value("location/timestamp").toDateTime();
+    // Results for the saved position are shown at startup; only a real move refetches
+    m_anchor = coordinate;
+}
+
+void LocationService::save()
+{
+    if (!m_coordinate.isValid()) {
+        return;
+    }
+
+    QSettings settings;
+    settings.setValue("location/latitude", m_coordinate.latitude());
+    settings.setValue("location/longitude", m_coordinate.longitude());
+    settings.setValue("location/accuracy", m_accuracy);
+    settings.setValue("location/timestamp", m_timestamp);
+    m_lastSaved = QDateTime::currentDateTimeUtc();
+}
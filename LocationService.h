@@ -0,0 +1,82 @@
+#ifndef LOCATIONSERVICE_H
+#define LOCATIONSERVICE_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QGeoCoordinate>
+#include <QGeoPositionInfo>
+#include <QGeoPositionInfoSource>
+
+// Where the user is, as early as possible. Starts from the position saved by
+// the previous run, then the platform's last known position, then a quick
+// network-based fix, and keeps improving it with satellite updates. Only a
+// move beyond the refetch distance is reported as significant, so jitter and
+// accuracy improvements do not trigger new searches.
+class LocationService : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool hasPosition READ hasPosition NOTIFY positionChanged)
+    Q_PROPERTY(QGeoCoordinate coordinate READ coordinate NOTIFY positionChanged)
+    Q_PROPERTY(double accuracy READ accuracy NOTIFY positionChanged)
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged)
+
+public:
+    explicit LocationService(QObject *parent = nullptr);
+    ~LocationService();
+
+    // Replaces the platform source, e.g. with a simulated one; takes ownership
+    void setSource(QGeoPositionInfoSource *source);
+    QGeoPositionInfoSource *source() const;
+
+    double refetchDistance() const;
+    void setRefetchDistance(double meters);
+
+    bool hasPosition() const;
+    QGeoCoordinate coordinate() const;
+    // Horizontal accuracy in metres; large when unknown
+    double accuracy() const;
+    QDateTime timestamp() const;
+    bool isActive() const;
+
+public slots:
+    // Creates the platform source on first use; call after the first frame
+    void start();
+    void stop();
+
+signals:
+    void positionChanged();
+    // First position, or moved further than the refetch distance since the last one
+    void movedSignificantly();
+    void activeChanged();
+    void errorOccurred(const QString &message);
+
+private slots:
+    void onPositionUpdated(const QGeoPositionInfo &info);
+    void onSourceError(QGeoPositionInfoSource::Error error);
+
+private:
+    enum Phase {
+        Idle,
+        Coarse,     // one quick fix from network positioning
+        Tracking    // continuous updates from every method
+    };
+
+    QGeoPositionInfoSource *m_source;
+    Phase m_phase;
+    QGeoCoordinate m_coordinate;
+    double m_accuracy;
+    QDateTime m_timestamp;
+    // Position the last significant move was reported for
+    QGeoCoordinate m_anchor;
+    double m_refetchDistance;
+    QDateTime m_lastSaved;
+
+    void attach(QGeoPositionInfoSource *source);
+    void startTracking();
+    bool accept(const QGeoCoordinate &coordinate, double accuracy, const QDateTime &timestamp);
+    void restore();
+    void save();
+    static double accuracyOf(const QGeoPositionInfo &info);
+};
+
+#endif // LOCATIONSERVICE_H
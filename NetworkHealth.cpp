@@ -0,0 +1,247 @@
+#include "NetworkHealth.h"
+#include <QStringList>
+#include <QVariantMap>
+
+namespace {
+// Before the first answer from a host
+const int kDefaultTimeoutMs = 15000;
+const int kMinTimeoutMs = 3000;
+const int kMaxTimeoutMs = 30000;
+// Failures in a row that open a host's circuit
+const int kFailureThreshold = 5;
+const int kInitialCooldownMs = 5000;
+const int kMaxCooldownMs = 60000;
+const double kErrorRateWeight = 0.1;
+// Counters change with every request; listeners hear about them this often
+const int kUpdateIntervalMs = 500;
+}
+
+NetworkHealth::NetworkHealth(QObject *parent)
+    : QObject(parent)
+    , m_requests(0)
+    , m_retries(0)
+    , m_rejected(0)
+{
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(kUpdateIntervalMs);
+    connect(&m_updateTimer, &QTimer::timeout, this, &NetworkHealth::updated);
+}
+
+int NetworkHealth::timeoutFor(const QUrl &url, int attempt) const
+{
+    const auto it = m_hosts.constFind(keyFor(url));
+    return timeoutOf(it != m_hosts.constEnd() ? &it.value() : nullptr, attempt);
+}
+
+bool NetworkHealth::allowRequest(const QUrl &url)
+{
+    const QString host = keyFor(url);
+    auto it = m_hosts.find(host);
+    if (it == m_hosts.end() || it->state == Closed) {
+        return true;
+    }
+
+    HostStats &stats = it.value();
+    if (stats.state == Open && stats.openedAt.elapsed() >= stats.cooldownMs) {
+        // Cooldown over: this request is the probe
+        setState(host, stats, HalfOpen);
+        stats.probeStartedAt.start();
+        notify(true);
+        return true;
+    }
+    if (stats.state == HalfOpen && stats.probeStartedAt.elapsed() >= kMaxTimeoutMs) {
+        // The probe never reported back (cancelled or dropped); send another
+        stats.probeStartedAt.start();
+        return true;
+    }
+
+    stats.rejected++;
+    m_rejected++;
+    notify(false);
+    return false;
+}
+
+NetworkHealth::CircuitState NetworkHealth::circuitState(const QUrl &url) const
+{
+    return m_hosts.value(keyFor(url)).state;
+}
+
+void NetworkHealth::recordSuccess(const QUrl &url, qint64 elapsedMs)
+{
+    const QString host = keyFor(url);
+    HostStats &stats = m_hosts[host];
+    const CircuitState before = stats.state;
+    stats.requests++;
+    m_requests++;
+    sampleRtt(stats, elapsedMs);
+    stats.errorRate *= 1.0 - kErrorRateWeight;
+    stats.consecutiveFailures = 0;
+
+    if (stats.state != Closed) {
+        stats.cooldownMs = 0;
+        setState(host, stats, Closed);
+    }
+    notify(stats.state != before);
+}
+
+void NetworkHealth::recordFailure(const QUrl &url, qint64 elapsedMs, bool answered)
+{
+    const QString host = keyFor(url);
+    HostStats &stats = m_hosts[host];
+    const CircuitState before = stats.state;
+    stats.requests++;
+    stats.failures++;
+    m_requests++;
+    // A 5xx still tells us how far away the server is; a timeout does not
+    if (answered) {
+        sampleRtt(stats, elapsedMs);
+    }
+    stats.errorRate = stats.errorRate * (1.0 - kErrorRateWeight) + kErrorRateWeight;
+    stats.consecutiveFailures++;
+
+    if (stats.state == HalfOpen) {
+        // The probe failed: stay away for longer each time
+        stats.cooldownMs = qMin(stats.cooldownMs * 2, kMaxCooldownMs);
+        stats.openedAt.start();
+        setState(host, stats, Open);
+    } else if (stats.state == Closed && stats.consecutiveFailures >= kFailureThreshold) {
+        stats.cooldownMs = kInitialCooldownMs;
+        stats.openedAt.start();
+        setState(host, stats, Open);
+    }
+    notify(stats.state != before);
+}
+
+void NetworkHealth::recordRetry(const QUrl &url)
+{
+    m_hosts[keyFor(url)].retries++;
+    m_retries++;
+    notify(false);
+}
+
+QVariantList NetworkHealth::hosts() const
+{
+    QStringList keys = m_hosts.keys();
+    keys.sort();
+
+    QVariantList list;
+    for (const QString &key : qAsConst(keys)) {
+        const HostStats stats = m_hosts.value(key);
+        QVariantMap host;
+        host["host"] = key;
+        host["state"] = stateName(stats.state);
+        host["rttMs"] = stats.srttMs >= 0.0 ? qRound(stats.srttMs) : -1;
+        host["rttVarMs"] = qRound(stats.rttVarMs);
+        host["timeoutMs"] = timeoutOf(&stats, 0);
+        host["requests"] = stats.requests;
+        host["failures"] = stats.failures;
+        host["errorRate"] = stats.errorRate;
+        host["retries"] = stats.retries;
+        host["rejected"] = stats.rejected;
+        list.append(host);
+    }
+    return list;
+}
+
+int NetworkHealth::requests() const
+{
+    return m_requests;
+}
+
+int NetworkHealth::retries() const
+{
+    return m_retries;
+}
+
+int NetworkHealth::rejected() const
+{
+    return m_rejected;
+}
+
+bool NetworkHealth::isDegraded() const
+{
+    for (const HostStats &stats : m_hosts) {
+        if (stats.state != Closed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NetworkHealth::reset()
+{
+    m_hosts.clear();
+    m_requests = 0;
+    m_retries = 0;
+    m_rejected = 0;
+    notify(true);
+}
+
+QString NetworkHealth::keyFor(const QUrl &url)
+{
+    return QString("%1:%2").arg(url.host()).arg(url.port(url.scheme() == "https" ? 443 : 80));
+}
+
+QString NetworkHealth::stateName(CircuitState state)
+{
+    switch (state) {
+    case Closed:
+        return "closed";
+    case Open:
+        return "open";
+    case HalfOpen:
+        return "half-open";
+    }
+    return QString();
+}
+
+int NetworkHealth::timeoutOf(const HostStats *stats, int attempt)
+{
+    int timeout = kDefaultTimeoutMs;
+    if (stats && stats->srttMs >= 0.0) {
+        // RFC 6298: smoothed round trip plus four deviations
+        timeout = qBound(kMinTimeoutMs, qRound(stats->srttMs + 4.0 * stats->rttVarMs), kMaxTimeoutMs);
+    }
+
+    // A retry waits longer than the attempt that just timed out
+    for (int i = 0; i < attempt && timeout < kMaxTimeoutMs; ++i) {
+        timeout *= 2;
+    }
+    return qMin(timeout, kMaxTimeoutMs);
+}
+
+void NetworkHealth::sampleRtt(HostStats &stats, qint64 elapsedMs)
+{
+    const double sample = elapsedMs;
+    if (stats.srttMs < 0.0) {
+        stats.srttMs = sample;
+        stats.rttVarMs = sample / 2.0;
+        return;
+    }
+    stats.rttVarMs = 0.75 * stats.rttVarMs + 0.25 * qAbs(stats.srttMs - sample);
+    stats.srttMs = 0.875 * stats.srttMs + 0.125 * sample;
+}
+
+void NetworkHealth::setState(const QString &host, HostStats &stats, CircuitState state)
+{
+    if (stats.state == state) {
+        return;
+    }
+    const bool wasClosed = stats.state == Closed;
+    stats.state = state;
+
+    // Half-open is an internal step; listeners care about reachable or not
+    if (state == Closed || wasClosed) {
+        emit circuitChanged(host, state);
+    }
+}
+
+void NetworkHealth::notify(bool stateChanged)
+{
+    if (stateChanged) {
+        m_updateTimer.stop();
+        emit updated();
+    } else if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
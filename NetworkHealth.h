@@ -0,0 +1,101 @@
+#ifndef NETWORKHEALTH_H
+#define NETWORKHEALTH_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <QVariantList>
+
+// How each backend has been answering lately, fed by NetworkService with
+// every finished request.
+//
+// Per host (host:port, so the API and the auth service are judged apart) it
+// keeps a smoothed round trip time and its variance, from which the transfer
+// timeout of the next request is derived the way TCP derives its RTO: a fast
+// server gets a short timeout, a slow one is not cut off.
+//
+// After several failures in a row the host's circuit opens and requests are
+// refused without touching the network until a cooldown has passed; then a
+// single probe is let through. Flows get a connectivity error straight away
+// and show cached data instead of waiting on a server that is not there.
+class NetworkHealth : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList hosts READ hosts NOTIFY updated)
+    Q_PROPERTY(int requests READ requests NOTIFY updated)
+    Q_PROPERTY(int retries READ retries NOTIFY updated)
+    Q_PROPERTY(int rejected READ rejected NOTIFY updated)
+    // Some host's circuit is open
+    Q_PROPERTY(bool degraded READ isDegraded NOTIFY updated)
+
+public:
+    enum CircuitState {
+        Closed,     // requests go out
+        Open,       // requests are refused until the cooldown ends
+        HalfOpen    // one probe is out; its outcome decides
+    };
+    Q_ENUM(CircuitState)
+
+    explicit NetworkHealth(QObject *parent = nullptr);
+
+    // Transfer timeout for a request to this URL; doubles with each retry
+    int timeoutFor(const QUrl &url, int attempt = 0) const;
+    // False while the host's circuit is open; may let a half-open probe through
+    bool allowRequest(const QUrl &url);
+    CircuitState circuitState(const QUrl &url) const;
+
+    // A finished request: answered (any HTTP status) or not, and how long it took
+    void recordSuccess(const QUrl &url, qint64 elapsedMs);
+    void recordFailure(const QUrl &url, qint64 elapsedMs, bool answered);
+    void recordRetry(const QUrl &url);
+
+    QVariantList hosts() const;
+    int requests() const;
+    int retries() const;
+    int rejected() const;
+    bool isDegraded() const;
+
+    Q_INVOKABLE void reset();
+
+signals:
+    // Coalesced to a few per second; at once when a circuit changes
+    void updated();
+    // A host's circuit opened or closed
+    void circuitChanged(const QString &host, NetworkHealth::CircuitState state);
+
+private:
+    struct HostStats {
+        // Smoothed round trip and its mean deviation, -1 until the first sample
+        double srttMs = -1.0;
+        double rttVarMs = 0.0;
+        // Exponentially weighted share of failed requests
+        double errorRate = 0.0;
+        int requests = 0;
+        int failures = 0;
+        int retries = 0;
+        int rejected = 0;
+        int consecutiveFailures = 0;
+        CircuitState state = Closed;
+        int cooldownMs = 0;
+        QElapsedTimer openedAt;
+        QElapsedTimer probeStartedAt;
+    };
+
+    QHash<QString, HostStats> m_hosts;
+    int m_requests;
+    int m_retries;
+    int m_rejected;
+    QTimer m_updateTimer;
+
+    static QString keyFor(const QUrl &url);
+    static QString stateName(CircuitState state);
+    static int timeoutOf(const HostStats *stats, int attempt);
+    void sampleRtt(HostStats &stats, qint64 elapsedMs);
+    void setState(const QString &host, HostStats &stats, CircuitState state);
+    void notify(bool stateChanged);
+};
+
+#endif // NETWORKHEALTH_H
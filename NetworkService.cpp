@@ -0,0 +1,390 @@
+#include "NetworkService.h"
+#include <QRandomGenerator>
+#include <QTimer>
+#include "OfflineCache.h"
+
+namespace {
+// Two more tries: enough to ride out a dropped connection, not to stall the caller
+const int kMaxRetries = 2;
+const int kRetryBaseDelayMs = 400;
+const int kRetryMaxDelayMs = 5000;
+
+// Dynamic property on replies our transfer timer aborted
+const char kTimedOutProperty[] = "networkServiceTimedOut";
+}
+
+NetworkService::NetworkService(QObject *parent)
+    : QObject(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+    , m_health(new NetworkHealth(this))
+    , m_nextId(1)
+    , m_maxConcurrentRequests(6)
+    , m_backgrounded(false)
+{
+    // Interactive requests may use every slot; speculative work only a few
+    m_classLimits[Interactive] = 6;
+    m_classLimits[Normal] = 4;
+    m_classLimits[Prefetch] = 2;
+    m_classLimits[Background] = 1;
+
+    for (int i = 0; i < PriorityCount; ++i) {
+        m_inFlightPerClass[i] = 0;
+    }
+}
+
+NetworkService::~NetworkService()
+{
+}
+
+quint64 NetworkService::get(const QNetworkRequest &request, Priority priority, QObject *context, ReplyHandler handler)
+{
+    return send("GET", request, QByteArray(), priority, context, std::move(handler));
+}
+
+quint64 NetworkService::post(const QNetworkRequest &request, const QByteArray &body, Priority priority, QObject *context, ReplyHandler handler)
+{
+    return send("POST", request, body, priority, context, std::move(handler));
+}
+
+quint64 NetworkService::deleteResource(const QNetworkRequest &request, Priority priority, QObject *context, ReplyHandler handler)
+{
+    return send("DELETE", request, QByteArray(), priority, context, std::move(handler));
+}
+
+quint64 NetworkService::send(const QByteArray &verb, const QNetworkRequest &request, const QByteArray &body,
+                             Priority priority, QObject *context, ReplyHandler handler)
+{
+    if (m_backgrounded && isDroppable(priority)) {
+        return 0;
+    }
+
+    PendingRequest pending;
+    pending.id = m_nextId++;
+    pending.priority = priority;
+    pending.verb = verb;
+    pending.request = request;
+    pending.body = body;
+    pending.context = context;
+    pending.handler = std::move(handler);
+    pending.adaptiveTimeout = request.transferTimeout() == 0;
+    pending.transferTimeoutMs = request.transferTimeout();
+    // The timeout is enforced by our own timer, so an abort can be told apart from a timeout
+    pending.request.setTransferTimeout(0);
+
+    // Multiplex over one HTTP/2 connection when the server supports it.
+    // gzip/deflate are negotiated and decoded by QNetworkAccessManager itself.
+    pending.request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+    m_queues[priority].enqueue(pending);
+    dispatch();
+    return pending.id;
+}
+
+void NetworkService::cancel(quint64 id)
+{
+    if (m_retrying.remove(id)) {
+        return;
+    }
+
+    for (QQueue<PendingRequest> &queue : m_queues) {
+        for (int i = 0; i < queue.size(); ++i) {
+            if (queue.at(i).id == id) {
+                queue.removeAt(i);
+                return;
+            }
+        }
+    }
+
+    for (auto it = m_inFlight.cbegin(); it != m_inFlight.cend(); ++it) {
+        if (it.value().id == id) {
+            abortInFlight(it.key());
+            dispatch();
+            return;
+        }
+    }
+}
+
+void NetworkService::prewarm(const QUrl &url)
+{
+    // Open the TCP (and TLS) connection before the first real request needs it
+    if (url.scheme() == "https") {
+        m_networkManager->connectToHostEncrypted(url.host(), url.port(443));
+    } else {
+        m_networkManager->connectToHost(url.host(), url.port(80));
+    }
+}
+
+NetworkHealth *NetworkService::health() const
+{
+    return m_health;
+}
+
+bool NetworkService::isTimedOut(const QNetworkReply *reply)
+{
+    return reply && reply->property(kTimedOutProperty).toBool();
+}
+
+int NetworkService::maxConcurrentRequests() const
+{
+    return m_maxConcurrentRequests;
+}
+
+void NetworkService::setMaxConcurrentRequests(int max)
+{
+    m_maxConcurrentRequests = qMax(1, max);
+    dispatch();
+}
+
+int NetworkService::classLimit(Priority priority) const
+{
+    return m_classLimits[priority];
+}
+
+void NetworkService::setClassLimit(Priority priority, int max)
+{
+    m_classLimits[priority] = qMax(1, max);
+    dispatch();
+}
+
+bool NetworkService::isBackgrounded() const
+{
+    return m_backgrounded;
+}
+
+void NetworkService::setBackgrounded(bool backgrounded)
+{
+    if (m_backgrounded == backgrounded) {
+        return;
+    }
+    m_backgrounded = backgrounded;
+
+    if (!m_backgrounded) {
+        return;
+    }
+
+    // Nobody is looking: drop speculative work instead of spending radio time on it
+    QList<PendingRequest> dropped;
+    for (int priority = Prefetch; priority <= Background; ++priority) {
+        while (!m_queues[priority].isEmpty()) {
+            dropped.append(m_queues[priority].dequeue());
+        }
+    }
+    for (auto it = m_retrying.begin(); it != m_retrying.end();) {
+        if (isDroppable(it.value().priority)) {
+            dropped.append(it.value());
+            it = m_retrying.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const QList<QNetworkReply *> replies = m_inFlight.keys();
+    for (QNetworkReply *reply : replies) {
+        const PendingRequest pending = m_inFlight.value(reply);
+        if (pending.priority == Prefetch) {
+            abortInFlight(reply);
+            dropped.append(pending);
+        }
+    }
+
+    // Only now, with the scheduler consistent again: handlers may send new requests
+    for (const PendingRequest &pending : qAsConst(dropped)) {
+        if (pending.context && pending.handler) {
+            pending.handler(nullptr);
+        }
+    }
+}
+
+bool NetworkService::isDroppable(Priority priority) const
+{
+    return priority == Prefetch || priority == Background;
+}
+
+void NetworkService::dispatch()
+{
+    // Highest class first; each class is capped by its own limit and by the global one
+    for (int priority = Interactive; priority < PriorityCount; ++priority) {
+        QQueue<PendingRequest> &queue = m_queues[priority];
+        while (!queue.isEmpty() && m_inFlightPerClass[priority] < m_classLimits[priority]) {
+            // The user is waiting on interactive work: make room by pushing speculative work back
+            if (m_inFlight.size() >= m_maxConcurrentRequests
+                    && (priority != Interactive || !preemptSpeculativeRequest())) {
+                break;
+            }
+            start(queue.dequeue());
+        }
+    }
+}
+
+void NetworkService::start(PendingRequest pending)
+{
+    // Unless the caller chose one, give up on a silent transfer about when this host would have answered
+    const int timeoutMs = pending.adaptiveTimeout ? m_health->timeoutFor(pending.request.url(), pending.attempt)
+                                                  : pending.transferTimeoutMs;
+    pending.timedOut = false;
+    pending.started.start();
+
+    // Use the dedicated calls for standard verbs so QNetworkReply::operation() stays meaningful
+    QNetworkReply *reply = nullptr;
+    if (pending.verb == "GET") {
+        reply = m_networkManager->get(pending.request);
+    } else if (pending.verb == "POST") {
+        reply = m_networkManager->post(pending.request, pending.body);
+    } else if (pending.verb == "PUT") {
+        reply = m_networkManager->put(pending.request, pending.body);
+    } else if (pending.verb == "DELETE") {
+        reply = m_networkManager->deleteResource(pending.request);
+    } else {
+        reply = m_networkManager->sendCustomRequest(pending.request, pending.verb, pending.body);
+    }
+
+    m_inFlight.insert(reply, pending);
+    m_inFlightPerClass[pending.priority]++;
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onReplyFinished(reply);
+    });
+
+    // Like QNetworkRequest::transferTimeout: restarted whenever data moves
+    QTimer *timer = new QTimer(reply);
+    timer->setSingleShot(true);
+    timer->setInterval(timeoutMs);
+    connect(timer, &QTimer::timeout, this, [this, reply]() {
+        onTransferTimeout(reply);
+    });
+    connect(reply, &QNetworkReply::downloadProgress, timer, qOverload<>(&QTimer::start));
+    connect(reply, &QNetworkReply::uploadProgress, timer, qOverload<>(&QTimer::start));
+    timer->start();
+}
+
+void NetworkService::onTransferTimeout(QNetworkReply *reply)
+{
+    auto it = m_inFlight.find(reply);
+    if (it == m_inFlight.end()) {
+        return;
+    }
+    // finished() fires synchronously from abort() and reaches onReplyFinished with the flag set
+    it->timedOut = true;
+    reply->abort();
+}
+
+void NetworkService::abortInFlight(QNetworkReply *reply)
+{
+    auto it = m_inFlight.find(reply);
+    if (it == m_inFlight.end()) {
+        return;
+    }
+    m_inFlightPerClass[it.value().priority]--;
+    m_inFlight.erase(it);
+
+    // finished() fires synchronously from abort() but the reply is no longer tracked
+    reply->abort();
+    reply->deleteLater();
+}
+
+bool NetworkService::preemptSpeculativeRequest()
+{
+    // Cheapest victims first; only idempotent reads are safe to abort and re-issue
+    for (int priority = Background; priority >= Prefetch; --priority) {
+        for (auto it = m_inFlight.cbegin(); it != m_inFlight.cend(); ++it) {
+            const PendingRequest &pending = it.value();
+            if (pending.priority != priority || pending.verb != "GET") {
+                continue;
+            }
+
+            PendingRequest requeued = pending;
+            abortInFlight(it.key());
+            m_queues[priority].prepend(requeued);
+            return true;
+        }
+    }
+    return false;
+}
+
+void NetworkService::onReplyFinished(QNetworkReply *reply)
+{
+    auto it = m_inFlight.find(reply);
+    if (it == m_inFlight.end()) {
+        // Cancelled or preempted
+        return;
+    }
+
+    PendingRequest pending = it.value();
+    m_inFlightPerClass[pending.priority]--;
+    m_inFlight.erase(it);
+    if (pending.timedOut) {
+        reply->setProperty(kTimedOutProperty, true);
+    }
+
+    // No answer at all, or the server failing; a 4xx is the server working as intended.
+    // An abort from elsewhere says nothing about the host.
+    const QUrl url = pending.request.url();
+    const bool answered = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid();
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() == QNetworkReply::OperationCanceledError && !pending.timedOut) {
+        // Neither a success nor a failure
+    } else if (OfflineCache::isConnectivityError(reply) || status >= 500) {
+        m_health->recordFailure(url, pending.started.elapsed(), answered);
+    } else {
+        m_health->recordSuccess(url, pending.started.elapsed());
+    }
+
+    if (shouldRetry(pending, reply)) {
+        reply->deleteLater();
+        scheduleRetry(pending);
+        dispatch();
+        return;
+    }
+
+    if (pending.context && pending.handler) {
+        pending.handler(reply);
+    } else {
+        reply->deleteLater();
+    }
+
+    dispatch();
+}
+
+bool NetworkService::shouldRetry(const PendingRequest &pending, QNetworkReply *reply) const
+{
+    // Only reads are safe to send twice, and not to a host that is being left alone
+    if (pending.verb != "GET" || pending.attempt >= kMaxRetries || !pending.context
+        || m_health->circuitState(pending.request.url()) != NetworkHealth::Closed) {
+        return false;
+    }
+    if (m_backgrounded && isDroppable(pending.priority)) {
+        return false;
+    }
+    if (reply->error() == QNetworkReply::OperationCanceledError && !pending.timedOut) {
+        return false;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return OfflineCache::isConnectivityError(reply) || status == 502 || status == 503 || status == 504;
+}
+
+void NetworkService::scheduleRetry(PendingRequest pending)
+{
+    pending.attempt++;
+    m_health->recordRetry(pending.request.url());
+
+    // Exponential backoff with equal jitter, so clients that failed together do not retry together
+    const int ceiling = qMin(kRetryMaxDelayMs, kRetryBaseDelayMs << (pending.attempt - 1));
+    const int delay = ceiling / 2 + int(QRandomGenerator::global()->bounded(ceiling / 2 + 1));
+
+    const quint64 id = pending.id;
+    m_retrying.insert(id, pending);
+    QTimer::singleShot(delay, this, [this, id]() {
+        auto it = m_retrying.find(id);
+        if (it == m_retrying.end()) {
+            // Cancelled while waiting
+            return;
+        }
+        const PendingRequest retry = it.value();
+        m_retrying.erase(it);
+        if (!retry.context) {
+            return;
+        }
+        m_queues[retry.priority].prepend(retry);
+        dispatch();
+    });
+}
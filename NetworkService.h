@@ -0,0 +1,121 @@
+#ifndef NETWORKSERVICE_H
+#define NETWORKSERVICE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QQueue>
+#include <QUrl>
+#include <functional>
+#include "NetworkHealth.h"
+
+// Single network layer shared by every controller: one QNetworkAccessManager
+// (so connections are reused across controllers), HTTP/2 where the server
+// offers it, and a scheduler in front of the wire.
+//
+// Requests are grouped in priority classes, each with its own concurrency
+// limit, so prefetches and background refreshes can never occupy the slots
+// the user is waiting on.
+//
+// Every request gets a transfer timeout fitted to how fast its host has been
+// answering (see NetworkHealth), and GETs that fail without an answer or with
+// a gateway error are sent again after a jittered, growing delay.
+class NetworkService : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Interactive,    // the user is waiting: searches, detail loads, login
+        Normal,         // refreshes and mutations
+        Prefetch,       // speculative cache warming
+        Background      // profile refreshes and other housekeeping
+    };
+    Q_ENUM(Priority)
+
+    // The handler owns the reply and must deleteLater() it. It runs at most
+    // once, with nullptr when the request was dropped without an answer
+    // (speculative work when the app goes to the background). It is not
+    // called after cancel(); the caller that cancels finishes its own work.
+    using ReplyHandler = std::function<void(QNetworkReply *)>;
+
+    explicit NetworkService(QObject *parent = nullptr);
+    ~NetworkService();
+
+    // Return a request id for cancel(), or 0 if the request was dropped
+    quint64 get(const QNetworkRequest &request, Priority priority, QObject *context, ReplyHandler handler);
+    quint64 post(const QNetworkRequest &request, const QByteArray &body, Priority priority, QObject *context, ReplyHandler handler);
+    quint64 deleteResource(const QNetworkRequest &request, Priority priority, QObject *context, ReplyHandler handler);
+    quint64 send(const QByteArray &verb, const QNetworkRequest &request, const QByteArray &body,
+                 Priority priority, QObject *context, ReplyHandler handler);
+    // Drops the request wherever it is and never calls its handler
+    void cancel(quint64 id);
+
+    void prewarm(const QUrl &url);
+
+    // Every class counts against the global limit; at the limit interactive
+    // requests preempt speculative GETs instead of exceeding it
+    int maxConcurrentRequests() const;
+    void setMaxConcurrentRequests(int max);
+    int classLimit(Priority priority) const;
+    void setClassLimit(Priority priority, int max);
+
+    // Round trips, error rates and circuit state per host
+    NetworkHealth *health() const;
+
+    // The reply was aborted by its transfer timeout, not cancelled
+    static bool isTimedOut(const QNetworkReply *reply);
+
+    // While the app is backgrounded prefetch and background work is dropped;
+    // queued and in-flight prefetches get their handler called with nullptr
+    bool isBackgrounded() const;
+    void setBackgrounded(bool backgrounded);
+
+private:
+    struct PendingRequest {
+        quint64 id = 0;
+        Priority priority = Normal;
+        QByteArray verb;
+        QNetworkRequest request;
+        QByteArray body;
+        QPointer<QObject> context;
+        ReplyHandler handler;
+        // Retries so far, and whether the transfer timeout is ours to pick
+        int attempt = 0;
+        bool adaptiveTimeout = true;
+        int transferTimeoutMs = 0;
+        // Set by our transfer timer just before it aborts the reply
+        bool timedOut = false;
+        QElapsedTimer started;
+    };
+
+    static const int PriorityCount = Background + 1;
+
+    QNetworkAccessManager *m_networkManager;
+    NetworkHealth *m_health;
+    QQueue<PendingRequest> m_queues[PriorityCount];
+    int m_classLimits[PriorityCount];
+    int m_inFlightPerClass[PriorityCount];
+    QHash<QNetworkReply *, PendingRequest> m_inFlight;
+    // Failed GETs waiting out their backoff, by request id
+    QHash<quint64, PendingRequest> m_retrying;
+    quint64 m_nextId;
+    int m_maxConcurrentRequests;
+    bool m_backgrounded;
+
+    bool isDroppable(Priority priority) const;
+    void dispatch();
+    void start(PendingRequest pending);
+    void abortInFlight(QNetworkReply *reply);
+    void onTransferTimeout(QNetworkReply *reply);
+    bool preemptSpeculativeRequest();
+    void onReplyFinished(QNetworkReply *reply);
+    bool shouldRetry(const PendingRequest &pending, QNetworkReply *reply) const;
+    void scheduleRetry(PendingRequest pending);
+};
+
+#endif // NETWORKSERVICE_H
@@ -0,0 +1,72 @@
+#include "OfflineCache.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkReply>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+OfflineCache::OfflineCache(const QString &name)
+    : m_directory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/offline/" + name)
+{
+    QDir().mkpath(m_directory);
+}
+
+QByteArray OfflineCache::load(const QString &key) const
+{
+    QFile file(pathForKey(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+QDateTime OfflineCache::timestamp(const QString &key) const
+{
+    QFileInfo info(pathForKey(key));
+    return info.exists() ? info.lastModified() : QDateTime();
+}
+
+bool OfflineCache::contains(const QString &key) const
+{
+    return QFile::exists(pathForKey(key));
+}
+
+void OfflineCache::store(const QString &key, const QByteArray &data)
+{
+    // Write atomically so a crash never leaves a truncated entry behind
+    QSaveFile file(pathForKey(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.write(data);
+    file.commit();
+}
+
+void OfflineCache::remove(const QString &key)
+{
+    QFile::remove(pathForKey(key));
+}
+
+void OfflineCache::clear()
+{
+    QDir dir(m_directory);
+    dir.removeRecursively();
+    QDir().mkpath(m_directory);
+}
+
+bool OfflineCache::isConnectivityError(QNetworkReply *reply)
+{
+    if (reply->error() == QNetworkReply::NoError) {
+        return false;
+    }
+    // Any HTTP status means the server answered, so we are online
+    return !reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid();
+}
+
+QString OfflineCache::pathForKey(const QString &key) const
+{
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory + "/" + QString::fromLatin1(hash) + ".json";
+}
@@ -0,0 +1,32 @@
+#ifndef OFFLINECACHE_H
+#define OFFLINECACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+class QNetworkReply;
+
+// Small on-disk cache of raw server responses, used to serve reads while offline.
+class OfflineCache
+{
+public:
+    explicit OfflineCache(const QString &name);
+
+    QByteArray load(const QString &key) const;
+    QDateTime timestamp(const QString &key) const;
+    bool contains(const QString &key) const;
+    void store(const QString &key, const QByteArray &data);
+    void remove(const QString &key);
+    void clear();
+
+    // True when the request never got an HTTP response (no route, DNS, timeout...)
+    static bool isConnectivityError(QNetworkReply *reply);
+
+private:
+    QString pathForKey(const QString &key) const;
+
+    QString m_directory;
+};
+
+#endif // OFFLINECACHE_H
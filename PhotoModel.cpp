@@ -0,0 +1,48 @@
+#include "PhotoModel.h"
+
+PhotoModel::PhotoModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int PhotoModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return m_photos.size();
+}
+
+QVariant PhotoModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_photos.size())
+        return QVariant();
+
+    if (role == UrlRole || role == Qt::DisplayRole)
+        return m_photos.at(index.row());
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> PhotoModel::roleNames() const
+{
+    static const QHash<int, QByteArray> roles { { UrlRole, "url" } };
+    return roles;
+}
+
+int PhotoModel::count() const
+{
+    return m_photos.size();
+}
+
+void PhotoModel::setPhotos(const QStringList &photos)
+{
+    if (photos == m_photos)
+        return;
+
+    // Shares the restaurant's list; nothing is copied until one side changes
+    beginResetModel();
+    m_photos = photos;
+    endResetModel();
+    emit countChanged();
+}
@@ -0,0 +1,35 @@
+#ifndef PHOTOMODEL_H
+#define PHOTOMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+// Photo URLs of one restaurant, exposed to QML as a model so views bind to
+// rows instead of copying the whole list into a variant on every access.
+class PhotoModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum PhotoRoles {
+        UrlRole = Qt::UserRole + 1
+    };
+
+    explicit PhotoModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const;
+    void setPhotos(const QStringList &photos);
+
+signals:
+    void countChanged();
+
+private:
+    QStringList m_photos;
+};
+
+#endif // PHOTOMODEL_H
@@ -0,0 +1,179 @@
+#include "PrefetchEngine.h"
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+#include <QNetworkInformation>
+#endif
+
+namespace {
+const int kIdleDelayMs = 2000;
+const qint64 kBudgetWindowMs = 60 * 60 * 1000;
+}
+
+PrefetchEngine::PrefetchEngine(NetworkService *network, OfflineCache *cache, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_cache(cache)
+    , m_idleTimer(new QTimer(this))
+    , m_inFlight(0)
+    , m_enabled(true)
+    , m_freshnessSeconds(10 * 60)
+    , m_maxRequestsPerHour(40)
+    , m_maxBytesPerHour(2 * 1024 * 1024)
+    , m_requestsInWindow(0)
+    , m_bytesInWindow(0)
+{
+    m_requestFactory = [](const QUrl &url) { return QNetworkRequest(url); };
+
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(kIdleDelayMs);
+    connect(m_idleTimer, &QTimer::timeout, this, &PrefetchEngine::fetchNext);
+
+    m_budgetWindow.start();
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Metered);
+#endif
+}
+
+void PrefetchEngine::setRequestFactory(RequestFactory factory)
+{
+    m_requestFactory = std::move(factory);
+}
+
+void PrefetchEngine::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (!m_enabled) {
+        m_idleTimer->stop();
+        if (m_inFlight) {
+            m_network->cancel(m_inFlight);
+            m_inFlight = 0;
+        }
+    } else if (!m_pending.isEmpty()) {
+        m_idleTimer->start();
+    }
+}
+
+bool PrefetchEngine::isEnabled() const
+{
+    return m_enabled;
+}
+
+int PrefetchEngine::freshnessSeconds() const
+{
+    return m_freshnessSeconds;
+}
+
+void PrefetchEngine::setFreshnessSeconds(int seconds)
+{
+    m_freshnessSeconds = seconds;
+}
+
+bool PrefetchEngine::isFresh(const QUrl &url) const
+{
+    const QDateTime timestamp = m_cache->timestamp(url.toString());
+    return timestamp.isValid() && timestamp.secsTo(QDateTime::currentDateTime()) < m_freshnessSeconds;
+}
+
+void PrefetchEngine::setBudget(int maxRequestsPerHour, qint64 maxBytesPerHour)
+{
+    m_maxRequestsPerHour = maxRequestsPerHour;
+    m_maxBytesPerHour = maxBytesPerHour;
+}
+
+void PrefetchEngine::schedule(const QList<QUrl> &urls)
+{
+    m_pending.clear();
+    for (const QUrl &url : urls) {
+        enqueue(url);
+    }
+}
+
+void PrefetchEngine::enqueue(const QUrl &url)
+{
+    if (m_pending.contains(url) || isFresh(url)) {
+        return;
+    }
+    m_pending.append(url);
+
+    if (m_enabled && !m_inFlight && !m_idleTimer->isActive()) {
+        m_idleTimer->start();
+    }
+}
+
+void PrefetchEngine::noteActivity()
+{
+    // Restart the idle countdown; the in-flight prefetch (if any) is left to the scheduler
+    if (m_enabled && !m_pending.isEmpty()) {
+        m_idleTimer->start();
+    }
+}
+
+void PrefetchEngine::fetchNext()
+{
+    if (!m_enabled || m_inFlight || m_pending.isEmpty() || m_idleTimer->isActive()) {
+        return;
+    }
+    if (isMeteredConnection() || !withinBudget()) {
+        return;
+    }
+
+    const QUrl url = m_pending.takeFirst();
+    if (isFresh(url)) {
+        fetchNext();
+        return;
+    }
+
+    m_requestsInWindow++;
+    m_inFlight = m_network->get(m_requestFactory(url), NetworkService::Prefetch, this, [this, url](QNetworkReply *reply) {
+        handleReply(url, reply);
+    });
+
+    // Dropped because the app is in the background
+    if (!m_inFlight) {
+        m_pending.prepend(url);
+    }
+}
+
+bool PrefetchEngine::withinBudget()
+{
+    if (m_budgetWindow.elapsed() > kBudgetWindowMs) {
+        m_budgetWindow.restart();
+        m_requestsInWindow = 0;
+        m_bytesInWindow = 0;
+    }
+    return m_requestsInWindow < m_maxRequestsPerHour && m_bytesInWindow < m_maxBytesPerHour;
+}
+
+bool PrefetchEngine::isMeteredConnection() const
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    if (QNetworkInformation *info = QNetworkInformation::instance()) {
+        return info->isMetered();
+    }
+#endif
+    return false;
+}
+
+void PrefetchEngine::handleReply(const QUrl &url, QNetworkReply *reply)
+{
+    m_inFlight = 0;
+
+    if (!reply) {
+        // Dropped when the app went to the background: try again on the next idle period
+        m_pending.prepend(url);
+        return;
+    }
+
+    if (reply->error() == QNetworkReply::NoError) {
+        const QByteArray data = reply->readAll();
+        m_bytesInWindow += data.size();
+        m_cache->store(url.toString(), data);
+        emit prefetched(url, data);
+        // Keep going while we are still idle
+        QTimer::singleShot(0, this, &PrefetchEngine::fetchNext);
+    }
+    // On failure wait for the next activity instead of hammering a struggling link
+
+    reply->deleteLater();
+}
@@ -0,0 +1,69 @@
+#ifndef PREFETCHENGINE_H
+#define PREFETCHENGINE_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+#include <QUrl>
+#include <functional>
+#include "NetworkService.h"
+#include "OfflineCache.h"
+
+// Warms the offline cache while the app is idle so that likely next requests
+// (neighbouring areas, quick filters) are answered from disk. Works within a
+// request/byte budget per hour and stays quiet on metered connections.
+class PrefetchEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    using RequestFactory = std::function<QNetworkRequest(const QUrl &)>;
+
+    PrefetchEngine(NetworkService *network, OfflineCache *cache, QObject *parent = nullptr);
+
+    void setRequestFactory(RequestFactory factory);
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    // Entries younger than this are considered fresh and are not fetched again
+    int freshnessSeconds() const;
+    void setFreshnessSeconds(int seconds);
+    bool isFresh(const QUrl &url) const;
+
+    void setBudget(int maxRequestsPerHour, qint64 maxBytesPerHour);
+
+    // Replaces the pending set; earlier entries are fetched first
+    void schedule(const QList<QUrl> &urls);
+    void enqueue(const QUrl &url);
+
+signals:
+    void prefetched(const QUrl &url, const QByteArray &data);
+
+public slots:
+    // Foreground traffic resets the idle timer and pauses prefetching
+    void noteActivity();
+
+private:
+    NetworkService *m_network;
+    OfflineCache *m_cache;
+    RequestFactory m_requestFactory;
+    QTimer *m_idleTimer;
+    QList<QUrl> m_pending;
+    QElapsedTimer m_budgetWindow;
+    quint64 m_inFlight;
+    bool m_enabled;
+    int m_freshnessSeconds;
+    int m_maxRequestsPerHour;
+    qint64 m_maxBytesPerHour;
+    int m_requestsInWindow;
+    qint64 m_bytesInWindow;
+
+    void fetchNext();
+    bool withinBudget();
+    bool isMeteredConnection() const;
+    void handleReply(const QUrl &url, QNetworkReply *reply);
+};
+
+#endif // PREFETCHENGINE_H
@@ -0,0 +1,54 @@
+#include "RemoteImageProvider.h"
+#include "ImageService.h"
+
+RemoteImageResponse::RemoteImageResponse(const QUrl &url, const QSize &requestedSize, ImageService *service)
+    : m_url(url)
+    , m_requestedSize(requestedSize)
+    , m_service(service)
+{
+}
+
+QQuickTextureFactory *RemoteImageResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+QString RemoteImageResponse::errorString() const
+{
+    return m_image.isNull() ? QStringLiteral("Failed to load %1").arg(m_url.toString()) : QString();
+}
+
+void RemoteImageResponse::cancel()
+{
+    // The engine keeps us alive until finished(), which the service emits
+    m_service->cancel(this);
+}
+
+QUrl RemoteImageResponse::url() const
+{
+    return m_url;
+}
+
+QSize RemoteImageResponse::requestedSize() const
+{
+    return m_requestedSize;
+}
+
+void RemoteImageResponse::finish(const QImage &image)
+{
+    m_image = image;
+    emit finished();
+}
+
+RemoteImageProvider::RemoteImageProvider(ImageService *service)
+    : m_service(service)
+{
+}
+
+QQuickImageResponse *RemoteImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    const QUrl url(QUrl::fromPercentEncoding(id.toUtf8()));
+    RemoteImageResponse *response = new RemoteImageResponse(url, requestedSize, m_service);
+    m_service->request(response);
+    return response;
+}
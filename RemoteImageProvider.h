@@ -0,0 +1,45 @@
+#ifndef REMOTEIMAGEPROVIDER_H
+#define REMOTEIMAGEPROVIDER_H
+
+#include <QQuickAsyncImageProvider>
+#include <QQuickImageResponse>
+#include <QImage>
+#include <QUrl>
+
+class ImageService;
+
+class RemoteImageResponse : public QQuickImageResponse
+{
+public:
+    RemoteImageResponse(const QUrl &url, const QSize &requestedSize, ImageService *service);
+
+    QQuickTextureFactory *textureFactory() const override;
+    QString errorString() const override;
+    void cancel() override;
+
+    QUrl url() const;
+    QSize requestedSize() const;
+
+    // Called by ImageService, once
+    void finish(const QImage &image);
+
+private:
+    QUrl m_url;
+    QSize m_requestedSize;
+    ImageService *m_service;
+    QImage m_image;
+};
+
+// Serves "image://remote/<percent-encoded url>" through ImageService
+class RemoteImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    explicit RemoteImageProvider(ImageService *service);
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+private:
+    ImageService *m_service;
+};
+
+#endif // REMOTEIMAGEPROVIDER_H
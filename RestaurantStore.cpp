@@ -0,0 +1,416 @@
+#include "RestaurantStore.h"
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+// Rows kept in memory before unreferenced ones are evicted, down to kTrimTarget
+const int kMaxRows = 2000;
+const int kTrimTarget = 1500;
+// Photo models are only needed while a page shows the restaurant
+const int kMaxPhotoModels = 100;
+}
+
+RestaurantStore::RestaurantStore(QObject *parent)
+    : QObject(parent)
+    , m_favoritesKnown(false)
+    , m_catalogIndexed(false)
+    , m_trimScheduled(false)
+    , m_uncatalogued(0)
+{
+}
+
+bool RestaurantStore::openCatalog(const QString &path)
+{
+    if (!m_catalog.open(path)) {
+        qWarning() << "Offline catalog unavailable:" << path << m_catalog.errorString();
+        return false;
+    }
+
+    m_catalogIndexed = false;
+    m_uncatalogued = 0;
+    for (auto it = m_restaurants.cbegin(); it != m_restaurants.cend(); ++it) {
+        if (m_catalog.indexOf(it.key()) < 0) {
+            m_uncatalogued++;
+        }
+    }
+    emit countChanged();
+    return true;
+}
+
+int RestaurantStore::catalogSize() const
+{
+    return m_catalog.size();
+}
+
+int RestaurantStore::count() const
+{
+    return m_catalog.size() + m_uncatalogued;
+}
+
+bool RestaurantStore::contains(const QString &id) const
+{
+    return m_restaurants.contains(id) || m_catalog.indexOf(id) >= 0;
+}
+
+const Restaurant *RestaurantStore::find(const QString &id) const
+{
+    const auto it = m_restaurants.constFind(id);
+    if (it != m_restaurants.constEnd()) {
+        return &it.value();
+    }
+
+    const int row = m_catalog.indexOf(id);
+    if (row < 0) {
+        return nullptr;
+    }
+
+    // Decode once; later lookups are served from memory like network rows
+    Restaurant restaurant = m_catalog.restaurant(row);
+    restaurant.isFavorite = m_favorites.contains(id);
+    if (m_restaurants.size() >= kMaxRows) {
+        scheduleTrim();
+    }
+    return &m_restaurants.insert(id, restaurant).value();
+}
+
+Restaurant RestaurantStore::restaurant(const QString &id) const
+{
+    const Restaurant *found = find(id);
+    return found ? *found : Restaurant();
+}
+
+QStringList RestaurantStore::ingest(const QJsonArray &results)
+{
+    QVector<Restaurant> restaurants;
+    restaurants.reserve(results.size());
+    for (const QJsonValue &value : results) {
+        const Restaurant restaurant = Restaurant::fromJson(value.toObject());
+        if (!restaurant.id.isEmpty()) {
+            restaurants.append(restaurant);
+        }
+    }
+    upsert(restaurants);
+
+    QStringList ids;
+    ids.reserve(restaurants.size());
+    for (const Restaurant &restaurant : qAsConst(restaurants)) {
+        ids.append(restaurant.id);
+    }
+    return ids;
+}
+
+void RestaurantStore::upsert(const QVector<Restaurant> &restaurants)
+{
+    if (restaurants.isEmpty()) {
+        return;
+    }
+
+    const int before = count();
+    QStringList ids;
+    QStringList newFavorites;
+    ids.reserve(restaurants.size());
+    for (const Restaurant &restaurant : restaurants) {
+        if (store(restaurant)) {
+            newFavorites.append(restaurant.id);
+        }
+        ids.append(restaurant.id);
+    }
+
+    if (m_restaurants.size() > kMaxRows) {
+        scheduleTrim();
+    }
+    if (count() != before) {
+        emit countChanged();
+    }
+    // Only once every row is in, so listeners can look them up
+    for (const QString &id : qAsConst(newFavorites)) {
+        emit favoriteChanged(id, true);
+    }
+    emit restaurantsChanged(ids);
+}
+
+void RestaurantStore::releaseDetails(const QString &id)
+{
+    const auto it = m_restaurants.find(id);
+    if (it == m_restaurants.end() || !it->detailed) {
+        return;
+    }
+
+    // The text index keeps its terms, so searches still find the row
+    it->phoneNumber.clear();
+    it->website.clear();
+    it->description.clear();
+    it->photos.clear();
+    it->detailed = false;
+
+    PhotoModel *photos = m_photoModels.value(id);
+    if (photos) {
+        photos->setPhotos(QStringList());
+    }
+}
+
+void RestaurantStore::retain(const QString &id)
+{
+    m_references[id]++;
+}
+
+void RestaurantStore::release(const QString &id)
+{
+    const auto it = m_references.find(id);
+    if (it == m_references.end()) {
+        return;
+    }
+    if (--it.value() == 0) {
+        m_references.erase(it);
+        if (m_restaurants.size() > kMaxRows || m_photoModels.size() > kMaxPhotoModels) {
+            scheduleTrim();
+        }
+    }
+}
+
+bool RestaurantStore::store(Restaurant restaurant)
+{
+    // A list row leaves out the heavy fields; keep the ones an earlier detail fetch brought
+    if (!restaurant.detailed) {
+        const Restaurant *known = find(restaurant.id);
+        if (known && known->detailed) {
+            restaurant.phoneNumber = known->phoneNumber;
+            restaurant.website = known->website;
+            restaurant.description = known->description;
+            restaurant.photos = known->photos;
+            restaurant.detailed = true;
+        }
+    }
+
+    // Favorites belong to the store once the user's list is known
+    bool newFavorite = false;
+    if (m_favoritesKnown) {
+        restaurant.isFavorite = m_favorites.contains(restaurant.id);
+    } else if (restaurant.isFavorite) {
+        newFavorite = !m_favorites.contains(restaurant.id);
+        m_favorites.insert(restaurant.id);
+    } else {
+        restaurant.isFavorite = m_favorites.contains(restaurant.id);
+    }
+
+    PhotoModel *photos = m_photoModels.value(restaurant.id);
+    if (photos) {
+        photos->setPhotos(restaurant.photos);
+    }
+
+    m_searchIndex.insert(restaurant.id, restaurant.name, restaurant.description);
+    m_geoIndex.insert(restaurant.id, restaurant.latitude, restaurant.longitude);
+    if (!m_restaurants.contains(restaurant.id) && m_catalog.indexOf(restaurant.id) < 0) {
+        m_uncatalogued++;
+    }
+    m_restaurants.insert(restaurant.id, restaurant);
+    return newFavorite;
+}
+
+bool RestaurantStore::isFavorite(const QString &id) const
+{
+    return m_favorites.contains(id);
+}
+
+QStringList RestaurantStore::favoriteIds() const
+{
+    return QStringList(m_favorites.cbegin(), m_favorites.cend());
+}
+
+void RestaurantStore::setFavorites(const QStringList &ids)
+{
+    m_favoritesKnown = true;
+
+    const QSet<QString> favorites(ids.cbegin(), ids.cend());
+    if (favorites == m_favorites) {
+        return;
+    }
+
+    const QSet<QString> previous = m_favorites;
+    m_favorites = favorites;
+    for (auto it = m_restaurants.begin(); it != m_restaurants.end(); ++it) {
+        it->isFavorite = m_favorites.contains(it.key());
+    }
+
+    for (const QString &id : previous) {
+        if (!m_favorites.contains(id)) {
+            emit favoriteChanged(id, false);
+        }
+    }
+    for (const QString &id : qAsConst(m_favorites)) {
+        if (!previous.contains(id)) {
+            emit favoriteChanged(id, true);
+        }
+    }
+    emit favoritesReset();
+}
+
+void RestaurantStore::setFavorite(const QString &id, bool isFavorite)
+{
+    if (m_favorites.contains(id) == isFavorite) {
+        return;
+    }
+
+    if (isFavorite) {
+        m_favorites.insert(id);
+    } else {
+        m_favorites.remove(id);
+    }
+
+    const auto it = m_restaurants.find(id);
+    if (it != m_restaurants.end()) {
+        it->isFavorite = isFavorite;
+    }
+    emit favoriteChanged(id, isFavorite);
+}
+
+void RestaurantStore::toggleFavorite(const QString &id)
+{
+    const bool isFavorite = !m_favorites.contains(id);
+    setFavorite(id, isFavorite);
+    emit favoriteToggled(id, isFavorite);
+}
+
+QVector<SearchIndex::Match> RestaurantStore::search(const QString &text, int limit) const
+{
+    indexCatalog();
+    return m_searchIndex.search(text, limit);
+}
+
+void RestaurantStore::indexCatalog() const
+{
+    if (m_catalogIndexed) {
+        return;
+    }
+    m_catalogIndexed = true;
+
+    for (int row = 0; row < m_catalog.size(); ++row) {
+        const QString id = m_catalog.id(row);
+        // Network rows are already indexed and may be newer
+        if (!m_searchIndex.contains(id)) {
+            // Only the two indexed fields are read from the mapping; the row itself stays undecoded
+            m_searchIndex.insert(id, QString::fromUtf8(m_catalog.nameBytes(row)),
+                                 QString::fromUtf8(m_catalog.descriptionBytes(row)));
+        }
+    }
+}
+
+QVector<QString> RestaurantStore::candidates(double latitude, double longitude, double radiusMeters) const
+{
+    QVector<QString> ids = m_geoIndex.candidates(latitude, longitude, radiusMeters);
+    if (!m_catalog.isOpen()) {
+        return ids;
+    }
+
+    // Network rows win; a catalog row only adds places we have not fetched
+    const QSet<QString> known(ids.cbegin(), ids.cend());
+    const QVector<int> rows = m_catalog.candidates(latitude, longitude, radiusMeters);
+    for (int row : rows) {
+        const QString id = m_catalog.id(row);
+        if (!known.contains(id) && !m_geoIndex.contains(id)) {
+            ids.append(id);
+        }
+    }
+    return ids;
+}
+
+QVariantMap RestaurantStore::get(const QString &id) const
+{
+    const Restaurant *restaurant = find(id);
+    if (!restaurant) {
+        return QVariantMap();
+    }
+
+    QVariantMap map;
+    map["id"] = restaurant->id;
+    map["name"] = restaurant->name;
+    map["address"] = restaurant->address;
+    map["phoneNumber"] = restaurant->phoneNumber;
+    map["website"] = restaurant->website;
+    map["cuisineType"] = restaurant->cuisineType;
+    map["description"] = restaurant->description;
+    map["latitude"] = restaurant->latitude;
+    map["longitude"] = restaurant->longitude;
+    map["rating"] = restaurant->rating;
+    map["isVegan"] = restaurant->isVegan;
+    map["isVegetarian"] = restaurant->isVegetarian;
+    map["photos"] = QVariant::fromValue<QObject *>(photos(id));
+    map["distance"] = restaurant->distance;
+    map["isFavorite"] = restaurant->isFavorite;
+    map["detailed"] = restaurant->detailed;
+    return map;
+}
+
+PhotoModel *RestaurantStore::photos(const QString &id) const
+{
+    const Restaurant *restaurant = find(id);
+    if (!restaurant) {
+        return nullptr;
+    }
+
+    PhotoModel *model = m_photoModels.value(id);
+    if (!model) {
+        // Parented to the store, so QML never takes ownership
+        model = new PhotoModel(const_cast<RestaurantStore *>(this));
+        model->setPhotos(restaurant->photos);
+        m_photoModels.insert(id, model);
+        if (m_photoModels.size() > kMaxPhotoModels) {
+            scheduleTrim();
+        }
+    }
+    return model;
+}
+
+void RestaurantStore::scheduleTrim() const
+{
+    if (m_trimScheduled) {
+        return;
+    }
+    m_trimScheduled = true;
+    RestaurantStore *self = const_cast<RestaurantStore *>(this);
+    QTimer::singleShot(0, self, &RestaurantStore::trim);
+}
+
+void RestaurantStore::trim()
+{
+    m_trimScheduled = false;
+
+    // Favorites stay so the favorites page and offline lists keep their rows
+    const auto evictable = [this](const QString &id) {
+        return !m_references.contains(id) && !m_favorites.contains(id);
+    };
+
+    for (auto it = m_photoModels.begin(); it != m_photoModels.end() && m_photoModels.size() > kMaxPhotoModels;) {
+        if (evictable(it.key())) {
+            it.value()->deleteLater();
+            it = m_photoModels.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (m_restaurants.size() <= kMaxRows) {
+        return;
+    }
+    const int before = count();
+    for (auto it = m_restaurants.begin(); it != m_restaurants.end() && m_restaurants.size() > kTrimTarget;) {
+        const QString id = it.key();
+        if (!evictable(id)) {
+            ++it;
+            continue;
+        }
+        // A catalog row is decoded again on the next lookup; a network-only row is gone for good
+        if (m_catalog.indexOf(id) < 0) {
+            m_searchIndex.remove(id);
+            m_geoIndex.remove(id);
+            m_uncatalogued--;
+        }
+        if (PhotoModel *photos = m_photoModels.take(id)) {
+            photos->deleteLater();
+        }
+        it = m_restaurants.erase(it);
+    }
+    if (count() != before) {
+        emit countChanged();
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef RESTAURANTSTORE_H
+#define RESTAURANTSTORE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QJsonArray>
+#include <QVariantMap>
+#include "ResturantModel.h"
+#include "SearchIndex.h"
+#include "GeoHashIndex.h"
+#include "CatalogFile.h"
+
+// The one copy of every restaurant the app knows about, plus the user's
+// favorite set. Controllers write into it; list models are projections that
+// hold ids and look rows up here, so an update reaches every screen at once.
+// An offline catalog file backs the store: its rows stay in the mapped file
+// and are only decoded when something looks them up. Rows nothing retains
+// are evicted once the store grows past its limit.
+class RestaurantStore : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit RestaurantStore(QObject *parent = nullptr);
+
+    // Maps a catalog built by build_catalog.py; rows from the network take precedence
+    bool openCatalog(const QString &path);
+    int catalogSize() const;
+
+    // Every restaurant known: the catalog's rows plus network rows it lacks
+    int count() const;
+    bool contains(const QString &id) const;
+    // Valid until the next call into the store
+    const Restaurant *find(const QString &id) const;
+    Restaurant restaurant(const QString &id) const;
+
+    // Parses and merges API rows; returns their ids in order
+    QStringList ingest(const QJsonArray &results);
+    void upsert(const QVector<Restaurant> &restaurants);
+    // Drops description, contact details and photos; the row stays for lists
+    void releaseDetails(const QString &id);
+
+    // Models and services hold the ids they show; only unreferenced rows are evicted
+    void retain(const QString &id);
+    void release(const QString &id);
+
+    bool isFavorite(const QString &id) const;
+    QStringList favoriteIds() const;
+    // Replaces the whole favorite set, e.g. with the server's list
+    void setFavorites(const QStringList &ids);
+
+    QVector<SearchIndex::Match> search(const QString &text, int limit) const;
+    // Ids in the geohash cells overlapping the circle; callers apply the exact distance
+    QVector<QString> candidates(double latitude, double longitude, double radiusMeters) const;
+
+    Q_INVOKABLE QVariantMap get(const QString &id) const;
+    Q_INVOKABLE PhotoModel *photos(const QString &id) const;
+    Q_INVOKABLE void setFavorite(const QString &id, bool isFavorite);
+    // A favorite change the user asked for; also emits favoriteToggled
+    Q_INVOKABLE void toggleFavorite(const QString &id);
+
+signals:
+    void countChanged();
+    void restaurantsChanged(const QStringList &ids);
+    void favoriteChanged(const QString &id, bool isFavorite);
+    void favoritesReset();
+    void favoriteToggled(const QString &id, bool isFavorite);
+
+private:
+    // Network rows, plus catalog rows decoded on first lookup
+    mutable QHash<QString, Restaurant> m_restaurants;
+    QSet<QString> m_favorites;
+    // Until the user's list is known, the server's is_favorite flags are used
+    bool m_favoritesKnown;
+    mutable SearchIndex m_searchIndex;
+    GeoHashIndex m_geoIndex;
+    CatalogFile m_catalog;
+    // The catalog joins the text index on the first search, not at startup
+    mutable bool m_catalogIndexed;
+    // Created on first access per restaurant
+    mutable QHash<QString, PhotoModel *> m_photoModels;
+    // How many models and services hold each id
+    QHash<QString, int> m_references;
+    mutable bool m_trimScheduled;
+    // Rows in m_restaurants that the catalog does not have
+    int m_uncatalogued;
+
+    // Returns true when the row made the id a favorite
+    bool store(Restaurant restaurant);
+    void indexCatalog() const;
+    // Evicts on the next event loop pass, never under a caller's find() pointer
+    void scheduleTrim() const;
+    void trim();
+};
+
+#endif // RESTAURANTSTORE_H
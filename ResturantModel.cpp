@@ -1,10 +1,55 @@
 #include "ResturantModel.h"
+#include "RestaurantStore.h"
 #include <QJsonObject>
 #include <QGeoCoordinate>
 
-RestaurantModel::RestaurantModel(QObject *parent)
+Restaurant Restaurant::fromJson(const QJsonObject &obj)
+{
+    Restaurant restaurant;
+    restaurant.id = obj["id"].toString();
+    restaurant.name = obj["name"].toString();
+    restaurant.address = obj["address"].toString();
+    restaurant.phoneNumber = obj["phone_number"].toString();
+    restaurant.website = obj["website"].toString();
+    restaurant.cuisineType = obj["cuisine_type"].toString();
+    restaurant.description = obj["description"].toString();
+    restaurant.latitude = obj["latitude"].toDouble();
+    restaurant.longitude = obj["longitude"].toDouble();
+    restaurant.rating = obj["rating"].toInt();
+    restaurant.isVegan = obj["is_vegan"].toBool();
+    restaurant.isVegetarian = obj["is_vegetarian"].toBool();
+    restaurant.distance = obj["distance"].toDouble(0.0);
+    restaurant.isFavorite = obj["is_favorite"].toBool(false);
+    // The list profile (fields=list) has no photos key at all
+    restaurant.detailed = obj.contains("photos");
+
+    // Parse photos array if exists
+    if (obj.contains("photos") && obj["photos"].isArray()) {
+        QJsonArray photosArray = obj["photos"].toArray();
+        for (const QJsonValue &photoValue : photosArray) {
+            // The API sends photo objects ({"url": ...}); accept plain strings too
+            restaurant.photos.append(photoValue.isObject() ? photoValue.toObject()["url"].toString()
+                                                           : photoValue.toString());
+        }
+    }
+
+    return restaurant;
+}
+
+RestaurantModel::RestaurantModel(RestaurantStore *store, QObject *parent)
     : QAbstractListModel(parent)
+    , m_store(store)
+    , m_followFavorites(false)
 {
+    connect(m_store, &RestaurantStore::restaurantsChanged, this, &RestaurantModel::onRestaurantsChanged);
+    connect(m_store, &RestaurantStore::favoriteChanged, this, &RestaurantModel::onFavoriteChanged);
+    connect(m_store, &RestaurantStore::favoritesReset, this, &RestaurantModel::onFavoritesReset);
+}
+
+RestaurantModel::~RestaurantModel()
+{
+    for (const Row &row : qAsConst(m_rows))
+        m_store->release(row.id);
 }
 
 int RestaurantModel::rowCount(const QModelIndex &parent) const
@@ -12,16 +57,54 @@ int RestaurantModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid())
         return 0;
 
-    return m_restaurants.size();
+    return m_rows.size();
+}
+
+int RestaurantModel::count() const
+{
+    return m_rows.size();
+}
+
+RestaurantStore *RestaurantModel::store() const
+{
+    return m_store;
 }
 
 QVariant RestaurantModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() < 0 || index.row() >= m_restaurants.size())
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
         return QVariant();
 
-    const Restaurant &restaurant = m_restaurants.at(index.row());
+    const Row &row = m_rows.at(index.row());
+    const Restaurant *restaurant = m_store->find(row.id);
+    if (!restaurant)
+        return QVariant();
+
+    return roleData(*restaurant, row, role);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+void RestaurantModel::multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const
+{
+    // Views ask for all their roles at once; validate and look up the row once
+    const Restaurant *restaurant = nullptr;
+    if (index.isValid() && index.row() >= 0 && index.row() < m_rows.size())
+        restaurant = m_store->find(m_rows.at(index.row()).id);
+
+    if (!restaurant) {
+        for (QModelRoleData &roleData : roleDataSpan)
+            roleData.clearData();
+        return;
+    }
+
+    const Row &row = m_rows.at(index.row());
+    for (QModelRoleData &data : roleDataSpan)
+        data.setData(roleData(*restaurant, row, data.role()));
+}
+#endif
 
+QVariant RestaurantModel::roleData(const Restaurant &restaurant, const Row &row, int role) const
+{
     switch (role) {
     case IdRole:
         return restaurant.id;
@@ -48,11 +131,17 @@ QVariant RestaurantModel::data(const QModelIndex &index, int role) const
     case IsVegetarianRole:
         return restaurant.isVegetarian;
     case PhotosRole:
-        return QVariant::fromValue(restaurant.photos);
+        return QVariant::fromValue<QObject *>(m_store->photos(restaurant.id));
     case DistanceRole:
-        return restaurant.distance;
+        return row.distance;
     case IsFavoriteRole:
         return restaurant.isFavorite;
+    case RestaurantRole: {
+        // Distance depends on the result set, not the restaurant
+        Restaurant projected = restaurant;
+        projected.distance = row.distance;
+        return QVariant::fromValue(projected);
+    }
     default:
         return QVariant();
     }
@@ -60,118 +149,194 @@ QVariant RestaurantModel::data(const QModelIndex &index, int role) const
 
 QHash<int, QByteArray> RestaurantModel::roleNames() const
 {
-    QHash<int, QByteArray> roles;
-    roles[IdRole] = "id";
-    roles[NameRole] = "name";
-    roles[AddressRole] = "address";
-    roles[PhoneNumberRole] = "phoneNumber";
-    roles[WebsiteRole] = "website";
-    roles[CuisineTypeRole] = "cuisineType";
-    roles[DescriptionRole] = "description";
-    roles[LatitudeRole] = "latitude";
-    roles[LongitudeRole] = "longitude";
-    roles[RatingRole] = "rating";
-    roles[IsVeganRole] = "isVegan";
-    roles[IsVegetarianRole] = "isVegetarian";
-    roles[PhotosRole] = "photos";
-    roles[DistanceRole] = "distance";
-    roles[IsFavoriteRole] = "isFavorite";
+    // Built once; views call this for every delegate model they create
+    static const QHash<int, QByteArray> roles {
+        { IdRole, "id" },
+        { NameRole, "name" },
+        { AddressRole, "address" },
+        { PhoneNumberRole, "phoneNumber" },
+        { WebsiteRole, "website" },
+        { CuisineTypeRole, "cuisineType" },
+        { DescriptionRole, "description" },
+        { LatitudeRole, "latitude" },
+        { LongitudeRole, "longitude" },
+        { RatingRole, "rating" },
+        { IsVeganRole, "isVegan" },
+        { IsVegetarianRole, "isVegetarian" },
+        { PhotosRole, "photos" },
+        { DistanceRole, "distance" },
+        { IsFavoriteRole, "isFavorite" },
+        { RestaurantRole, "restaurant" }
+    };
     return roles;
 }
 
+PhotoModel *RestaurantModel::photos(int index) const
+{
+    if (index < 0 || index >= m_rows.size())
+        return nullptr;
+
+    return m_store->photos(m_rows.at(index).id);
+}
+
 QVariantMap RestaurantModel::get(int index) const
 {
-    if (index < 0 || index >= m_restaurants.size())
+    if (index < 0 || index >= m_rows.size())
         return QVariantMap();
 
-    const Restaurant &restaurant = m_restaurants.at(index);
-    QVariantMap map;
-
-    map["id"] = restaurant.id;
-    map["name"] = restaurant.name;
-    map["address"] = restaurant.address;
-    map["phoneNumber"] = restaurant.phoneNumber;
-    map["website"] = restaurant.website;
-    map["cuisineType"] = restaurant.cuisineType;
-    map["description"] = restaurant.description;
-    map["latitude"] = restaurant.latitude;
-    map["longitude"] = restaurant.longitude;
-    map["rating"] = restaurant.rating;
-    map["isVegan"] = restaurant.isVegan;
-    map["isVegetarian"] = restaurant.isVegetarian;
-    map["photos"] = QVariant::fromValue(restaurant.photos);
-    map["distance"] = restaurant.distance;
-    map["isFavorite"] = restaurant.isFavorite;
-
+    QVariantMap map = m_store->get(m_rows.at(index).id);
+    if (!map.isEmpty())
+        map["distance"] = m_rows.at(index).distance;
     return map;
 }
 
+QStringList RestaurantModel::ids(int first, int last) const
+{
+    QStringList ids;
+    first = qMax(first, 0);
+    last = qMin(last, m_rows.size() - 1);
+    for (int i = first; i <= last; ++i)
+        ids.append(m_rows.at(i).id);
+    return ids;
+}
+
 void RestaurantModel::toggleFavorite(int index)
 {
-    if (index < 0 || index >= m_restaurants.size())
+    if (index < 0 || index >= m_rows.size())
         return;
 
-    m_restaurants[index].isFavorite = !m_restaurants[index].isFavorite;
-
-    QModelIndex modelIndex = createIndex(index, 0);
-    emit dataChanged(modelIndex, modelIndex, {IsFavoriteRole});
-    emit favoriteToggled(m_restaurants[index].id, m_restaurants[index].isFavorite);
+    // The store notifies every projection, including this one
+    m_store->toggleFavorite(m_rows.at(index).id);
 }
 
 void RestaurantModel::setFavoriteStatus(const QString &id, bool isFavorite)
 {
-    for (int i = 0; i < m_restaurants.size(); ++i) {
-        if (m_restaurants[i].id == id) {
-            m_restaurants[i].isFavorite = isFavorite;
-            QModelIndex modelIndex = createIndex(i, 0);
-            emit dataChanged(modelIndex, modelIndex, {IsFavoriteRole});
-            break;
-        }
-    }
+    m_store->setFavorite(id, isFavorite);
 }
 
-void RestaurantModel::updateFromJson(const QJsonArray &jsonArray)
+void RestaurantModel::setFollowFavorites(bool follow)
+{
+    if (m_followFavorites == follow)
+        return;
+
+    m_followFavorites = follow;
+    if (m_followFavorites)
+        onFavoritesReset();
+}
+
+void RestaurantModel::setRows(const QVector<Row> &rows)
 {
+    const int previousCount = m_rows.size();
+
+    // Retain first, so rows in both sets never drop to zero references
+    for (const Row &row : rows)
+        m_store->retain(row.id);
+    for (const Row &row : qAsConst(m_rows))
+        m_store->release(row.id);
+
     beginResetModel();
+    m_rows = rows;
+    reindex();
+    endResetModel();
+
+    if (m_rows.size() != previousCount)
+        emit countChanged();
+}
+
+void RestaurantModel::updateFromJson(const QJsonArray &jsonArray)
+{
+    const QStringList ids = m_store->ingest(jsonArray);
+
+    QVector<Row> rows;
+    rows.reserve(ids.size());
+    for (const QString &id : ids)
+        rows.append({ id, m_store->find(id)->distance });
+    setRows(rows);
+}
+
+void RestaurantModel::setRestaurants(const QVector<Restaurant> &restaurants)
+{
+    m_store->upsert(restaurants);
+
+    QVector<Row> rows;
+    rows.reserve(restaurants.size());
+    for (const Restaurant &restaurant : restaurants)
+        rows.append({ restaurant.id, restaurant.distance });
+    setRows(rows);
+}
+
+void RestaurantModel::clear()
+{
+    setRows(QVector<Row>());
+}
 
-    m_restaurants.clear();
-
-    for (const QJsonValue &value : jsonArray) {
-        QJsonObject obj = value.toObject();
-
-        Restaurant restaurant;
-        restaurant.id = obj["id"].toString();
-        restaurant.name = obj["name"].toString();
-        restaurant.address = obj["address"].toString();
-        restaurant.phoneNumber = obj["phone_number"].toString();
-        restaurant.website = obj["website"].toString();
-        restaurant.cuisineType = obj["cuisine_type"].toString();
-        restaurant.description = obj["description"].toString();
-        restaurant.latitude = obj["latitude"].toDouble();
-        restaurant.longitude = obj["longitude"].toDouble();
-        restaurant.rating = obj["rating"].toInt();
-        restaurant.isVegan = obj["is_vegan"].toBool();
-        restaurant.isVegetarian = obj["is_vegetarian"].toBool();
-        restaurant.distance = obj["distance"].toDouble(0.0);
-        restaurant.isFavorite = obj["is_favorite"].toBool(false);
-
-        // Parse photos array if exists
-        if (obj.contains("photos") && obj["photos"].isArray()) {
-            QJsonArray photosArray = obj["photos"].toArray();
-            for (const QJsonValue &photoValue : photosArray) {
-                restaurant.photos.append(photoValue.toString());
-            }
+void RestaurantModel::reindex()
+{
+    m_rowById.clear();
+    m_rowById.reserve(m_rows.size());
+    for (int i = 0; i < m_rows.size(); ++i)
+        m_rowById.insert(m_rows.at(i).id, i);
+}
+
+void RestaurantModel::rowChanged(const QString &id, const QVector<int> &roles)
+{
+    const auto it = m_rowById.constFind(id);
+    if (it == m_rowById.constEnd())
+        return;
+
+    const QModelIndex modelIndex = createIndex(it.value(), 0);
+    emit dataChanged(modelIndex, modelIndex, roles);
+}
+
+void RestaurantModel::onRestaurantsChanged(const QStringList &ids)
+{
+    for (const QString &id : ids) {
+        if (m_rowById.contains(id)) {
+            rowChanged(id, QVector<int>());
+        } else if (m_followFavorites && m_store->isFavorite(id)) {
+            // A favorite whose details just arrived
+            onFavoriteChanged(id, true);
         }
+    }
+}
 
-        m_restaurants.append(restaurant);
+void RestaurantModel::onFavoriteChanged(const QString &id, bool isFavorite)
+{
+    if (!m_followFavorites) {
+        rowChanged(id, {IsFavoriteRole, RestaurantRole});
+        return;
     }
 
-    endResetModel();
+    const auto it = m_rowById.constFind(id);
+    if (isFavorite && it == m_rowById.constEnd() && m_store->contains(id)) {
+        m_store->retain(id);
+        beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size());
+        m_rows.append({ id, m_store->find(id)->distance });
+        m_rowById.insert(id, m_rows.size() - 1);
+        endInsertRows();
+        emit countChanged();
+    } else if (!isFavorite && it != m_rowById.constEnd()) {
+        const int row = it.value();
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.remove(row);
+        reindex();
+        endRemoveRows();
+        m_store->release(id);
+        emit countChanged();
+    }
 }
 
-void RestaurantModel::clear()
+void RestaurantModel::onFavoritesReset()
 {
-    beginResetModel();
-    m_restaurants.clear();
-    endResetModel();
+    if (!m_followFavorites)
+        return;
+
+    QVector<Row> rows;
+    const QStringList ids = m_store->favoriteIds();
+    for (const QString &id : ids) {
+        const Restaurant *restaurant = m_store->find(id);
+        if (restaurant)
+            rows.append({ id, restaurant->distance });
+    }
+    setRows(rows);
 }
@@ -4,9 +4,30 @@
 #include <QAbstractListModel>
 #include <QGeoCoordinate>
 #include <QJsonArray>
+#include <QJsonObject>
 #include <QVector>
+#include "PhotoModel.h"
 
+// Row type handed to delegates as a single value; QStrings inside are shared,
+// so copying a row costs a few reference count bumps
 class Restaurant {
+    Q_GADGET
+    Q_PROPERTY(QString id MEMBER id)
+    Q_PROPERTY(QString name MEMBER name)
+    Q_PROPERTY(QString address MEMBER address)
+    Q_PROPERTY(QString phoneNumber MEMBER phoneNumber)
+    Q_PROPERTY(QString website MEMBER website)
+    Q_PROPERTY(QString cuisineType MEMBER cuisineType)
+    Q_PROPERTY(QString description MEMBER description)
+    Q_PROPERTY(double latitude MEMBER latitude)
+    Q_PROPERTY(double longitude MEMBER longitude)
+    Q_PROPERTY(int rating MEMBER rating)
+    Q_PROPERTY(bool isVegan MEMBER isVegan)
+    Q_PROPERTY(bool isVegetarian MEMBER isVegetarian)
+    Q_PROPERTY(double distance MEMBER distance)
+    Q_PROPERTY(bool isFavorite MEMBER isFavorite)
+    Q_PROPERTY(bool detailed MEMBER detailed)
+
 public:
     QString id;
     QString name;
@@ -23,11 +44,22 @@ public:
     QStringList photos;
     double distance;
     bool isFavorite;
+    // Description, contact details and photos are known; list rows leave them out
+    bool detailed;
+
+    static Restaurant fromJson(const QJsonObject &obj);
 };
 
+Q_DECLARE_METATYPE(Restaurant)
+
+class RestaurantStore;
+
+// A projection over the shared RestaurantStore: rows are ids plus the
+// distance for this result set, everything else is read from the store
 class RestaurantModel : public QAbstractListModel
 {
     Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
 
 public:
     enum RestaurantRoles {
@@ -45,29 +77,64 @@ public:
         IsVegetarianRole,
         PhotosRole,
         DistanceRole,
-        IsFavoriteRole
+        IsFavoriteRole,
+        // Whole row as a Restaurant gadget: one lookup per delegate
+        RestaurantRole
+    };
+
+    struct Row {
+        QString id;
+        double distance;
     };
 
-    explicit RestaurantModel(QObject *parent = nullptr);
+    explicit RestaurantModel(RestaurantStore *store, QObject *parent = nullptr);
+    ~RestaurantModel() override;
 
     // QAbstractItemModel implementation
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    void multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const override;
+#endif
+
+    int count() const;
+    RestaurantStore *store() const;
+
+    // Keep the rows equal to the store's favorites instead of a result set
+    void setFollowFavorites(bool follow);
 
     // Custom methods
     Q_INVOKABLE QVariantMap get(int index) const;
+    // Ids of rows first..last, e.g. the ones a view shows
+    Q_INVOKABLE QStringList ids(int first, int last) const;
     Q_INVOKABLE void toggleFavorite(int index);
     Q_INVOKABLE void setFavoriteStatus(const QString &id, bool isFavorite);
+    Q_INVOKABLE PhotoModel *photos(int index) const;
 
+    void setRows(const QVector<Row> &rows);
+    // Merges the rows into the store, then shows them in order
     void updateFromJson(const QJsonArray &jsonArray);
+    void setRestaurants(const QVector<Restaurant> &restaurants);
     void clear();
 
 signals:
-    void favoriteToggled(const QString &id, bool isFavorite);
+    void countChanged();
+
+private slots:
+    void onRestaurantsChanged(const QStringList &ids);
+    void onFavoriteChanged(const QString &id, bool isFavorite);
+    void onFavoritesReset();
 
 private:
-    QVector<Restaurant> m_restaurants;
+    RestaurantStore *m_store;
+    QVector<Row> m_rows;
+    QHash<QString, int> m_rowById;
+    bool m_followFavorites;
+
+    QVariant roleData(const Restaurant &restaurant, const Row &row, int role) const;
+    void rowChanged(const QString &id, const QVector<int> &roles);
+    void reindex();
 };
 
 #endif // RESTAURANTMODEL_H
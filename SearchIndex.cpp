@@ -0,0 +1,315 @@
+#include "SearchIndex.h"
+#include <QSet>
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+const double kNameTokenScore = 2.0;
+const double kDescriptionTokenScore = 1.0;
+const double kNamePrefixBonus = 1.0;
+const double kMinTrigramSimilarity = 0.5;
+// Postings kept per trie node, for names and for descriptions
+const int kMaxNodePostings = 512;
+}
+
+SearchIndex::SearchIndex()
+    : m_removedCount(0)
+{
+    clear();
+}
+
+void SearchIndex::clear()
+{
+    m_nodes.clear();
+    m_nodes.append(TrieNode());
+    m_trigrams.clear();
+    m_ids.clear();
+    m_foldedNames.clear();
+    m_foldedDescriptions.clear();
+    m_removed.clear();
+    m_documentById.clear();
+    m_removedCount = 0;
+}
+
+void SearchIndex::insert(const QString &id, const QString &name, const QString &description)
+{
+    // Postings are append-only; an update retires the old document
+    remove(id);
+
+    const int document = m_ids.size();
+    const QString foldedName = fold(name);
+    const QString foldedDescription = fold(description);
+
+    m_ids.append(id);
+    m_foldedNames.append(foldedName);
+    m_foldedDescriptions.append(foldedDescription);
+    m_removed.append(false);
+    m_documentById.insert(id, document);
+
+    const QStringList nameTokens = foldedName.split(' ', Qt::SkipEmptyParts);
+    for (const QString &token : nameTokens) {
+        insertToken(token, document, true);
+    }
+    const QStringList descriptionTokens = foldedDescription.split(' ', Qt::SkipEmptyParts);
+    for (const QString &token : descriptionTokens) {
+        insertToken(token, document, false);
+    }
+
+    insertTrigrams(foldedName + ' ' + foldedDescription, document);
+}
+
+void SearchIndex::remove(const QString &id)
+{
+    auto it = m_documentById.find(id);
+    if (it == m_documentById.end()) {
+        return;
+    }
+    m_removed[it.value()] = true;
+    m_documentById.erase(it);
+    m_removedCount++;
+
+    if (m_removedCount > 64 && m_removedCount > m_ids.size() / 2) {
+        compact();
+    }
+}
+
+bool SearchIndex::contains(const QString &id) const
+{
+    return m_documentById.contains(id);
+}
+
+int SearchIndex::size() const
+{
+    return m_documentById.size();
+}
+
+QVector<SearchIndex::Match> SearchIndex::search(const QString &query, int limit) const
+{
+    const QString folded = fold(query);
+    const QStringList tokens = folded.split(' ', Qt::SkipEmptyParts);
+    if (tokens.isEmpty()) {
+        return {};
+    }
+
+    // Every query token must start a word in the name or description
+    QVector<int> nodes;
+    for (const QString &token : tokens) {
+        nodes.append(findNode(token));
+    }
+
+    QHash<int, double> scores;
+    if (!nodes.contains(-1)) {
+        // Start from the most selective token; a complete posting list beats a truncated one
+        int seed = 0;
+        auto selectivity = [this](int node) {
+            const TrieNode &entry = m_nodes.at(node);
+            return qMakePair(entry.truncated, entry.names.size() + entry.descriptions.size());
+        };
+        for (int i = 1; i < nodes.size(); ++i) {
+            if (selectivity(nodes.at(i)) < selectivity(nodes.at(seed))) {
+                seed = i;
+            }
+        }
+        collectPostings(nodes.at(seed), scores);
+
+        // The other tokens are checked against the candidates' text, never by walking their postings
+        for (int i = 0; i < tokens.size(); ++i) {
+            if (i == seed) {
+                continue;
+            }
+            for (auto it = scores.begin(); it != scores.end();) {
+                const double score = tokenScore(it.key(), tokens.at(i));
+                if (score == 0.0) {
+                    it = scores.erase(it);
+                } else {
+                    it.value() += score;
+                    ++it;
+                }
+            }
+        }
+    }
+
+    // Infix matches and typos, ranked below clean prefix hits
+    if (scores.size() < limit && folded.size() >= 3) {
+        const QVector<quint64> queryTrigrams = trigrams(folded);
+        QHash<int, int> shared;
+        for (quint64 trigram : queryTrigrams) {
+            auto postings = m_trigrams.constFind(trigram);
+            if (postings == m_trigrams.constEnd()) {
+                continue;
+            }
+            for (int document : postings.value()) {
+                shared[document]++;
+            }
+        }
+        for (auto it = shared.constBegin(); it != shared.constEnd(); ++it) {
+            const double similarity = double(it.value()) / queryTrigrams.size();
+            if (similarity >= kMinTrigramSimilarity && !scores.contains(it.key())) {
+                scores.insert(it.key(), similarity);
+            }
+        }
+    }
+
+    QVector<Match> matches;
+    matches.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        if (m_removed.at(it.key())) {
+            continue;
+        }
+        double score = it.value();
+        if (m_foldedNames.at(it.key()).startsWith(folded)) {
+            score += kNamePrefixBonus;
+        }
+        matches.append({m_ids.at(it.key()), score});
+    }
+
+    const int count = qMin(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), [](const Match &a, const Match &b) {
+        return a.score > b.score;
+    });
+    matches.resize(count);
+    return matches;
+}
+
+QString SearchIndex::fold(const QString &text)
+{
+    // NFKD splits "é" into "e" + combining accent, which we then drop
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString folded;
+    folded.reserve(decomposed.size());
+    bool pendingSpace = false;
+    for (const QChar c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing) {
+            continue;
+        }
+        if (c.isLetterOrNumber()) {
+            if (pendingSpace && !folded.isEmpty()) {
+                folded.append(' ');
+            }
+            pendingSpace = false;
+            folded.append(c.toCaseFolded());
+        } else {
+            pendingSpace = true;
+        }
+    }
+    return folded;
+}
+
+void SearchIndex::insertToken(const QString &token, int document, bool name)
+{
+    int node = 0;
+    for (const QChar c : token) {
+        auto child = m_nodes[node].children.constFind(c);
+        if (child == m_nodes[node].children.constEnd()) {
+            m_nodes.append(TrieNode());
+            const int created = m_nodes.size() - 1;
+            m_nodes[node].children.insert(c, created);
+            node = created;
+        } else {
+            node = child.value();
+        }
+
+        // Postings live on every node of the path so a prefix lookup is one walk
+        TrieNode &entry = m_nodes[node];
+        if (entry.lastDocument == document && entry.lastWasName == name) {
+            continue;
+        }
+        entry.lastDocument = document;
+        entry.lastWasName = name;
+        QVector<int> &postings = name ? entry.names : entry.descriptions;
+        if (postings.size() < kMaxNodePostings) {
+            postings.append(document);
+        } else {
+            entry.truncated = true;
+        }
+    }
+}
+
+void SearchIndex::insertTrigrams(const QString &text, int document)
+{
+    const QVector<quint64> keys = trigrams(text);
+    for (quint64 key : keys) {
+        QVector<int> &postings = m_trigrams[key];
+        if (postings.isEmpty() || postings.last() != document) {
+            postings.append(document);
+        }
+    }
+}
+
+int SearchIndex::findNode(const QString &prefix) const
+{
+    int node = 0;
+    for (const QChar c : prefix) {
+        auto child = m_nodes.at(node).children.constFind(c);
+        if (child == m_nodes.at(node).children.constEnd()) {
+            return -1;
+        }
+        node = child.value();
+    }
+    return node;
+}
+
+void SearchIndex::collectPostings(int node, QHash<int, double> &scores) const
+{
+    const TrieNode &entry = m_nodes.at(node);
+    for (int document : entry.names) {
+        scores.insert(document, kNameTokenScore);
+    }
+    for (int document : entry.descriptions) {
+        if (!scores.contains(document)) {
+            scores.insert(document, kDescriptionTokenScore);
+        }
+    }
+}
+
+double SearchIndex::tokenScore(int document, const QString &token) const
+{
+    // Folded text is single-space separated, so a word start follows a space or opens the text
+    auto startsWord = [&token](const QString &text) {
+        for (int from = 0; (from = text.indexOf(token, from)) >= 0; ++from) {
+            if (from == 0 || text.at(from - 1) == ' ') {
+                return true;
+            }
+        }
+        return false;
+    };
+    if (startsWord(m_foldedNames.at(document))) {
+        return kNameTokenScore;
+    }
+    if (startsWord(m_foldedDescriptions.at(document))) {
+        return kDescriptionTokenScore;
+    }
+    return 0.0;
+}
+
+void SearchIndex::compact()
+{
+    // Rebuilding is cheaper than teaching every posting list about deletions.
+    // Folding is idempotent, so the folded text can be indexed again as is.
+    const QVector<QString> ids = m_ids;
+    const QVector<QString> names = m_foldedNames;
+    const QVector<QString> descriptions = m_foldedDescriptions;
+    const QVector<bool> removed = m_removed;
+
+    clear();
+    for (int document = 0; document < ids.size(); ++document) {
+        if (!removed.at(document)) {
+            insert(ids.at(document), names.at(document), descriptions.at(document));
+        }
+    }
+}
+
+QVector<quint64> SearchIndex::trigrams(const QString &text)
+{
+    // Pad so that word starts get their own trigrams ("  p", " pl", ...)
+    const QString padded = "  " + text + ' ';
+    QSet<quint64> unique;
+    for (int i = 0; i + 2 < padded.size(); ++i) {
+        const quint64 key = (quint64(padded.at(i).unicode()) << 32)
+                | (quint64(padded.at(i + 1).unicode()) << 16)
+                | quint64(padded.at(i + 2).unicode());
+        unique.insert(key);
+    }
+    return QVector<quint64>(unique.begin(), unique.end());
+}
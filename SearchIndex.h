@@ -0,0 +1,66 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QChar>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Client-side text index over restaurant names and descriptions for typeahead.
+// A prefix trie answers "starts a word with" queries, a trigram index catches
+// infix matches and small typos. All text is case- and accent-folded.
+class SearchIndex
+{
+public:
+    struct Match {
+        QString id;
+        double score;
+    };
+
+    SearchIndex();
+
+    void clear();
+    void insert(const QString &id, const QString &name, const QString &description);
+    void remove(const QString &id);
+    bool contains(const QString &id) const;
+    int size() const;
+
+    // Best matches first
+    QVector<Match> search(const QString &query, int limit) const;
+
+    static QString fold(const QString &text);
+
+private:
+    // Postings are capped, so a short prefix costs the same as a long one.
+    // Name postings score higher and are kept apart, which makes the kept
+    // postings the best ones for the prefix.
+    struct TrieNode {
+        TrieNode() : lastDocument(-1), lastWasName(false), truncated(false) {}
+        QHash<QChar, int> children;
+        QVector<int> names;
+        QVector<int> descriptions;
+        int lastDocument;
+        bool lastWasName;
+        // More documents matched than were kept
+        bool truncated;
+    };
+
+    QVector<TrieNode> m_nodes;
+    QHash<quint64, QVector<int>> m_trigrams;
+    QVector<QString> m_ids;
+    QVector<QString> m_foldedNames;
+    QVector<QString> m_foldedDescriptions;
+    QVector<bool> m_removed;
+    QHash<QString, int> m_documentById;
+    int m_removedCount;
+
+    void insertToken(const QString &token, int document, bool name);
+    void insertTrigrams(const QString &text, int document);
+    int findNode(const QString &prefix) const;
+    void collectPostings(int node, QHash<int, double> &scores) const;
+    double tokenScore(int document, const QString &token) const;
+    void compact();
+    static QVector<quint64> trigrams(const QString &text);
+};
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,94 @@
+#include "StartupOrchestrator.h"
+#include "ApiBatch.h"
+#include "AppController.h"
+#include "UserController.h"
+#include "StartupTimeline.h"
+#include "TokenManager.h"
+
+namespace {
+// Three reads in one; allow for the slowest of them
+const int kBatchTimeoutMs = 20000;
+}
+
+StartupOrchestrator::StartupOrchestrator(NetworkService *network, TokenManager *tokens, AppController *appController,
+                                         UserController *userController, StartupTimeline *timeline,
+                                         QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_tokens(tokens)
+    , m_appController(appController)
+    , m_userController(userController)
+    , m_timeline(timeline)
+    , m_started(false)
+    , m_finished(false)
+{
+}
+
+bool StartupOrchestrator::isFinished() const
+{
+    return m_finished;
+}
+
+void StartupOrchestrator::start()
+{
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+
+    // Warm-up and the position source; the last known position is available right after
+    m_appController->startDeferred();
+    m_userController->startDeferred();
+
+    runBatch();
+    if (m_timeline) {
+        m_timeline->mark("startup requests");
+    }
+}
+
+void StartupOrchestrator::refresh()
+{
+    runBatch();
+}
+
+AsyncFlow StartupOrchestrator::runBatch()
+{
+    // A token close to expiry is renewed first, so the batch goes out with the new one
+    co_await m_tokens->ready(this);
+
+    // Each controller adds what it needs: nothing without a token or a position,
+    // and nearby is left out when a fresh cached copy already answered it
+    ApiBatch batch;
+    m_userController->appendBatch(batch);
+    m_appController->appendBatch(batch);
+
+    if (!batch.isEmpty()) {
+        m_batchRequest.cancel();
+        AsyncReply request = AsyncReply::post(m_network, m_userController->batchRequest(), batch.body(),
+                                              NetworkService::Normal, this, kBatchTimeoutMs);
+        m_batchRequest = request;
+
+        const NetworkResponse response = co_await request;
+        if (response.cancelled) {
+            co_return;
+        }
+
+        const ApiBatch::Responses responses = batch.split(response);
+        m_userController->applyBatch(responses);
+        m_appController->applyBatch(responses);
+    }
+    finish();
+}
+
+void StartupOrchestrator::finish()
+{
+    if (m_finished || !m_started) {
+        return;
+    }
+
+    m_finished = true;
+    if (m_timeline) {
+        m_timeline->mark("first screen");
+    }
+    emit finishedChanged();
+}
@@ -0,0 +1,52 @@
+#ifndef STARTUPORCHESTRATOR_H
+#define STARTUPORCHESTRATOR_H
+
+#include <QObject>
+#include "AsyncReply.h"
+
+class AppController;
+class UserController;
+class StartupTimeline;
+class TokenManager;
+
+// Runs the post-first-frame startup and the full refresh. Profile, favorites
+// and nearby go out as one batch request instead of three, so the first
+// screen is complete after a single round trip; each controller then applies
+// its part as if it had made the request itself. Both lists land in the
+// shared RestaurantStore, which applies the favorite set to the nearby rows.
+class StartupOrchestrator : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool finished READ isFinished NOTIFY finishedChanged)
+
+public:
+    StartupOrchestrator(NetworkService *network, TokenManager *tokens, AppController *appController,
+                        UserController *userController, StartupTimeline *timeline, QObject *parent = nullptr);
+
+    bool isFinished() const;
+
+public slots:
+    void start();
+    // Nearby, favorites and profile again, in one request
+    void refresh();
+
+signals:
+    // Every startup request has answered (or failed)
+    void finishedChanged();
+
+private:
+    NetworkService *m_network;
+    TokenManager *m_tokens;
+    AppController *m_appController;
+    UserController *m_userController;
+    StartupTimeline *m_timeline;
+    bool m_started;
+    bool m_finished;
+    // A newer batch supersedes the one in flight
+    AsyncReply m_batchRequest;
+
+    AsyncFlow runBatch();
+    void finish();
+};
+
+#endif // STARTUPORCHESTRATOR_H
@@ -0,0 +1,63 @@
+#include "StartupTimeline.h"
+#include <QQuickWindow>
+#include <QStringList>
+#include <QDebug>
+
+StartupTimeline::StartupTimeline(QObject *parent)
+    : QObject(parent)
+    , m_firstFrame(-1)
+    , m_verbose(false)
+{
+    m_timer.start();
+}
+
+void StartupTimeline::mark(const QString &name)
+{
+    m_milestones.append({name, m_timer.elapsed()});
+    if (m_verbose) {
+        qInfo().noquote() << QString("startup: %1 at %2 ms").arg(name).arg(m_milestones.last().elapsed);
+    }
+}
+
+void StartupTimeline::watchFirstFrame(QQuickWindow *window)
+{
+    if (!window || m_firstFrame >= 0) {
+        return;
+    }
+    m_window = window;
+    // Emitted on the render thread with the threaded loop; queued back to us
+    connect(window, &QQuickWindow::frameSwapped, this, &StartupTimeline::onFrameSwapped, Qt::QueuedConnection);
+}
+
+void StartupTimeline::setVerbose(bool verbose)
+{
+    m_verbose = verbose;
+}
+
+qint64 StartupTimeline::timeToFirstFrame() const
+{
+    return m_firstFrame;
+}
+
+QString StartupTimeline::report() const
+{
+    QStringList parts;
+    for (const Milestone &milestone : m_milestones) {
+        parts.append(QString("%1 %2 ms").arg(milestone.name).arg(milestone.elapsed));
+    }
+    return parts.join(", ");
+}
+
+void StartupTimeline::onFrameSwapped()
+{
+    if (m_firstFrame >= 0) {
+        return;
+    }
+
+    m_firstFrame = m_timer.elapsed();
+    if (m_window) {
+        disconnect(m_window, &QQuickWindow::frameSwapped, this, &StartupTimeline::onFrameSwapped);
+    }
+    mark("first frame");
+    emit firstFrameSwapped();
+}
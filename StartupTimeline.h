@@ -0,0 +1,48 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+
+class QQuickWindow;
+
+// Records named startup milestones relative to process start and the time to
+// the first presented frame. Printed when the app runs with --startup-timeline.
+class StartupTimeline : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(qint64 timeToFirstFrame READ timeToFirstFrame NOTIFY firstFrameSwapped)
+
+public:
+    explicit StartupTimeline(QObject *parent = nullptr);
+
+    void mark(const QString &name);
+    void watchFirstFrame(QQuickWindow *window);
+    void setVerbose(bool verbose);
+
+    // Milliseconds, or -1 until the first frame is on screen
+    qint64 timeToFirstFrame() const;
+    Q_INVOKABLE QString report() const;
+
+signals:
+    void firstFrameSwapped();
+
+private slots:
+    void onFrameSwapped();
+
+private:
+    struct Milestone {
+        QString name;
+        qint64 elapsed;
+    };
+
+    QElapsedTimer m_timer;
+    QVector<Milestone> m_milestones;
+    QPointer<QQuickWindow> m_window;
+    qint64 m_firstFrame;
+    bool m_verbose;
+};
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,292 @@
+#include "TokenManager.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QStringList>
+#include <climits>
+#include <utility>
+
+namespace {
+// Renew this long before the token runs out
+const qint64 kRefreshMarginSecs = 5 * 60;
+// After a renewal that failed without ending the session (offline, server down)
+const int kRetryDelayMs = 60 * 1000;
+const int kRefreshTimeoutMs = 15000;
+
+const char *const kTokenKey = "auth/token";
+// Where AppController and UserController each kept a copy before
+const char *const kLegacyKeys[] = { "user/authToken", "authToken" };
+
+qint64 expiresAt(const QString &token)
+{
+    const QDateTime expiry = TokenManager::expiryOf(token);
+    return expiry.isValid() ? expiry.toSecsSinceEpoch() : 0;
+}
+}
+
+TokenManager::Ready::Ready(TokenManager *manager, QObject *context, const QString &rejected)
+    : m_manager(manager)
+    , m_context(context)
+    , m_rejected(rejected)
+{
+}
+
+bool TokenManager::Ready::await_ready() const noexcept
+{
+    return !m_manager || !m_manager->m_refreshing;
+}
+
+void TokenManager::Ready::await_suspend(std::coroutine_handle<> handle)
+{
+    m_manager->m_waiters.append({ m_context, handle });
+}
+
+bool TokenManager::Ready::await_resume() const
+{
+    return m_manager && m_manager->isValid() && m_manager->m_token != m_rejected;
+}
+
+TokenManager::TokenManager(NetworkService *network, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_authUrl("http://localhost:8085/auth")
+    , m_refreshTimer(new QTimer(this))
+    , m_refreshing(false)
+{
+    m_refreshTimer->setSingleShot(true);
+    connect(m_refreshTimer, &QTimer::timeout, this, &TokenManager::refresh);
+    load();
+}
+
+TokenManager::~TokenManager()
+{
+    // Flows still waiting for a renewal end here, like flows whose reply outlives them
+    const QList<Waiter> waiters = std::exchange(m_waiters, QList<Waiter>());
+    for (const Waiter &waiter : waiters) {
+        waiter.handle.destroy();
+    }
+}
+
+QString TokenManager::token() const
+{
+    return m_token;
+}
+
+QDateTime TokenManager::expiry() const
+{
+    return m_expiry;
+}
+
+bool TokenManager::isValid() const
+{
+    // A token without an exp claim never expires
+    return !m_token.isEmpty() && (!m_expiry.isValid() || m_expiry > QDateTime::currentDateTimeUtc());
+}
+
+bool TokenManager::isRefreshing() const
+{
+    return m_refreshing;
+}
+
+void TokenManager::setToken(const QString &token)
+{
+    // A fresh login supersedes a renewal still in flight
+    m_refreshRequest.cancel();
+    m_refreshing = false;
+
+    m_token = token;
+    m_expiry = expiryOf(token);
+    save();
+    scheduleRefresh();
+    resumeWaiters();
+    emit tokenChanged();
+}
+
+void TokenManager::setAuthUrl(const QString &url)
+{
+    m_authUrl = url;
+}
+
+void TokenManager::clear()
+{
+    m_refreshRequest.cancel();
+    m_refreshing = false;
+    m_refreshTimer->stop();
+
+    m_token.clear();
+    m_expiry = QDateTime();
+    save();
+    resumeWaiters();
+    emit tokenChanged();
+}
+
+void TokenManager::authorize(QNetworkRequest &request) const
+{
+    if (!m_token.isEmpty()) {
+        request.setRawHeader("Authorization", QString("Bearer %1").arg(m_token).toUtf8());
+    }
+}
+
+TokenManager::Ready TokenManager::ready(QObject *context)
+{
+    // The timer may have slept through the refresh point with the device
+    if (!m_refreshing && needsRefresh()) {
+        refresh();
+    }
+    return Ready(this, context, QString());
+}
+
+void TokenManager::reportRejected(const QString &token)
+{
+    // Later 401s for the same token join the renewal; ones for an older token just retry
+    if (!token.isEmpty() && token == m_token && !m_refreshing) {
+        refresh();
+    }
+}
+
+TokenManager::Ready TokenManager::renew(QObject *context, const QString &rejected)
+{
+    reportRejected(rejected);
+    return Ready(this, context, rejected);
+}
+
+QDateTime TokenManager::expiryOf(const QString &token)
+{
+    const QStringList parts = token.split('.');
+    if (parts.size() != 3) {
+        return QDateTime();
+    }
+
+    // Only the claims are read; the signature is the server's business
+    const QByteArray payload = QByteArray::fromBase64(parts.at(1).toLatin1(),
+                                                      QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    const QJsonValue exp = QJsonDocument::fromJson(payload).object()["exp"];
+    if (!exp.isDouble()) {
+        return QDateTime();
+    }
+    return QDateTime::fromSecsSinceEpoch(qint64(exp.toDouble()), Qt::UTC);
+}
+
+void TokenManager::refresh()
+{
+    if (m_refreshing || m_token.isEmpty()) {
+        return;
+    }
+
+    // The auth service only renews tokens that are still valid
+    if (!isValid()) {
+        expire();
+        return;
+    }
+    runRefresh();
+}
+
+AsyncFlow TokenManager::runRefresh()
+{
+    m_refreshing = true;
+    m_refreshTimer->stop();
+
+    QNetworkRequest request(QUrl(m_authUrl + "/refresh"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    authorize(request);
+    AsyncReply renewal = AsyncReply::post(m_network, request, QByteArray(), NetworkService::Interactive,
+                                          this, kRefreshTimeoutMs);
+    m_refreshRequest = renewal;
+
+    const NetworkResponse response = co_await renewal;
+    if (response.cancelled) {
+        // setToken() or clear() took over and resumed the waiters
+        co_return;
+    }
+    m_refreshing = false;
+
+    const QString token = response.json().object()["access_token"].toString();
+    if (response.ok() && !token.isEmpty()) {
+        m_token = token;
+        m_expiry = expiryOf(token);
+        save();
+        scheduleRefresh();
+        resumeWaiters();
+        emit tokenChanged();
+        co_return;
+    }
+
+    if (response.error == QNetworkReply::AuthenticationRequiredError || !isValid()) {
+        expire();
+        co_return;
+    }
+
+    // Offline or the auth service is down: keep using the token while it lasts
+    m_refreshTimer->start(kRetryDelayMs);
+    resumeWaiters();
+}
+
+void TokenManager::load()
+{
+    QSettings settings;
+    QString token = settings.value(kTokenKey).toString();
+
+    // One-time migration from the per-controller keys: keep the copy that lasts longest
+    for (const char *key : kLegacyKeys) {
+        const QString candidate = settings.value(key).toString();
+        if (token.isEmpty() || (!candidate.isEmpty() && expiresAt(candidate) > expiresAt(token))) {
+            token = candidate;
+        }
+        settings.remove(key);
+    }
+
+    m_token = token;
+    m_expiry = expiryOf(token);
+    if (!isValid()) {
+        // Expired while the app was closed: nothing left to renew
+        m_token.clear();
+        m_expiry = QDateTime();
+    }
+    save();
+    scheduleRefresh();
+}
+
+void TokenManager::save()
+{
+    QSettings settings;
+    if (m_token.isEmpty()) {
+        settings.remove(kTokenKey);
+    } else {
+        settings.setValue(kTokenKey, m_token);
+    }
+}
+
+void TokenManager::scheduleRefresh()
+{
+    m_refreshTimer->stop();
+    if (m_token.isEmpty() || !m_expiry.isValid()) {
+        return;
+    }
+
+    const qint64 delay = QDateTime::currentDateTimeUtc().msecsTo(m_expiry) - kRefreshMarginSecs * 1000;
+    m_refreshTimer->start(int(qBound<qint64>(0, delay, INT_MAX)));
+}
+
+bool TokenManager::needsRefresh() const
+{
+    return !m_token.isEmpty() && m_expiry.isValid()
+        && QDateTime::currentDateTimeUtc().secsTo(m_expiry) <= kRefreshMarginSecs;
+}
+
+void TokenManager::expire()
+{
+    clear();
+    emit sessionExpired();
+}
+
+void TokenManager::resumeWaiters()
+{
+    const QList<Waiter> waiters = std::exchange(m_waiters, QList<Waiter>());
+    for (const Waiter &waiter : waiters) {
+        if (waiter.context) {
+            waiter.handle.resume();
+        } else {
+            waiter.handle.destroy();
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef TOKENMANAGER_H
+#define TOKENMANAGER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <coroutine>
+#include "AsyncReply.h"
+#include "NetworkService.h"
+
+// The one bearer token of the session, shared by every controller and the
+// action queue. The expiry is read from the JWT itself, so the token is
+// renewed through the auth service shortly before it runs out rather than
+// discovered to be stale by a failing request.
+//
+// While a renewal is in flight, flows co_await ready() before sending and go
+// out with the new token. A 401 triggers at most one renewal however many
+// requests were turned away at once; only when that fails is the session
+// over (sessionExpired).
+class TokenManager : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool valid READ isValid NOTIFY tokenChanged)
+
+public:
+    // Awaitable: resumes once no renewal is in flight, with whether a usable token is there
+    class Ready
+    {
+    public:
+        Ready(TokenManager *manager, QObject *context, const QString &rejected);
+
+        bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> handle);
+        bool await_resume() const;
+
+    private:
+        QPointer<TokenManager> m_manager;
+        QPointer<QObject> m_context;
+        QString m_rejected;
+    };
+
+    explicit TokenManager(NetworkService *network, QObject *parent = nullptr);
+    ~TokenManager();
+
+    QString token() const;
+    QDateTime expiry() const;
+    // Present and not expired
+    bool isValid() const;
+    bool isRefreshing() const;
+
+    // Auth service the refresh call goes to
+    void setAuthUrl(const QString &url);
+
+    // A token from login; persisted and renewed from now on
+    void setToken(const QString &token);
+    void clear();
+    void authorize(QNetworkRequest &request) const;
+
+    // A request sent with this token got a 401: renew once, shared by every caller
+    void reportRejected(const QString &token);
+
+    // Renews first when the token is about to run out
+    Ready ready(QObject *context);
+    // reportRejected(), then resumes with true when a different, valid token is there to retry with
+    Ready renew(QObject *context, const QString &rejected);
+
+    // Expiry from the JWT's exp claim; invalid if the token has none
+    static QDateTime expiryOf(const QString &token);
+
+signals:
+    void tokenChanged();
+    // The session could not be renewed; the user has to log in again
+    void sessionExpired();
+
+private slots:
+    void refresh();
+
+private:
+    struct Waiter {
+        QPointer<QObject> context;
+        std::coroutine_handle<> handle;
+    };
+
+    NetworkService *m_network;
+    QString m_authUrl;
+    QString m_token;
+    QDateTime m_expiry;
+    QTimer *m_refreshTimer;
+    AsyncReply m_refreshRequest;
+    bool m_refreshing;
+    QList<Waiter> m_waiters;
+
+    void load();
+    void save();
+    void scheduleRefresh();
+    bool needsRefresh() const;
+    void expire();
+    void resumeWaiters();
+    AsyncFlow runRefresh();
+};
+
+#endif // TOKENMANAGER_H
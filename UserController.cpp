@@ -5,14 +5,31 @@
 #include <QSettings>
 #include <QUrlQuery>
 
-UserController::UserController(QObject *parent)
+namespace {
+// The user is waiting on these
+const int kInteractiveTimeoutMs = 15000;
+// Refreshes may sit behind other traffic in the scheduler
+const int kBackgroundTimeoutMs = 30000;
+}
+
+UserController::UserController(NetworkService *network, RestaurantStore *store, TokenManager *tokens, QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_network(network)
+    , m_store(store)
+    , m_tokens(tokens)
+    , m_actionQueue(new ActionQueue(network, "favorites", this))
+    , m_offlineCache("user")
     , m_loading(false)
     , m_authUrl("http://localhost:8085/auth")
     , m_apiUrl("http://localhost:8000/api")
+    , m_batchProfile(false)
+    , m_batchFavorites(false)
+    , m_loggedIn(false)
 {
-    connect(m_networkManager, &QNetworkAccessManager::finished, this, &UserController::handleNetworkReply);
+    connect(m_tokens, &TokenManager::tokenChanged, this, &UserController::onTokenChanged);
+    connect(m_tokens, &TokenManager::sessionExpired, this, &UserController::onSessionExpired);
+    connect(m_actionQueue, &ActionQueue::actionRejected, this, &UserController::onActionRejected);
+    connect(m_actionQueue, &ActionQueue::authenticationRequired, m_tokens, &TokenManager::reportRejected);
     loadStoredCredentials();
 }
 
@@ -22,7 +39,7 @@ UserController::~UserController()
 
 bool UserController::isLoggedIn() const
 {
-    return !m_authToken.isEmpty();
+    return !m_tokens->token().isEmpty();
 }
 
 QString UserController::username() const
@@ -49,18 +66,42 @@ void UserController::login(const QString &username, const QString &password)
 
     setLoading(true);
     clearError();
+    runLogin(username, password);
+}
 
-    QUrl url(m_authUrl + "/login");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
+AsyncFlow UserController::runLogin(QString username, QString password)
+{
     QJsonObject jsonObject;
     jsonObject["username"] = username;
     jsonObject["password"] = password;
 
-    QJsonDocument doc(jsonObject);
+    // A second attempt supersedes the first
+    m_authRequest.cancel();
+    AsyncReply login = AsyncReply::post(m_network, createRequest(QUrl(m_authUrl + "/login")),
+                                        QJsonDocument(jsonObject).toJson(), NetworkService::Interactive,
+                                        this, kInteractiveTimeoutMs);
+    m_authRequest = login;
+
+    const NetworkResponse response = co_await login;
+    // Superseded by a newer attempt, which owns the spinner, or logged out, which clears it
+    if (response.cancelled) {
+        co_return;
+    }
+    setLoading(false);
+
+    const QJsonObject json = response.json().object();
+    if (!response.ok() || !json.contains("access_token")) {
+        setErrorMessage(authError(response, json));
+        co_return;
+    }
 
-    m_networkManager->post(request, doc.toJson());
+    // The login answer already carries the profile; only favorites are left to fetch
+    setUsername(json["username"].toString());
+    saveCredentials();
+    m_tokens->setToken(json["access_token"].toString());
+
+    AsyncReply favorites = requestFavorites();
+    applyFavoritesResponse(co_await favorites);
 }
 
 void UserController::register_(const QString &username, const QString &email, const QString &password)
@@ -72,25 +113,48 @@ void UserController::register_(const QString &username, const QString &email, co
 
     setLoading(true);
     clearError();
+    runRegister(username, email, password);
+}
 
-    QUrl url(m_authUrl + "/register");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-
+AsyncFlow UserController::runRegister(QString username, QString email, QString password)
+{
     QJsonObject jsonObject;
     jsonObject["username"] = username;
     jsonObject["email"] = email;
     jsonObject["password"] = password;
 
-    QJsonDocument doc(jsonObject);
+    m_authRequest.cancel();
+    AsyncReply registration = AsyncReply::post(m_network, createRequest(QUrl(m_authUrl + "/register")),
+                                               QJsonDocument(jsonObject).toJson(), NetworkService::Interactive,
+                                               this, kInteractiveTimeoutMs);
+    m_authRequest = registration;
 
-    m_networkManager->post(request, doc.toJson());
+    const NetworkResponse response = co_await registration;
+    if (response.cancelled) {
+        co_return;
+    }
+    setLoading(false);
+
+    const QJsonObject json = response.json().object();
+    if (!response.ok() || !json.contains("id")) {
+        setErrorMessage(authError(response, json));
+        co_return;
+    }
+
+    setUsername(json["username"].toString());
+    emit userDataChanged();
 }
 
 void UserController::logout()
 {
+    // Nothing that was in flight for the old session may land after this
+    m_authRequest.cancel();
+    m_profileRequest.cancel();
+    m_favoritesRequest.cancel();
+    m_batchProfile = false;
+    m_batchFavorites = false;
+
     clearCredentials();
-    emit authStateChanged();
 }
 
 void UserController::getUserProfile()
@@ -99,14 +163,27 @@ void UserController::getUserProfile()
         return;
     }
 
-    setLoading(true);
+    // Background refresh: no spinner, and the scheduler may drop it when the app is hidden
+    runProfileRefresh();
+}
 
-    QUrl url(m_authUrl + "/profile");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_authToken).toUtf8());
+AsyncFlow UserController::runProfileRefresh()
+{
+    // Waits out a token renewal instead of failing with the old token
+    co_await m_tokens->ready(this);
+    const QString token = m_tokens->token();
+    AsyncReply profile = requestProfile(NetworkService::Background);
+    settleProfile(co_await profile, token);
+}
 
-    m_networkManager->get(request);
+AsyncFlow UserController::settleProfile(NetworkResponse response, QString token)
+{
+    // One renewal however many requests were turned away, then one retry
+    if (response.error == QNetworkReply::AuthenticationRequiredError && co_await m_tokens->renew(this, token)) {
+        AsyncReply profile = requestProfile(NetworkService::Background);
+        response = co_await profile;
+    }
+    applyProfile(response);
 }
 
 void UserController::getFavorites()
@@ -116,34 +193,107 @@ void UserController::getFavorites()
     }
 
     setLoading(true);
+    runFavoritesRefresh();
+}
+
+AsyncFlow UserController::runFavoritesRefresh()
+{
+    co_await m_tokens->ready(this);
+    const QString token = m_tokens->token();
+    AsyncReply favorites = requestFavorites();
+    settleFavorites(co_await favorites, token);
+}
 
-    QUrl url(m_apiUrl + "/favorites");
+AsyncFlow UserController::settleFavorites(NetworkResponse response, QString token)
+{
+    if (response.error == QNetworkReply::AuthenticationRequiredError && co_await m_tokens->renew(this, token)) {
+        AsyncReply favorites = requestFavorites();
+        response = co_await favorites;
+    }
+    applyFavoritesResponse(response);
+}
+
+QNetworkRequest UserController::createRequest(const QUrl &url) const
+{
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_authToken).toUtf8());
+    m_tokens->authorize(request);
+    return request;
+}
+
+AsyncReply UserController::requestProfile(NetworkService::Priority priority)
+{
+    m_profileRequest.cancel();
+    m_batchProfile = false;
+    m_profileRequest = AsyncReply::get(m_network, createRequest(QUrl(m_authUrl + "/profile")),
+                                       priority, this, kBackgroundTimeoutMs);
+    return m_profileRequest;
+}
 
-    m_networkManager->get(request);
+AsyncReply UserController::requestFavorites()
+{
+    // Only the latest list counts
+    m_favoritesRequest.cancel();
+    m_batchFavorites = false;
+    m_favoritesRequest = AsyncReply::get(m_network, createRequest(QUrl(m_apiUrl + "/favorites")),
+                                         NetworkService::Normal, this, kBackgroundTimeoutMs);
+    return m_favoritesRequest;
 }
 
-void UserController::addToFavorites(const QString &restaurantId)
+QNetworkRequest UserController::batchRequest() const
 {
-    if (!isLoggedIn() || restaurantId.isEmpty()) {
+    return createRequest(QUrl(m_apiUrl + "/batch"));
+}
+
+void UserController::appendBatch(ApiBatch &batch)
+{
+    if (!isLoggedIn()) {
         return;
     }
 
+    // The batch answers supersede anything still in flight
+    m_profileRequest.cancel();
+    m_favoritesRequest.cancel();
+    m_batchProfile = true;
+    m_batchFavorites = true;
+    m_batchToken = m_tokens->token();
+
     setLoading(true);
+    batch.add("profile", "profile");
+    batch.add("favorites", "favorites");
+}
 
-    QUrl url(m_apiUrl + "/favorites");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_authToken).toUtf8());
+void UserController::applyBatch(const ApiBatch::Responses &responses)
+{
+    if (m_batchProfile && responses.contains("profile")) {
+        m_batchProfile = false;
+        settleProfile(responses.value("profile"), m_batchToken);
+    }
+    if (m_batchFavorites && responses.contains("favorites")) {
+        m_batchFavorites = false;
+        settleFavorites(responses.value("favorites"), m_batchToken);
+    }
+}
+
+void UserController::addToFavorites(const QString &restaurantId)
+{
+    if (!isLoggedIn() || restaurantId.isEmpty()) {
+        return;
+    }
+
+    // Apply locally right away; the action queue delivers it once the backend is reachable
+    if (!m_favorites.contains(restaurantId)) {
+        m_favorites.append(restaurantId);
+    }
+    m_store->setFavorite(restaurantId, true);
+    emit favoriteAdded(restaurantId);
 
     QJsonObject jsonObject;
     jsonObject["restaurant_id"] = restaurantId;
 
     QJsonDocument doc(jsonObject);
 
-    m_networkManager->post(request, doc.toJson());
+    m_actionQueue->enqueue("POST", QUrl(m_apiUrl + "/favorites"), doc.toJson(QJsonDocument::Compact));
 }
 
 void UserController::removeFromFavorites(const QString &restaurantId)
@@ -152,13 +302,11 @@ void UserController::removeFromFavorites(const QString &restaurantId)
         return;
     }
 
-    setLoading(true);
-
-    QUrl url(m_apiUrl + "/favorites/" + restaurantId);
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_authToken).toUtf8());
+    m_favorites.removeAll(restaurantId);
+    m_store->setFavorite(restaurantId, false);
+    emit favoriteRemoved(restaurantId);
 
-    m_networkManager->deleteResource(request);
+    m_actionQueue->enqueue("DELETE", QUrl(m_apiUrl + "/favorites/" + restaurantId));
 }
 
 void UserController::clearError()
@@ -166,98 +314,112 @@ void UserController::clearError()
     setErrorMessage("");
 }
 
-void UserController::handleNetworkReply(QNetworkReply *reply)
+QString UserController::authError(const NetworkResponse &response, const QJsonObject &json)
 {
-    setLoading(false);
+    // The auth service explains rejected credentials in the body
+    if (json.contains("error")) {
+        return json["error"].toString();
+    }
+    if (!response.ok()) {
+        return "Network error: " + response.errorString;
+    }
+    return "Invalid response from server";
+}
 
-    if (reply->error() != QNetworkReply::NoError) {
-        // Check if it's a 404 error
-        if (reply->error() == QNetworkReply::ContentNotFoundError) {
-            // For favorites, treat 404 as empty list
-            if (reply->url().path().contains("/favorites")) {
-                m_favorites.clear();
-                emit favoritesUpdated(m_favorites);
-                reply->deleteLater();
-                return;
-            }
-        }
-        setErrorMessage("Network error: " + reply->errorString());
-        reply->deleteLater();
+void UserController::applyProfile(const NetworkResponse &response)
+{
+    // Logged out, or the session ended, while this was in flight
+    if (response.cancelled || !isLoggedIn()) {
         return;
     }
 
-    QByteArray data = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-
-    if (doc.isNull()) {
-        // For favorites, treat empty response as empty list
-        if (reply->url().path().contains("/favorites")) {
-            m_favorites.clear();
-            emit favoritesUpdated(m_favorites);
-            reply->deleteLater();
-            return;
+    if (!response.ok()) {
+        // Offline: keep the profile we have and keep quiet about it
+        if (!response.connectivityError) {
+            setErrorMessage("Network error: " + response.errorString);
+        }
+    } else {
+        const QJsonObject json = response.json().object();
+        if (json.contains("username")) {
+            setUsername(json["username"].toString());
+            emit userDataChanged();
         }
-        setErrorMessage("Invalid response from server");
-        reply->deleteLater();
+    }
+}
+
+void UserController::applyFavoritesResponse(const NetworkResponse &response)
+{
+    if (response.cancelled) {
+        return;
+    }
+    setLoading(false);
+    if (!isLoggedIn()) {
         return;
     }
 
-    QJsonObject jsonObject = doc.object();
-    QString urlPath = reply->url().path();
-
-    if (urlPath.contains("/auth/login")) {
-        if (jsonObject.contains("access_token")) {
-            setUsername(jsonObject["username"].toString());
-            setAuthToken(jsonObject["access_token"].toString());
-            saveCredentials();
-            emit authStateChanged();
-        } else if (jsonObject.contains("error")) {
-            setErrorMessage(jsonObject["error"].toString());
+    if (!response.ok()) {
+        if (response.connectivityError) {
+            // Offline: fall back to the last favorites we saw and keep quiet about it
+            applyFavorites(QJsonDocument::fromJson(m_offlineCache.load("favorites")));
+        } else if (response.error == QNetworkReply::ContentNotFoundError) {
+            // No favorites yet
+            applyFavorites(QJsonDocument());
+        } else {
+            setErrorMessage("Network error: " + response.errorString);
         }
-    } else if (urlPath.contains("/auth/register")) {
-        if (jsonObject.contains("id")) {
-            setUsername(jsonObject["username"].toString());
-            emit userDataChanged();
-        } else if (jsonObject.contains("error")) {
-            setErrorMessage(jsonObject["error"].toString());
-        }
-    } else if (urlPath.contains("/auth/profile")) {
-        if (jsonObject.contains("username")) {
-            setUsername(jsonObject["username"].toString());
-            emit userDataChanged();
+    } else {
+        // An empty body means an empty list
+        const QJsonDocument doc = response.json();
+        if (!doc.isNull()) {
+            m_offlineCache.store("favorites", response.body);
         }
-    } else if (urlPath.contains("/favorites") && !reply->url().path().contains("/favorites/")) {
-        if (reply->operation() == QNetworkAccessManager::GetOperation) {
-            // Processing list of favorites
-            m_favorites.clear();
-            if (jsonObject.contains("favorites") && jsonObject["favorites"].isArray()) {
-                QJsonArray favoritesArray = jsonObject["favorites"].toArray();
-                for (const QJsonValue &value : favoritesArray) {
-                    m_favorites.append(value.toObject()["id"].toString());
-                }
-            }
-            emit favoritesUpdated(m_favorites);
-        } else if (reply->operation() == QNetworkAccessManager::PostOperation) {
-            // Added a favorite
-            if (jsonObject.contains("restaurant_id")) {
-                QString restaurantId = jsonObject["restaurant_id"].toString();
-                if (!m_favorites.contains(restaurantId)) {
-                    m_favorites.append(restaurantId);
-                }
-                emit favoriteAdded(restaurantId);
+        applyFavorites(doc);
+    }
+}
+
+void UserController::onActionRejected(const QString &id, const QByteArray &method, const QUrl &url, const QString &error)
+{
+    Q_UNUSED(id)
+    Q_UNUSED(method)
+
+    // The optimistic local change was wrong; resync with the server's view
+    if (url.path().contains("/favorites")) {
+        setErrorMessage("Could not update favorites: " + error);
+        getFavorites();
+    }
+}
+
+void UserController::applyFavorites(const QJsonDocument &doc)
+{
+    m_favorites.clear();
+
+    // The API returns a plain array of restaurants; older builds wrapped it in {"favorites": [...]}
+    QJsonArray favoritesArray = doc.isArray() ? doc.array() : doc.object()["favorites"].toArray();
+    for (const QJsonValue &value : favoritesArray) {
+        m_favorites.append(value.toObject()["id"].toString());
+    }
+
+    // Favorites may lie outside the current search area; the store keeps their details
+    m_store->ingest(favoritesArray);
+    applyPendingActions();
+    m_store->setFavorites(m_favorites);
+    emit favoritesUpdated(m_favorites);
+}
+
+void UserController::applyPendingActions()
+{
+    // The server has not seen queued actions yet, so replay them over its list
+    const QList<ActionQueue::Action> actions = m_actionQueue->pendingActions();
+    for (const ActionQueue::Action &action : actions) {
+        if (action.method == "POST") {
+            const QString restaurantId = QJsonDocument::fromJson(action.body).object()["restaurant_id"].toString();
+            if (!restaurantId.isEmpty() && !m_favorites.contains(restaurantId)) {
+                m_favorites.append(restaurantId);
             }
-        }
-    } else if (urlPath.contains("/favorites/") && reply->operation() == QNetworkAccessManager::DeleteOperation) {
-        // Removed a favorite
-        QStringList parts = urlPath.split("/");
-        if (parts.length() >= 3) {
-            QString restaurantId = parts.last();
-            m_favorites.removeAll(restaurantId);
-            emit favoriteRemoved(restaurantId);
+        } else if (action.method == "DELETE") {
+            m_favorites.removeAll(action.url.path().section('/', -1));
         }
     }
-
-    reply->deleteLater();
 }
 
 void UserController::setUsername(const QString &username)
@@ -268,13 +430,6 @@ void UserController::setUsername(const QString &username)
     }
 }
 
-void UserController::setAuthToken(const QString &token)
-{
-    if (m_authToken != token) {
-        m_authToken = token;
-    }
-}
-
 void UserController::setErrorMessage(const QString &message)
 {
     if (m_errorMessage != message) {
@@ -295,28 +450,70 @@ void UserController::loadStoredCredentials()
 {
     QSettings settings;
     m_username = settings.value("user/username").toString();
-    m_authToken = settings.value("user/authToken").toString();
+    m_loggedIn = isLoggedIn();
+    m_actionQueue->setAuthToken(m_tokens->token());
+}
 
-    if (!m_authToken.isEmpty()) {
-        emit authStateChanged();
-        getUserProfile();
-    }
+void UserController::startDeferred()
+{
+    // Off the path to the first frame: connection warm-up
+    m_network->prewarm(QUrl(m_authUrl));
+    m_network->prewarm(QUrl(m_apiUrl));
+}
+
+void UserController::setAuthUrl(const QString &url)
+{
+    m_authUrl = url;
+}
+
+void UserController::setApiUrl(const QString &url)
+{
+    m_apiUrl = url;
+}
+
+ActionQueue *UserController::actionQueue() const
+{
+    return m_actionQueue;
 }
 
 void UserController::saveCredentials()
 {
     QSettings settings;
     settings.setValue("user/username", m_username);
-    settings.setValue("user/authToken", m_authToken);
 }
 
 void UserController::clearCredentials()
 {
+    // Whatever was loading was cancelled with the session, and its answer is never applied
+    setLoading(false);
     m_username = "";
-    m_authToken = "";
     m_favorites.clear();
+    m_store->setFavorites(QStringList());
+    m_actionQueue->clear();
+    m_offlineCache.clear();
+    m_tokens->clear();
 
     QSettings settings;
     settings.remove("user/username");
-    settings.remove("user/authToken");
+}
+
+void UserController::onTokenChanged()
+{
+    // Renewals swap the token; only logging in or out changes the auth state
+    m_actionQueue->setAuthToken(m_tokens->token());
+    if (m_loggedIn != isLoggedIn()) {
+        m_loggedIn = isLoggedIn();
+        emit authStateChanged();
+    }
+}
+
+void UserController::onSessionExpired()
+{
+    m_profileRequest.cancel();
+    m_favoritesRequest.cancel();
+    m_batchProfile = false;
+    m_batchFavorites = false;
+
+    clearCredentials();
+    setErrorMessage("Session expired. Please log in again.");
 }
@@ -2,9 +2,15 @@
 #define USERCONTROLLER_H
 
 #include <QObject>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
-#include <QJSValue>
+#include <QJsonObject>
+#include "ActionQueue.h"
+#include "ApiBatch.h"
+#include "AsyncReply.h"
+#include "OfflineCache.h"
+#include "NetworkService.h"
+#include "RestaurantStore.h"
+#include "TokenManager.h"
 
 class UserController : public QObject
 {
@@ -15,7 +21,7 @@ class UserController : public QObject
     Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
 
 public:
-    explicit UserController(QObject *parent = nullptr);
+    UserController(NetworkService *network, RestaurantStore *store, TokenManager *tokens, QObject *parent = nullptr);
     ~UserController();
 
     bool isLoggedIn() const;
@@ -23,6 +29,18 @@ public:
     QString errorMessage() const;
     bool loading() const;
 
+    // Warms up connections; call after the first frame
+    void startDeferred();
+    void setAuthUrl(const QString &url);
+    void setApiUrl(const QString &url);
+    // Favorite changes on their way to the backend
+    ActionQueue *actionQueue() const;
+
+    // Profile and favorites as part of a combined request, and their answers
+    QNetworkRequest batchRequest() const;
+    void appendBatch(ApiBatch &batch);
+    void applyBatch(const ApiBatch::Responses &responses);
+
 public slots:
     void login(const QString &username, const QString &password);
     void register_(const QString &username, const QString &email, const QString &password);
@@ -43,26 +61,54 @@ signals:
     void favoriteRemoved(const QString &restaurantId);
 
 private slots:
-    void handleNetworkReply(QNetworkReply *reply);
+    void onTokenChanged();
+    void onSessionExpired();
+    void onActionRejected(const QString &id, const QByteArray &method, const QUrl &url, const QString &error);
 
 private:
-    QNetworkAccessManager *m_networkManager;
+    NetworkService *m_network;
+    RestaurantStore *m_store;
+    TokenManager *m_tokens;
+    ActionQueue *m_actionQueue;
+    OfflineCache m_offlineCache;
     QString m_username;
     QString m_email;
-    QString m_authToken;
     QString m_errorMessage;
     bool m_loading;
     QStringList m_favorites;
     QString m_authUrl;
     QString m_apiUrl;
+    // In-flight requests a newer one or logout supersedes
+    AsyncReply m_authRequest;
+    AsyncReply m_profileRequest;
+    AsyncReply m_favoritesRequest;
+    // Parts of a batch not yet answered or superseded
+    bool m_batchProfile;
+    bool m_batchFavorites;
+    // The token the batch went out with, to tell a stale one from a rejected one
+    QString m_batchToken;
+    bool m_loggedIn;
 
     void setUsername(const QString &username);
-    void setAuthToken(const QString &token);
     void setErrorMessage(const QString &message);
     void setLoading(bool loading);
     void loadStoredCredentials();
     void saveCredentials();
     void clearCredentials();
+    AsyncFlow runLogin(QString username, QString password);
+    AsyncFlow runRegister(QString username, QString email, QString password);
+    AsyncFlow runProfileRefresh();
+    AsyncFlow runFavoritesRefresh();
+    AsyncFlow settleProfile(NetworkResponse response, QString token);
+    AsyncFlow settleFavorites(NetworkResponse response, QString token);
+    QNetworkRequest createRequest(const QUrl &url) const;
+    AsyncReply requestProfile(NetworkService::Priority priority);
+    AsyncReply requestFavorites();
+    static QString authError(const NetworkResponse &response, const QJsonObject &json);
+    void applyProfile(const NetworkResponse &response);
+    void applyFavoritesResponse(const NetworkResponse &response);
+    void applyFavorites(const QJsonDocument &doc);
+    void applyPendingActions();
 };
 
 #endif // USERCONTROLLER_H
@@ -156,6 +156,39 @@ func GetUserProfile(c *gin.Context) {
 	c.JSON(http.StatusOK, user.ToUserResponse())
 }
 
+// RefreshToken issues a new token for a still-valid one, so clients can renew
+// a session before it expires instead of sending the user back to login
+func RefreshToken(c *gin.Context) {
+	// Get user ID from JWT context
+	userID := c.GetString("user_id")
+	if userID == "" {
+		c.JSON(http.StatusUnauthorized, gin.H{"error": "User not authenticated"})
+		return
+	}
+
+	// The account may have been removed since the token was issued
+	user, err := models.GetUserByID(userID)
+	if err != nil {
+		c.JSON(http.StatusUnauthorized, gin.H{"error": "User not found"})
+		return
+	}
+
+	token, err := generateJWT(user)
+	if err != nil {
+		log.Printf("Error generating token: %v", err)
+		c.JSON(http.StatusInternalServerError, gin.H{"error": "Failed to generate token"})
+		return
+	}
+
+	c.JSON(http.StatusOK, TokenResponse{
+		AccessToken: token,
+		TokenType:   "Bearer",
+		Username:    user.Username,
+		Name:        user.Name,
+		UserID:      user.ID,
+	})
+}
+
 // UpdateUserProfile updates a user's profile information
 func UpdateUserProfile(c *gin.Context) {
 	// Get user ID from JWT context
@@ -44,6 +44,7 @@ func main() {
 	{
 		profile.GET("/profile", handlers.GetUserProfile)
 		profile.PUT("/profile", handlers.UpdateUserProfile)
+		profile.POST("/refresh", handlers.RefreshToken)
 	}
 
 	// Start server
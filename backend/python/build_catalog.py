@@ -0,0 +1,158 @@
+"""
+Build the client's offline catalog (.vcat) from vegfinder.db.
+
+The app memory-maps the file and reads rows in place (see CatalogFile.h), so
+the layout below is the client's in-memory layout. Everything is
+little-endian and every section starts on an 8-byte boundary:
+
+    header   magic, version, counts and section offsets (80 bytes)
+    rows     fixed-width records (80 bytes), sorted by geohash cell
+    cells    (cell key u64, first row u32, row count u32), sorted by key
+    ids      row numbers (u32) sorted by id bytes
+    photos   string references (offset u32, length u32), a run per row
+    strings  UTF-8 pool, each distinct string stored once
+
+    python build_catalog.py [--db vegfinder.db] [--out catalog.vcat]
+"""
+import argparse
+import sqlite3
+import struct
+import time
+
+from geo_cells import cell_of
+
+MAGIC = b"VEGCAT\0\0"
+VERSION = 1
+
+# Same cells as the client's GeoHashIndex: roughly 1.2 x 0.6 km
+PRECISION = 6
+
+HEADER = struct.Struct("<8sIIIIQQQQQQQ")
+ROW = struct.Struct("<14IddIHBB")
+CELL = struct.Struct("<QII")
+STRING_REF = struct.Struct("<II")
+
+VEGAN_FLAG = 0x1
+VEGETARIAN_FLAG = 0x2
+
+STRING_COLUMNS = ("id", "name", "address", "phone_number", "website", "cuisine_type", "description")
+
+
+class StringPool:
+    """UTF-8 blob with duplicate strings shared"""
+
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, value):
+        encoded = (value or "").encode("utf-8")
+        ref = self.offsets.get(encoded)
+        if ref is None:
+            ref = (len(self.data), len(encoded))
+            self.offsets[encoded] = ref
+            self.data += encoded
+        return ref
+
+
+def cell_key(latitude, longitude):
+    _, ilat, ilon = cell_of(latitude, longitude, PRECISION)
+    return (ilat << 32) | ilon
+
+
+def load(db_path):
+    conn = sqlite3.connect("file:%s?mode=ro" % db_path, uri=True)
+    conn.row_factory = sqlite3.Row
+    try:
+        restaurants = conn.execute(
+            "SELECT id, name, address, phone_number, website, cuisine_type, description, "
+            "latitude, longitude, rating, is_vegan, is_vegetarian FROM restaurants"
+        ).fetchall()
+        photos = {}
+        for row in conn.execute("SELECT restaurant_id, url FROM photos ORDER BY id"):
+            photos.setdefault(row["restaurant_id"], []).append(row["url"])
+    finally:
+        conn.close()
+    return restaurants, photos
+
+
+def align(buffer):
+    buffer += b"\0" * (-len(buffer) % 8)
+
+
+def build(restaurants, photos):
+    # Rows of a cell are contiguous, so a nearby lookup reads a few runs of the file
+    # Rows are not orderable, so ties within a cell go by id
+    rows = sorted(
+        ((cell_key(r["latitude"] or 0.0, r["longitude"] or 0.0), r) for r in restaurants),
+        key=lambda item: (item[0], item[1]["id"]),
+    )
+
+    pool = StringPool()
+    row_data = bytearray()
+    photo_data = bytearray()
+    cells = []
+    photo_count = 0
+
+    for index, (key, r) in enumerate(rows):
+        if cells and cells[-1][0] == key:
+            cells[-1][2] += 1
+        else:
+            cells.append([key, index, 1])
+
+        refs = []
+        for name in STRING_COLUMNS:
+            refs.extend(pool.add(r[name]))
+
+        urls = photos.get(r["id"], [])[:0xFFFF]
+        first_photo = photo_count
+        for url in urls:
+            photo_data += STRING_REF.pack(*pool.add(url))
+        photo_count += len(urls)
+
+        flags = (VEGAN_FLAG if r["is_vegan"] else 0) | (VEGETARIAN_FLAG if r["is_vegetarian"] else 0)
+        rating = max(0, min(int(r["rating"] or 0), 255))
+        row_data += ROW.pack(
+            *refs, float(r["latitude"] or 0.0), float(r["longitude"] or 0.0),
+            first_photo, len(urls), rating, flags,
+        )
+
+    cell_data = b"".join(CELL.pack(*cell) for cell in cells)
+
+    # Sorted by raw bytes, which is how the client compares ids
+    ids = sorted(range(len(rows)), key=lambda i: rows[i][1]["id"].encode("utf-8"))
+    id_data = bytearray(struct.pack("<%dI" % len(ids), *ids))
+
+    out = bytearray(HEADER.size)
+    sections = []
+    for section in (row_data, cell_data, id_data, photo_data, pool.data):
+        align(out)
+        sections.append(len(out))
+        out += section
+
+    HEADER.pack_into(
+        out, 0, MAGIC, VERSION, len(rows), len(cells), PRECISION, photo_count,
+        *sections, len(pool.data),
+    )
+    return bytes(out), len(rows), len(cells)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--db", default="vegfinder.db")
+    parser.add_argument("--out", default="catalog.vcat")
+    args = parser.parse_args()
+
+    started = time.perf_counter()
+    restaurants, photos = load(args.db)
+    data, rows, cells = build(restaurants, photos)
+    with open(args.out, "wb") as f:
+        f.write(data)
+
+    print("%s: %d restaurants in %d cells, %.1f MB, %.2f s" % (
+        args.out, rows, cells, len(data) / 1e6, time.perf_counter() - started,
+    ))
+
+
+if __name__ == "__main__":
+    main()
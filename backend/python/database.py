@@ -1,18 +1,62 @@
-from sqlalchemy import create_engine
+from sqlalchemy import create_engine, event
 from sqlalchemy.ext.declarative import declarative_base
 from sqlalchemy.orm import sessionmaker
+from sqlalchemy.pool import QueuePool
 import os
+import sqlite3
 
 # Get database URL from environment variable or use a default SQLite database
 DATABASE_URL = os.getenv("DATABASE_URL", "sqlite:///./vegfinder.db")
 
+# Connections in the read-only pool, per worker process
+READ_POOL_SIZE = int(os.getenv("READ_POOL_SIZE", "8"))
+
+IS_SQLITE = DATABASE_URL.startswith("sqlite")
+
 # Create SQLAlchemy engine
 engine = create_engine(
-    DATABASE_URL, connect_args={"check_same_thread": False} if DATABASE_URL.startswith("sqlite") else {}
+    DATABASE_URL, connect_args={"check_same_thread": False, "timeout": 30} if IS_SQLITE else {}
 )
 
+if IS_SQLITE:
+    @event.listens_for(engine, "connect")
+    def _configure_sqlite(dbapi_connection, connection_record):
+        # WAL lets readers in every worker run alongside a single writer
+        cursor = dbapi_connection.cursor()
+        cursor.execute("PRAGMA journal_mode=WAL")
+        cursor.execute("PRAGMA synchronous=NORMAL")
+        cursor.close()
+
+def _sqlite_path(url: str) -> str:
+    return url[len("sqlite:///"):]
+
+def _create_read_engine():
+    if not IS_SQLITE or DATABASE_URL in ("sqlite://", "sqlite:///:memory:"):
+        return engine
+
+    path = os.path.abspath(_sqlite_path(DATABASE_URL))
+
+    def connect():
+        connection = sqlite3.connect(
+            "file:%s?mode=ro" % path, uri=True, check_same_thread=False, timeout=30
+        )
+        connection.execute("PRAGMA query_only=ON")
+        return connection
+
+    return create_engine(
+        "sqlite://",
+        creator=connect,
+        poolclass=QueuePool,
+        pool_size=READ_POOL_SIZE,
+        max_overflow=READ_POOL_SIZE,
+    )
+
+# Read-only engine for the hot query endpoints
+read_engine = _create_read_engine()
+
 # Create sessionmaker
 SessionLocal = sessionmaker(autocommit=False, autoflush=False, bind=engine)
+ReadSessionLocal = sessionmaker(autocommit=False, autoflush=False, bind=read_engine)
 
 # Create a base class for declarative models
 Base = declarative_base()
@@ -24,3 +68,11 @@ def get_db():
         yield db
     finally:
         db.close()
+
+# Get read-only database session
+def get_read_db():
+    db = ReadSessionLocal()
+    try:
+        yield db
+    finally:
+        db.close()
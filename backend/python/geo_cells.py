@@ -0,0 +1,279 @@
+"""
+Geohash bucketing of the restaurant catalog with cached per-cell result sets.
+
+A nearby query is answered by merging the few geohash cells that cover its
+bounding box. Each cell's restaurants are loaded once, converted to response
+schemas and kept in memory until a write touches that cell. Writes from this
+process invalidate exactly the affected cells through ORM events. Every row
+write also bumps catalog_version; a bump this process did not account for
+comes from another worker and drops the whole cache on the next request.
+"""
+import math
+import threading
+from collections import OrderedDict
+from typing import Dict, Iterable, List, Optional, Set, Tuple
+
+from sqlalchemy import event, text
+from sqlalchemy.engine import Engine
+from sqlalchemy.orm import Session, joinedload
+
+import models
+import schemas
+import search_index
+
+BASE32 = "0123456789bcdefghjkmnpqrstuvwxyz"
+
+# Finest and coarsest cells used; precision 7 is ~150 m, precision 3 ~150 km
+MAX_PRECISION = 7
+MIN_PRECISION = 3
+
+# A query may merge at most this many cells before a coarser precision is used
+MAX_CELLS = 16
+
+# Cached cells per process; the least recently used are dropped first
+MAX_CACHED_CELLS = 4096
+
+Cell = Tuple[int, int, int]  # (precision, latitude index, longitude index)
+
+_VERSION_SCHEMA = [
+    "CREATE TABLE IF NOT EXISTS catalog_version (id INTEGER PRIMARY KEY CHECK (id = 1), version INTEGER NOT NULL)",
+    "INSERT OR IGNORE INTO catalog_version (id, version) VALUES (1, 0)",
+]
+for _table in ("restaurants", "photos"):
+    for _action in ("INSERT", "UPDATE", "DELETE"):
+        _VERSION_SCHEMA.append(
+            "CREATE TRIGGER IF NOT EXISTS %s_version_%s AFTER %s ON %s BEGIN "
+            "UPDATE catalog_version SET version = version + 1 WHERE id = 1; END"
+            % (_table, _action.lower(), _action, _table)
+        )
+
+
+def _bits(precision: int) -> Tuple[int, int]:
+    """(latitude bits, longitude bits); geohash gives longitude the odd bit"""
+    total = 5 * precision
+    return total // 2, total - total // 2
+
+
+def cell_size(precision: int) -> Tuple[float, float]:
+    lat_bits, lon_bits = _bits(precision)
+    return 180.0 / (1 << lat_bits), 360.0 / (1 << lon_bits)
+
+
+def cell_of(latitude: float, longitude: float, precision: int) -> Cell:
+    lat_bits, lon_bits = _bits(precision)
+    dlat, dlon = cell_size(precision)
+    ilat = min(int((latitude + 90.0) // dlat), (1 << lat_bits) - 1)
+    ilon = int((longitude + 180.0) // dlon) % (1 << lon_bits)
+    return precision, max(ilat, 0), ilon
+
+
+def geohash(cell: Cell) -> str:
+    precision, ilat, ilon = cell
+    lat_bits, lon_bits = _bits(precision)
+    lat_left, lon_left = lat_bits, lon_bits
+    value = 0
+    for bit in range(5 * precision):
+        # Bits interleave longitude first, most significant first
+        if bit % 2 == 0:
+            lon_left -= 1
+            value = (value << 1) | ((ilon >> lon_left) & 1)
+        else:
+            lat_left -= 1
+            value = (value << 1) | ((ilat >> lat_left) & 1)
+    return "".join(BASE32[(value >> shift) & 31] for shift in range(5 * (precision - 1), -5, -5))
+
+
+def encode(latitude: float, longitude: float, precision: int) -> str:
+    return geohash(cell_of(latitude, longitude, precision))
+
+
+def cell_box(cell: Cell) -> Tuple[float, float, float, float]:
+    precision, ilat, ilon = cell
+    dlat, dlon = cell_size(precision)
+    min_lat = ilat * dlat - 90.0
+    min_lon = ilon * dlon - 180.0
+    return min_lat, min_lat + dlat, min_lon, min_lon + dlon
+
+
+def covering(latitude: float, longitude: float, radius: float) -> List[Cell]:
+    """Cells at the finest precision that covers the search circle's box in at most MAX_CELLS"""
+    min_lat, max_lat, min_lon, max_lon = search_index.bounding_box(latitude, longitude, radius)
+    min_lat, max_lat = max(min_lat, -90.0), min(max_lat, 90.0)
+
+    for precision in range(MAX_PRECISION, MIN_PRECISION - 1, -1):
+        _, low_lat, low_lon = cell_of(min_lat, min_lon, precision)
+        _, high_lat, _ = cell_of(max_lat, max_lon, precision)
+        _, lon_bits = _bits(precision)
+        dlat, dlon = cell_size(precision)
+        lon_cells = min(int(math.floor((max_lon + 180.0) / dlon) - math.floor((min_lon + 180.0) / dlon)) + 1, 1 << lon_bits)
+        if (high_lat - low_lat + 1) * lon_cells <= MAX_CELLS or precision == MIN_PRECISION:
+            return [
+                (precision, ilat, (low_lon + step) % (1 << lon_bits))
+                for ilat in range(low_lat, high_lat + 1)
+                for step in range(lon_cells)
+            ]
+    return []
+
+
+def _run_boxes(cells: List[Cell]) -> List[Tuple[float, float, float, float]]:
+    """
+    Boxes around runs of cells with consecutive longitude indexes. A single
+    box around cells on both sides of the antimeridian would span the globe.
+    """
+    runs: List[List[int]] = []
+    for ilon in sorted({cell[2] for cell in cells}):
+        if runs and ilon == runs[-1][-1] + 1:
+            runs[-1].append(ilon)
+        else:
+            runs.append([ilon])
+
+    boxes = []
+    for run in runs:
+        members = set(run)
+        run_boxes = [cell_box(cell) for cell in cells if cell[2] in members]
+        boxes.append((
+            min(b[0] for b in run_boxes), max(b[1] for b in run_boxes),
+            min(b[2] for b in run_boxes), max(b[3] for b in run_boxes),
+        ))
+    return boxes
+
+
+def ensure_version_table(engine: Engine) -> None:
+    if not search_index.is_supported(engine):
+        return
+    with engine.begin() as conn:
+        for statement in _VERSION_SCHEMA:
+            conn.execute(text(statement))
+
+
+class CellCache:
+    def __init__(self, max_cells: int = MAX_CACHED_CELLS):
+        self._lock = threading.Lock()
+        self._cells: "OrderedDict[Cell, List[schemas.Restaurant]]" = OrderedDict()
+        self._cells_by_id: Dict[str, Set[Cell]] = {}
+        self._max_cells = max_cells
+        self._version: Optional[int] = None
+        # Row writes seen through ORM events since the last version check
+        self._local_writes = 0
+        # Bumped by every invalidation; a load that raced one is not cached
+        self._generation = 0
+
+    def restaurants(self, db: Session, latitude: float, longitude: float, radius: float) -> List[schemas.Restaurant]:
+        """Restaurants in the cells covering the circle; callers apply the exact distance"""
+        self._check_version(db)
+        cells = covering(latitude, longitude, radius)
+
+        merged: List[schemas.Restaurant] = []
+        missing: List[Cell] = []
+        with self._lock:
+            # Rows read before an invalidation must not be cached after it
+            generation = self._generation
+            for cell in cells:
+                rows = self._cells.get(cell)
+                if rows is None:
+                    missing.append(cell)
+                else:
+                    self._cells.move_to_end(cell)
+                    merged.extend(rows)
+
+        if missing:
+            for rows in self._load(db, missing, generation).values():
+                merged.extend(rows)
+        return merged
+
+    def invalidate(self, restaurant_id: str, positions: Iterable[Tuple[float, float]] = ()) -> None:
+        """Drop the cells holding a restaurant and any cells covering its new position"""
+        with self._lock:
+            self._local_writes += 1
+            self._generation += 1
+            stale = set(self._cells_by_id.pop(restaurant_id, ()))
+            for latitude, longitude in positions:
+                if latitude is None or longitude is None:
+                    continue
+                for precision in range(MIN_PRECISION, MAX_PRECISION + 1):
+                    stale.add(cell_of(latitude, longitude, precision))
+            for cell in stale:
+                self._drop(cell)
+
+    def clear(self) -> None:
+        with self._lock:
+            self._generation += 1
+            self._cells.clear()
+            self._cells_by_id.clear()
+
+    def _check_version(self, db: Session) -> None:
+        if not search_index.is_supported(db.get_bind()):
+            return
+        version = db.execute(text("SELECT version FROM catalog_version WHERE id = 1")).scalar()
+        with self._lock:
+            expected = None if self._version is None else self._version + self._local_writes
+            if version != expected:
+                # Another worker wrote, or a write rolled back; we cannot tell which cells changed
+                self._generation += 1
+                self._cells.clear()
+                self._cells_by_id.clear()
+            self._version = version
+            self._local_writes = 0
+
+    def _load(self, db: Session, cells: List[Cell], generation: int) -> Dict[Cell, List[schemas.Restaurant]]:
+        # One query per longitude-contiguous run of cells, then bucket by cell
+        wanted = set(cells)
+        precision = cells[0][0]
+        loaded: Dict[Cell, List[schemas.Restaurant]] = {cell: [] for cell in cells}
+        seen: Set[str] = set()
+        for box in _run_boxes(cells):
+            if search_index.is_supported(db.get_bind()):
+                query = search_index.box_candidates(db, box)
+            else:
+                query = db.query(models.Restaurant).filter(
+                    models.Restaurant.latitude.between(box[0], box[1]),
+                    models.Restaurant.longitude.between(box[2], box[3]),
+                )
+
+            for restaurant in query.options(joinedload(models.Restaurant.photos)).all():
+                # A row on the edge between two runs is returned by both
+                if restaurant.id in seen:
+                    continue
+                seen.add(restaurant.id)
+                cell = cell_of(restaurant.latitude, restaurant.longitude, precision)
+                if cell in wanted:
+                    loaded[cell].append(schemas.Restaurant.from_orm(restaurant))
+
+        with self._lock:
+            if generation != self._generation:
+                # A write landed while we read; serve these rows once, uncached
+                return loaded
+            for cell, rows in loaded.items():
+                self._cells[cell] = rows
+                for row in rows:
+                    self._cells_by_id.setdefault(row.id, set()).add(cell)
+            while len(self._cells) > self._max_cells:
+                self._drop(next(iter(self._cells)))
+        return loaded
+
+    def _drop(self, cell: Cell) -> None:
+        rows = self._cells.pop(cell, None)
+        for row in rows or ():
+            cells = self._cells_by_id.get(row.id)
+            if cells is not None:
+                cells.discard(cell)
+                if not cells:
+                    del self._cells_by_id[row.id]
+
+
+cache = CellCache()
+
+
+@event.listens_for(models.Restaurant, "after_insert")
+@event.listens_for(models.Restaurant, "after_update")
+@event.listens_for(models.Restaurant, "after_delete")
+def _restaurant_written(mapper, connection, target):
+    positions = [(target.latitude, target.longitude)]
+    cache.invalidate(target.id, positions)
+
+
+@event.listens_for(models.Photo, "after_insert")
+@event.listens_for(models.Photo, "after_update")
+@event.listens_for(models.Photo, "after_delete")
+def _photo_written(mapper, connection, target):
+    cache.invalidate(target.restaurant_id)
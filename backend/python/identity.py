@@ -0,0 +1,120 @@
+"""
+In-process cache of decoded JWT identities.
+
+Decoding and verifying a token on every request is wasted work when the same
+client sends the same token for hours. Entries are keyed by token and expire
+with the token itself. The users table is synced only when the claims for a
+user id differ from what this process last wrote, so read endpoints normally
+do no database writes.
+"""
+import os
+import threading
+import time
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Dict, Optional, Tuple
+
+import jwt
+from jwt.exceptions import PyJWTError
+import database
+import sync
+
+JWT_SECRET = os.getenv("JWT_SECRET", "dev_secret_change_in_production")
+
+# Upper bound on cached tokens; the least recently used are evicted first
+MAX_ENTRIES = 10000
+
+
+@dataclass(frozen=True)
+class Identity:
+    user_id: str
+    username: Optional[str]
+    name: Optional[str]
+    email: Optional[str]
+    token: str
+    expires_at: float
+
+    def claims(self) -> Tuple[Optional[str], Optional[str], Optional[str]]:
+        return self.username, self.name, self.email
+
+
+_lock = threading.Lock()
+_identities: "OrderedDict[str, Identity]" = OrderedDict()
+# user_id -> claims last known to match the users table
+_synced: Dict[str, Tuple[Optional[str], Optional[str], Optional[str]]] = {}
+
+
+def token_from_header(authorization: Optional[str]) -> Optional[str]:
+    if not authorization or not authorization.startswith("Bearer "):
+        return None
+    return authorization[len("Bearer "):].strip() or None
+
+
+def resolve(token: Optional[str]) -> Optional[Identity]:
+    """Decoded identity for a token, or None if it is missing, invalid or expired"""
+    if not token:
+        return None
+
+    now = time.time()
+    with _lock:
+        identity = _identities.get(token)
+        if identity is not None:
+            if identity.expires_at > now:
+                _identities.move_to_end(token)
+                return identity
+            del _identities[token]
+
+    try:
+        payload = jwt.decode(token, JWT_SECRET, algorithms=["HS256"])
+    except PyJWTError:
+        return None
+
+    user_id = payload.get("user_id")
+    if not user_id:
+        return None
+
+    # Tokens without an exp claim are still re-verified every hour
+    identity = Identity(
+        user_id=user_id,
+        username=payload.get("username"),
+        name=payload.get("name"),
+        email=payload.get("email"),
+        token=token,
+        expires_at=float(payload.get("exp", now + 3600)),
+    )
+
+    with _lock:
+        _identities[token] = identity
+        while len(_identities) > MAX_ENTRIES:
+            _identities.popitem(last=False)
+
+    return identity
+
+
+def ensure_user(identity: Identity) -> bool:
+    """
+    Make sure the users table matches the identity's claims. Returns False if
+    the user could not be created. Only opens a write session the first time a
+    user id is seen by this process or when its claims change.
+    """
+    with _lock:
+        if _synced.get(identity.user_id) == identity.claims():
+            return True
+
+    db = database.SessionLocal()
+    try:
+        user = sync.sync_user_from_claims(db, identity.user_id, identity.username, identity.name, identity.email)
+    finally:
+        db.close()
+    if user is None:
+        return False
+
+    with _lock:
+        _synced[identity.user_id] = identity.claims()
+    return True
+
+
+def clear() -> None:
+    with _lock:
+        _identities.clear()
+        _synced.clear()
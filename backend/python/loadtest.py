@@ -0,0 +1,96 @@
+"""
+Load test for the restaurant endpoints of a running API instance.
+
+    python loadtest.py [--url http://localhost:8000] [--clients 8] [--duration 20]
+
+Each client process keeps one HTTP connection alive and issues nearby and
+search requests back to back. Reports throughput and latency percentiles, so
+runs against serve.py with different --workers show how throughput scales
+with cores.
+"""
+import argparse
+import http.client
+import multiprocessing
+import random
+import statistics
+import time
+from urllib.parse import urlencode, urlparse
+
+CENTER = (37.7749, -122.4194)
+QUERIES = [None, "garden", "vegan", "cafe", "thai"]
+
+
+def client(args):
+    url, duration, seed = args
+    rng = random.Random(seed)
+    target = urlparse(url)
+    connection = http.client.HTTPConnection(target.hostname, target.port or 80, timeout=30)
+
+    latencies = []
+    errors = 0
+    deadline = time.perf_counter() + duration
+    while time.perf_counter() < deadline:
+        params = {
+            "latitude": CENTER[0] + rng.uniform(-0.2, 0.2),
+            "longitude": CENTER[1] + rng.uniform(-0.2, 0.2),
+            "radius": rng.choice([2000, 5000, 10000]),
+        }
+        query = rng.choice(QUERIES)
+        if query:
+            params["query"] = query
+            path = "/api/restaurants/search?"
+        else:
+            path = "/api/restaurants/nearby?"
+
+        start = time.perf_counter()
+        try:
+            connection.request("GET", path + urlencode(params))
+            response = connection.getresponse()
+            response.read()
+            if response.status != 200:
+                errors += 1
+        except (OSError, http.client.HTTPException):
+            errors += 1
+            connection.close()
+            connection = http.client.HTTPConnection(target.hostname, target.port or 80, timeout=30)
+            continue
+        latencies.append((time.perf_counter() - start) * 1000.0)
+
+    connection.close()
+    return latencies, errors
+
+
+def percentile(sorted_values, fraction):
+    if not sorted_values:
+        return 0.0
+    index = min(len(sorted_values) - 1, int(round(fraction * (len(sorted_values) - 1))))
+    return sorted_values[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--url", default="http://localhost:8000")
+    parser.add_argument("--clients", type=int, default=multiprocessing.cpu_count())
+    parser.add_argument("--duration", type=float, default=20.0)
+    args = parser.parse_args()
+
+    with multiprocessing.Pool(args.clients) as pool:
+        results = pool.map(client, [(args.url, args.duration, seed) for seed in range(args.clients)])
+
+    latencies = sorted(latency for result in results for latency in result[0])
+    errors = sum(result[1] for result in results)
+
+    print("clients:     %d" % args.clients)
+    print("requests:    %d (%d errors)" % (len(latencies), errors))
+    print("throughput:  %.1f req/s" % (len(latencies) / args.duration))
+    if latencies:
+        print("latency ms:  p50 %.1f  p90 %.1f  p99 %.1f  mean %.1f" % (
+            percentile(latencies, 0.50),
+            percentile(latencies, 0.90),
+            percentile(latencies, 0.99),
+            statistics.mean(latencies),
+        ))
+
+
+if __name__ == "__main__":
+    main()
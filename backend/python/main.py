@@ -1,11 +1,16 @@
 from fastapi import FastAPI, Depends, HTTPException, status
 from fastapi.middleware.cors import CORSMiddleware
+from fastapi.middleware.gzip import GZipMiddleware
 from typing import List, Optional
+import os
 import uvicorn
 import models
 import schemas
 import database
-from routers import restaurants, favorites, auth
+import search_index
+import offload
+import geo_cells
+from routers import restaurants, favorites, auth, batch
 
 app = FastAPI(title="VegFinder API")
 
@@ -18,13 +23,32 @@ app.add_middleware(
     allow_headers=["*"],
 )
 
-# Create database tables
-models.Base.metadata.create_all(bind=database.engine)
+# Restaurant lists are repetitive JSON and shrink several times over; tiny bodies are not worth it
+app.add_middleware(GZipMiddleware, minimum_size=1000)
+
+# Set by serve.py once it has prepared the database for its workers
+PREPARED_ENV = "VEGFINDER_DB_PREPARED"
+
+def prepare_database():
+    """Create tables and search indexes; safe to run again on a prepared database"""
+    models.Base.metadata.create_all(bind=database.engine)
+
+    # Full-text and spatial indexes for restaurant search (SQLite only)
+    search_index.ensure_search_index(database.engine)
+    geo_cells.ensure_version_table(database.engine)
+
+if not os.getenv(PREPARED_ENV):
+    prepare_database()
 
 # Include routers
 app.include_router(restaurants.router, prefix="/api", tags=["restaurants"])
 app.include_router(favorites.router, prefix="/api", tags=["favorites"])
 app.include_router(auth.router, prefix="/api", tags=["auth"])
+app.include_router(batch.router, prefix="/api", tags=["batch"])
+
+@app.on_event("shutdown")
+def shutdown():
+    offload.shutdown()
 
 @app.get("/")
 def read_root():
@@ -0,0 +1,68 @@
+"""
+Offloading of CPU-bound work away from the event loop.
+
+Geodesic distances are pure Python and hold the GIL, so large batches go to
+a process pool when DISTANCE_WORKERS is set. Small batches, and every batch
+when the pool is disabled, run on the threadpool, where they cannot stall
+other requests on the event loop.
+"""
+import asyncio
+import os
+from concurrent.futures import ProcessPoolExecutor
+from typing import List, Optional, Sequence, Tuple
+
+from geopy.distance import geodesic
+from starlette.concurrency import run_in_threadpool
+
+# Processes per worker for distance batches; 0 keeps everything on threads
+DISTANCE_WORKERS = int(os.getenv("DISTANCE_WORKERS", "0"))
+
+# Below this many points pickling costs more than it saves
+PROCESS_THRESHOLD = 512
+
+_pool: Optional[ProcessPoolExecutor] = None
+
+
+def distances_within(
+    latitude: float,
+    longitude: float,
+    radius: float,
+    points: Sequence[Tuple[float, float]],
+) -> List[Tuple[int, float]]:
+    """(index, metres) for every point within radius, nearest first"""
+    origin = (latitude, longitude)
+    hits = []
+    for index, point in enumerate(points):
+        distance = geodesic(origin, point).meters
+        if distance <= radius:
+            hits.append((index, distance))
+    hits.sort(key=lambda hit: hit[1])
+    return hits
+
+
+def _executor() -> Optional[ProcessPoolExecutor]:
+    global _pool
+    if DISTANCE_WORKERS > 0 and _pool is None:
+        _pool = ProcessPoolExecutor(max_workers=DISTANCE_WORKERS)
+    return _pool
+
+
+async def nearest(
+    latitude: float,
+    longitude: float,
+    radius: float,
+    points: Sequence[Tuple[float, float]],
+) -> List[Tuple[int, float]]:
+    executor = _executor() if len(points) >= PROCESS_THRESHOLD else None
+    if executor is None:
+        return await run_in_threadpool(distances_within, latitude, longitude, radius, points)
+
+    future = executor.submit(distances_within, latitude, longitude, radius, list(points))
+    return await asyncio.wrap_future(future)
+
+
+def shutdown() -> None:
+    global _pool
+    if _pool is not None:
+        _pool.shutdown(cancel_futures=True)
+        _pool = None
@@ -0,0 +1,153 @@
+"""
+Several read requests in one POST, answered in one response.
+
+The app's startup and pull-to-refresh need nearby restaurants, favorites and
+the profile together; sending them as one request saves the extra round trips
+and resolves the caller's token once instead of per request.
+
+    POST /api/batch
+    {"requests": [{"id": "nearby", "op": "nearby",
+                   "params": {"latitude": 52.52, "longitude": 13.40, "radius": 5000}},
+                  {"id": "favorites", "op": "favorites"},
+                  {"id": "profile", "op": "profile"}]}
+
+    {"responses": {"nearby": {"status": 200, "body": [...]},
+                   "favorites": {"status": 200, "body": [...]},
+                   "profile": {"status": 401, "error": "Not authenticated"}}}
+
+Sub-requests run concurrently, each with its own read session, and fail
+independently: the batch itself answers 200 unless the envelope is invalid.
+"""
+import asyncio
+import logging
+from typing import Any, Dict, List, Optional
+
+from fastapi import APIRouter, Header, HTTPException
+from fastapi.encoders import jsonable_encoder
+from pydantic import BaseModel
+from starlette.concurrency import run_in_threadpool
+
+import database, models, schemas
+from routers.favorites import load_favorites
+from routers.restaurants import build_cell_results, current_user_id, load_restaurant, project, run_search
+
+router = APIRouter()
+logger = logging.getLogger(__name__)
+
+# Enough for a startup screen; larger batches would hold a response back too long
+MAX_REQUESTS = 8
+
+class BatchItem(BaseModel):
+    id: str
+    op: str
+    params: Dict[str, Any] = {}
+
+class BatchRequest(BaseModel):
+    requests: List[BatchItem]
+
+def param(params: Dict[str, Any], name: str, kind, default=None, required: bool = False):
+    value = params.get(name)
+    if value is None:
+        if required:
+            raise HTTPException(status_code=422, detail=f"Missing parameter: {name}")
+        return default
+    try:
+        return kind(value)
+    except (TypeError, ValueError):
+        raise HTTPException(status_code=422, detail=f"Invalid parameter: {name}")
+
+def require_user(user_id: Optional[str]) -> str:
+    if not user_id:
+        raise HTTPException(status_code=401, detail="Not authenticated")
+    return user_id
+
+def load_profile(db, user_id: str):
+    user = db.query(models.User).filter(models.User.id == user_id).first()
+    if not user:
+        raise HTTPException(status_code=404, detail="User not found")
+    return schemas.User.from_orm(user)
+
+def fields(params: Dict[str, Any]) -> str:
+    value = param(params, "fields", str, "detail")
+    if value not in ("list", "detail"):
+        raise HTTPException(status_code=422, detail="Invalid parameter: fields")
+    return value
+
+async def nearby(db, params, user_id):
+    projection = fields(params)
+    results = await build_cell_results(
+        db,
+        param(params, "latitude", float, required=True),
+        param(params, "longitude", float, required=True),
+        param(params, "radius", int, 5000),
+        user_id,
+    )
+    return project(results, projection)
+
+async def search(db, params, user_id):
+    projection = fields(params)
+    results = await run_search(
+        db,
+        param(params, "latitude", float, required=True),
+        param(params, "longitude", float, required=True),
+        param(params, "radius", int, 5000),
+        param(params, "query", str),
+        param(params, "cuisine", str),
+        param(params, "min_rating", int),
+        user_id,
+    )
+    return project(results, projection)
+
+async def restaurant(db, params, user_id):
+    result = await run_in_threadpool(load_restaurant, db, param(params, "restaurant_id", str, required=True), user_id)
+    if not result:
+        raise HTTPException(status_code=404, detail="Restaurant not found")
+    return result
+
+async def favorites(db, params, user_id):
+    return await run_in_threadpool(load_favorites, db, require_user(user_id))
+
+async def profile(db, params, user_id):
+    return await run_in_threadpool(load_profile, db, require_user(user_id))
+
+OPERATIONS = {
+    "nearby": nearby,
+    "search": search,
+    "restaurant": restaurant,
+    "favorites": favorites,
+    "profile": profile,
+}
+
+async def run_item(item: BatchItem, user_id: Optional[str]) -> Dict[str, Any]:
+    operation = OPERATIONS.get(item.op)
+    if not operation:
+        return {"status": 400, "error": f"Unknown operation: {item.op}"}
+
+    # Sessions are not safe to share between concurrently running sub-requests
+    db = database.ReadSessionLocal()
+    try:
+        body = await operation(db, item.params, user_id)
+        return {"status": 200, "body": jsonable_encoder(body)}
+    except HTTPException as e:
+        return {"status": e.status_code, "error": e.detail}
+    except Exception:
+        # One failing sub-request must not turn the whole batch into a 500
+        logger.exception("Batch operation %s (%s) failed", item.op, item.id)
+        return {"status": 500, "error": "Internal server error"}
+    finally:
+        db.close()
+
+@router.post("/batch")
+async def batch(request: BatchRequest, authorization: Optional[str] = Header(None)):
+    if len(request.requests) > MAX_REQUESTS:
+        raise HTTPException(status_code=413, detail=f"At most {MAX_REQUESTS} requests per batch")
+
+    ids = [item.id for item in request.requests]
+    if len(set(ids)) != len(ids):
+        raise HTTPException(status_code=422, detail="Request ids must be unique")
+
+    # One token lookup for the whole batch
+    user_id = await run_in_threadpool(current_user_id, authorization)
+
+    results = await asyncio.gather(*(run_item(item, user_id) for item in request.requests))
+    return {"responses": dict(zip(ids, results))}
@@ -1,30 +1,25 @@
 from fastapi import APIRouter, Depends, HTTPException, Header
 from sqlalchemy.orm import Session
 from typing import List, Optional
+import logging
 import database
 import models
 import schemas
-import os
-import jwt
-from jwt.exceptions import PyJWTError
+from identity import resolve as resolve_identity, token_from_header
 
 router = APIRouter()
-
-# JWT verification
-JWT_SECRET = os.getenv("JWT_SECRET", "dev_secret_change_in_production")
+logger = logging.getLogger(__name__)
 
 # Verify JWT token and get user ID
 def verify_token(authorization: Optional[str] = Header(None)):
     if not authorization:
         raise HTTPException(status_code=401, detail="Not authenticated")
     
-    try:
-        # Extract token from Bearer
-        token = authorization.split("Bearer ")[1]
-        payload = jwt.decode(token, JWT_SECRET, algorithms=["HS256"])
-        return payload.get("user_id")
-    except (PyJWTError, IndexError):
+    # Decoded identities are cached per token until the token expires
+    identity = resolve_identity(token_from_header(authorization))
+    if not identity:
         raise HTTPException(status_code=401, detail="Invalid authentication token")
+    return identity.user_id
 
 # Get user favorites
 @router.get("/favorites", response_model=List[schemas.Restaurant])
@@ -32,14 +27,15 @@ def get_favorites(
     db: Session = Depends(database.get_db),
     user_id: str = Depends(verify_token)
 ):
+    return load_favorites(db, user_id)
+
+def load_favorites(db: Session, user_id: str):
     # Get user
     user = db.query(models.User).filter(models.User.id == user_id).first()
     if not user:
-        print("User not found")
+        logger.warning("Favorites requested for unknown user %s", user_id)
         return []
     
-    print(f'The user {user}')
-    
     # Get favorite restaurants
     result = []
     for restaurant in user.favorites:
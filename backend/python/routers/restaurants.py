@@ -1,112 +1,129 @@
 from fastapi import APIRouter, Depends, HTTPException, Query, Header
-from sqlalchemy.orm import Session
-from typing import List, Optional
-import database, models, schemas, sync
+from fastapi.encoders import jsonable_encoder
+from fastapi.responses import JSONResponse
+from sqlalchemy.orm import Session, joinedload
+from typing import List, Literal, Optional, Set
+from starlette.concurrency import run_in_threadpool
+import database, models, schemas, search_index, offload, geo_cells
+from identity import ensure_user, resolve as resolve_identity, token_from_header
 import uuid
 import math
 from geopy.distance import geodesic
-import jwt
-import os
-from jwt.exceptions import PyJWTError
 
 router = APIRouter()
 
-# JWT verification
-JWT_SECRET = os.getenv("JWT_SECRET", "dev_secret_change_in_production")
-
-def get_user_id_from_token(authorization: Optional[str] = Header(None)):
-    """Extract user_id and token from JWT if present, otherwise return None"""
-    if not authorization:
-        return None, None
+def current_user_id(authorization: Optional[str]) -> Optional[str]:
+    """
+    User id from the JWT if present and valid, otherwise None. For restaurant
+    endpoints authentication is optional, so invalid tokens are ignored.
+    """
+    identity = resolve_identity(token_from_header(authorization))
+    if not identity:
+        return None
+    
+    # Creates or updates the user row only when its claims changed
+    if not ensure_user(identity):
+        return None
     
-    try:
-        # Extract token from Bearer
-        token = authorization.split("Bearer ")[1]
-        payload = jwt.decode(token, JWT_SECRET, algorithms=["HS256"])
-        return payload.get("user_id"), token
-    except (PyJWTError, IndexError, ValueError):
-        # For restaurant endpoints, we don't require authentication
-        # just return None if token is invalid
-        return None, None
+    return identity.user_id
 
 # Calculate distance between two coordinates
 def calculate_distance(lat1, lon1, lat2, lon2):
     # Returns distance in meters
     return geodesic((lat1, lon1), (lat2, lon2)).meters
 
-# Get all restaurants nearby
-@router.get("/restaurants/nearby", response_model=List[schemas.Restaurant])
-def get_nearby_restaurants(
-    latitude: float,
-    longitude: float,
-    radius: int = 5000,
-    db: Session = Depends(database.get_db),
-    authorization: Optional[str] = Header(None)
-):
-    # Get user ID if authenticated
-    user_id, token = get_user_id_from_token(authorization)
-    user = None
+def favorite_ids(db: Session, user_id: Optional[str]) -> Set[str]:
+    """Ids of the user's favorite restaurants, in one query"""
+    if not user_id:
+        return set()
+    rows = db.query(models.user_favorites.c.restaurant_id).filter(
+        models.user_favorites.c.user_id == user_id
+    )
+    return {row[0] for row in rows}
+
+def load_candidates(db: Session, restaurants_query, user_id: Optional[str]):
+    """Blocking database part of a list request"""
+    # Photos come back in the same query instead of one lazy load per row
+    restaurants = restaurants_query.options(joinedload(models.Restaurant.photos)).all()
+    return restaurants, favorite_ids(db, user_id)
+
+def to_schemas(restaurants, hits, favorites: Set[str]):
+    """Convert the rows within the radius, already sorted by distance"""
+    result = []
+    for index, distance in hits:
+        restaurant = restaurants[index]
+        restaurant_data = schemas.Restaurant.from_orm(restaurant)
+        restaurant_data.distance = distance
+        restaurant_data.is_favorite = restaurant.id in favorites
+        result.append(restaurant_data)
+    return result
+
+async def build_results(db: Session, restaurants_query, latitude: float, longitude: float, radius: int, user_id: Optional[str]):
+    """Run the query on the threadpool and the distance filter off the event loop"""
+    restaurants, favorites = await run_in_threadpool(load_candidates, db, restaurants_query, user_id)
     
-    if user_id:
-        # Get user
-        user = db.query(models.User).filter(models.User.id == user_id).first()
-        if not user:
-            # Try to sync user from Go backend
-            user = sync.sync_user_from_go_backend(db, user_id, token)
+    points = [(restaurant.latitude, restaurant.longitude) for restaurant in restaurants]
+    hits = await offload.nearest(latitude, longitude, radius, points)
     
-    # Get all restaurants
-    restaurants = db.query(models.Restaurant).all()
+    return await run_in_threadpool(to_schemas, restaurants, hits, favorites)
+
+def load_cells(db: Session, latitude: float, longitude: float, radius: int, user_id: Optional[str], min_rating: Optional[int]):
+    """Blocking part of a list request answered from cached geohash cells"""
+    rows = geo_cells.cache.restaurants(db, latitude, longitude, radius)
+    if min_rating and min_rating > 0:
+        rows = [row for row in rows if row.rating >= min_rating]
+    return rows, favorite_ids(db, user_id)
+
+async def build_cell_results(db: Session, latitude: float, longitude: float, radius: int, user_id: Optional[str], min_rating: Optional[int] = None):
+    """Merge the cells covering the radius, then filter by exact distance"""
+    rows, favorites = await run_in_threadpool(load_cells, db, latitude, longitude, radius, user_id, min_rating)
     
-    # Calculate distance for each and filter by radius
-    result = []
-    for restaurant in restaurants:
-        distance = calculate_distance(
-            latitude, longitude, 
-            restaurant.latitude, restaurant.longitude
-        )
-        
-        if distance <= radius:
-            # Convert to schema
-            restaurant_data = schemas.Restaurant.from_orm(restaurant)
-            
-            # Add distance to response
-            restaurant_data.distance = distance
-            
-            # Check if restaurant is in user's favorites
-            if user:
-                restaurant_data.is_favorite = restaurant in user.favorites
-            
-            result.append(restaurant_data)
-    
-    # Sort by distance
-    result.sort(key=lambda x: x.distance)
+    points = [(row.latitude, row.longitude) for row in rows]
+    hits = await offload.nearest(latitude, longitude, radius, points)
     
-    return result
+    # Cached rows are shared between requests, so copy before setting per-request fields
+    return [
+        rows[index].copy(update={"distance": distance, "is_favorite": rows[index].id in favorites})
+        for index, distance in hits
+    ]
 
-# Search restaurants
-@router.get("/restaurants/search", response_model=List[schemas.Restaurant])
-def search_restaurants(
+# What the list and map views show; the detail view fetches the rest by id
+LIST_FIELDS = {
+    "id", "name", "address", "cuisine_type", "latitude", "longitude",
+    "rating", "is_vegan", "is_vegetarian", "distance", "is_favorite",
+}
+
+Fields = Literal["list", "detail"]
+
+def project(results, fields: str):
+    """Rows as sent for a field profile: "list" drops description, contact details and photos"""
+    if fields == "list":
+        return [jsonable_encoder(row, include=LIST_FIELDS) for row in results]
+    return results
+
+def respond(results, fields: str):
+    # Already plain data for the list profile, so skip the full-schema validation
+    if fields == "list":
+        return JSONResponse(project(results, fields))
+    return results
+
+# Get all restaurants nearby
+@router.get("/restaurants/nearby", response_model=List[schemas.Restaurant])
+async def get_nearby_restaurants(
     latitude: float,
     longitude: float,
     radius: int = 5000,
-    query: Optional[str] = None,
-    cuisine: Optional[str] = None,
-    min_rating: Optional[int] = None,
-    db: Session = Depends(database.get_db),
+    fields: Fields = "detail",
+    db: Session = Depends(database.get_read_db),
     authorization: Optional[str] = Header(None)
 ):
     # Get user ID if authenticated
-    user_id, token = get_user_id_from_token(authorization)
-    user = None
-    
-    if user_id:
-        # Get user
-        user = db.query(models.User).filter(models.User.id == user_id).first()
-        if not user:
-            # Try to sync user from Go backend
-            user = sync.sync_user_from_go_backend(db, user_id, token)
+    user_id = await run_in_threadpool(current_user_id, authorization)
     
-    # Start with all restaurants
+    return respond(await build_cell_results(db, latitude, longitude, radius, user_id), fields)
+
+def legacy_search_query(db: Session, query: Optional[str], cuisine: Optional[str], min_rating: Optional[int]):
+    """Substring scan used when the database has no search indexes"""
     restaurants_query = db.query(models.Restaurant)
     
     # Apply filters if provided
@@ -132,63 +149,80 @@ def search_restaurants(
     if query == "vegetarian":
         restaurants_query = restaurants_query.filter(models.Restaurant.is_vegetarian == True)
     
-    restaurants = restaurants_query.all()
-    
-    # Calculate distance for each and filter by radius
-    result = []
-    for restaurant in restaurants:
-        distance = calculate_distance(
-            latitude, longitude, 
-            restaurant.latitude, restaurant.longitude
-        )
-        
-        if distance <= radius:
-            # Convert to schema
-            restaurant_data = schemas.Restaurant.from_orm(restaurant)
-            
-            # Add distance to response
-            restaurant_data.distance = distance
-            
-            # Check if restaurant is in user's favorites
-            if user:
-                restaurant_data.is_favorite = restaurant in user.favorites
-            
-            result.append(restaurant_data)
-    
-    # Sort by distance
-    result.sort(key=lambda x: x.distance)
-    
-    return result
+    return restaurants_query
 
-# Get restaurant by ID
-@router.get("/restaurants/{restaurant_id}", response_model=schemas.Restaurant)
-def get_restaurant(
-    restaurant_id: str,
-    db: Session = Depends(database.get_db),
+# Search restaurants
+@router.get("/restaurants/search", response_model=List[schemas.Restaurant])
+async def search_restaurants(
+    latitude: float,
+    longitude: float,
+    radius: int = 5000,
+    query: Optional[str] = None,
+    cuisine: Optional[str] = None,
+    min_rating: Optional[int] = None,
+    fields: Fields = "detail",
+    db: Session = Depends(database.get_read_db),
     authorization: Optional[str] = Header(None)
 ):
     # Get user ID if authenticated
-    user_id, token = get_user_id_from_token(authorization)
-    user = None
+    user_id = await run_in_threadpool(current_user_id, authorization)
     
-    if user_id:
-        # Get user
-        user = db.query(models.User).filter(models.User.id == user_id).first()
-        if not user:
-            # Try to sync user from Go backend
-            user = sync.sync_user_from_go_backend(db, user_id, token)
+    return respond(await run_search(db, latitude, longitude, radius, query, cuisine, min_rating, user_id), fields)
+
+async def run_search(db: Session, latitude: float, longitude: float, radius: int, query: Optional[str], cuisine: Optional[str], min_rating: Optional[int], user_id: Optional[str]):
+    """Search once the user is known; shared with batch requests"""
+    if not query and not cuisine:
+        # No text filter: same cached cells as nearby
+        return await build_cell_results(db, latitude, longitude, radius, user_id, min_rating)
     
-    restaurant = db.query(models.Restaurant).filter(models.Restaurant.id == restaurant_id).first()
+    if search_index.is_supported(database.engine):
+        # One indexed query: R*Tree bounding box joined with the FTS match
+        restaurants_query = search_index.candidates(
+            db, latitude, longitude, radius,
+            query=query,
+            cuisine=cuisine,
+            min_rating=min_rating,
+            vegan_only=query == "vegan",
+            vegetarian_only=query == "vegetarian",
+        )
+    else:
+        restaurants_query = legacy_search_query(db, query, cuisine, min_rating)
+    
+    return await build_results(db, restaurants_query, latitude, longitude, radius, user_id)
+
+def load_restaurant(db: Session, restaurant_id: str, user_id: Optional[str]):
+    restaurant = db.query(models.Restaurant).options(
+        joinedload(models.Restaurant.photos)
+    ).filter(models.Restaurant.id == restaurant_id).first()
     
     if not restaurant:
-        raise HTTPException(status_code=404, detail="Restaurant not found")
+        return None
     
     # Convert to schema
     restaurant_data = schemas.Restaurant.from_orm(restaurant)
     
     # Check if restaurant is in user's favorites
-    if user:
-        restaurant_data.is_favorite = restaurant in user.favorites
+    if user_id:
+        restaurant_data.is_favorite = db.query(models.user_favorites).filter(
+            models.user_favorites.c.user_id == user_id,
+            models.user_favorites.c.restaurant_id == restaurant.id,
+        ).first() is not None
+    
+    return restaurant_data
+
+# Get restaurant by ID
+@router.get("/restaurants/{restaurant_id}", response_model=schemas.Restaurant)
+async def get_restaurant(
+    restaurant_id: str,
+    db: Session = Depends(database.get_read_db),
+    authorization: Optional[str] = Header(None)
+):
+    # Get user ID if authenticated
+    user_id = await run_in_threadpool(current_user_id, authorization)
+    
+    restaurant_data = await run_in_threadpool(load_restaurant, db, restaurant_id, user_id)
+    if not restaurant_data:
+        raise HTTPException(status_code=404, detail="Restaurant not found")
     
     return restaurant_data
 
@@ -0,0 +1,263 @@
+"""
+SQLite indexes for restaurant search.
+
+* restaurants_search_keys - restaurant id -> integer key
+* restaurants_fts         - FTS5 over name, description and cuisine_type
+* restaurants_rtree       - R*Tree over (latitude, longitude)
+
+Both indexes are keyed by restaurants_search_keys.key, an INTEGER PRIMARY
+KEY, rather than the implicit rowid of restaurants: VACUUM may renumber
+implicit rowids, which would leave the index pointing at other restaurants.
+Triggers keep all three in sync, so every ORM write maintains them without
+any application code.
+"""
+import math
+import re
+from typing import List, Optional, Tuple
+
+from sqlalchemy import column, text
+from sqlalchemy.engine import Engine
+from sqlalchemy.orm import Query, Session
+
+import models
+
+# Metres per degree of latitude
+METERS_PER_DEGREE = 111320.0
+
+_KEY = "(SELECT key FROM restaurants_search_keys WHERE restaurant_id = %s.id)"
+
+_SCHEMA = [
+    """
+    CREATE TABLE IF NOT EXISTS restaurants_search_keys (
+        key INTEGER PRIMARY KEY,
+        restaurant_id TEXT NOT NULL UNIQUE
+    )
+    """,
+    """
+    CREATE VIRTUAL TABLE IF NOT EXISTS restaurants_fts USING fts5(
+        name, description, cuisine_type,
+        tokenize='unicode61 remove_diacritics 2'
+    )
+    """,
+    """
+    CREATE VIRTUAL TABLE IF NOT EXISTS restaurants_rtree USING rtree(
+        id, min_lat, max_lat, min_lon, max_lon
+    )
+    """,
+    """
+    CREATE TRIGGER IF NOT EXISTS restaurants_search_ai AFTER INSERT ON restaurants BEGIN
+        INSERT INTO restaurants_search_keys(restaurant_id) VALUES (new.id);
+        INSERT INTO restaurants_fts(rowid, name, description, cuisine_type)
+        VALUES (%(new)s, new.name, new.description, new.cuisine_type);
+        INSERT INTO restaurants_rtree(id, min_lat, max_lat, min_lon, max_lon)
+        VALUES (%(new)s, new.latitude, new.latitude, new.longitude, new.longitude);
+    END
+    """ % {"new": _KEY % "new"},
+    """
+    CREATE TRIGGER IF NOT EXISTS restaurants_search_ad AFTER DELETE ON restaurants BEGIN
+        DELETE FROM restaurants_fts WHERE rowid = %(old)s;
+        DELETE FROM restaurants_rtree WHERE id = %(old)s;
+        DELETE FROM restaurants_search_keys WHERE restaurant_id = old.id;
+    END
+    """ % {"old": _KEY % "old"},
+    """
+    CREATE TRIGGER IF NOT EXISTS restaurants_search_au AFTER UPDATE ON restaurants BEGIN
+        UPDATE restaurants_search_keys SET restaurant_id = new.id WHERE restaurant_id = old.id;
+        DELETE FROM restaurants_fts WHERE rowid = %(new)s;
+        INSERT INTO restaurants_fts(rowid, name, description, cuisine_type)
+        VALUES (%(new)s, new.name, new.description, new.cuisine_type);
+        INSERT OR REPLACE INTO restaurants_rtree(id, min_lat, max_lat, min_lon, max_lon)
+        VALUES (%(new)s, new.latitude, new.latitude, new.longitude, new.longitude);
+    END
+    """ % {"new": _KEY % "new"},
+]
+
+# The first version indexed the implicit rowid of restaurants
+_LEGACY = [
+    "DROP TRIGGER IF EXISTS restaurants_index_ai",
+    "DROP TRIGGER IF EXISTS restaurants_index_ad",
+    "DROP TRIGGER IF EXISTS restaurants_index_au",
+    "DROP TABLE IF EXISTS restaurants_fts",
+    "DROP TABLE IF EXISTS restaurants_rtree",
+]
+
+
+def is_supported(engine: Engine) -> bool:
+    return engine.dialect.name == "sqlite"
+
+
+def _table_exists(conn, name: str) -> bool:
+    return conn.execute(
+        text("SELECT 1 FROM sqlite_master WHERE name = :name"), {"name": name}
+    ).first() is not None
+
+
+def _in_sync(conn) -> bool:
+    """Every restaurant has a key, and both indexes have exactly one entry per key"""
+    total = conn.execute(text("SELECT count(*) FROM restaurants")).scalar()
+    checks = [
+        "SELECT count(*) FROM restaurants_search_keys",
+        "SELECT count(*) FROM restaurants r JOIN restaurants_search_keys k ON k.restaurant_id = r.id",
+        "SELECT count(*) FROM restaurants_rtree",
+        "SELECT count(*) FROM restaurants_search_keys k JOIN restaurants_rtree t ON t.id = k.key",
+        "SELECT count(*) FROM restaurants_fts",
+        "SELECT count(*) FROM restaurants_search_keys k JOIN restaurants_fts f ON f.rowid = k.key",
+    ]
+    return all(conn.execute(text(check)).scalar() == total for check in checks)
+
+
+def _rebuild(conn) -> None:
+    conn.execute(text("DELETE FROM restaurants_fts"))
+    conn.execute(text("DELETE FROM restaurants_rtree"))
+    conn.execute(text("DELETE FROM restaurants_search_keys"))
+    conn.execute(text("INSERT INTO restaurants_search_keys(restaurant_id) SELECT id FROM restaurants"))
+    conn.execute(text(
+        "INSERT INTO restaurants_fts(rowid, name, description, cuisine_type) "
+        "SELECT k.key, r.name, r.description, r.cuisine_type "
+        "FROM restaurants r JOIN restaurants_search_keys k ON k.restaurant_id = r.id"
+    ))
+    conn.execute(text(
+        "INSERT INTO restaurants_rtree(id, min_lat, max_lat, min_lon, max_lon) "
+        "SELECT k.key, r.latitude, r.latitude, r.longitude, r.longitude "
+        "FROM restaurants r JOIN restaurants_search_keys k ON k.restaurant_id = r.id"
+    ))
+
+
+def ensure_search_index(engine: Engine) -> None:
+    """Create the index tables and triggers, and rebuild them when they do not match the table."""
+    if not is_supported(engine):
+        return
+
+    with engine.begin() as conn:
+        if not _table_exists(conn, "restaurants_search_keys"):
+            for statement in _LEGACY:
+                conn.execute(text(statement))
+
+        for statement in _SCHEMA:
+            conn.execute(text(statement))
+
+        if not _in_sync(conn):
+            _rebuild(conn)
+
+
+def bounding_box(latitude: float, longitude: float, radius: float):
+    """
+    (min_lat, max_lat, min_lon, max_lon) enclosing a circle of radius metres.
+    Longitudes are not wrapped, so near the antimeridian they run past +-180.
+    """
+    dlat = radius / METERS_PER_DEGREE
+    # Clamp near the poles where a degree of longitude shrinks to nothing
+    dlon = radius / (METERS_PER_DEGREE * max(math.cos(math.radians(latitude)), 0.01))
+    return latitude - dlat, latitude + dlat, longitude - dlon, longitude + dlon
+
+
+def longitude_ranges(min_lon: float, max_lon: float) -> List[Tuple[float, float]]:
+    """
+    The box's longitudes as ranges within [-180, 180]: one range, or two when
+    the box crosses the antimeridian.
+    """
+    if max_lon - min_lon >= 360.0:
+        return [(-180.0, 180.0)]
+    low = (min_lon + 180.0) % 360.0 - 180.0
+    high = low + (max_lon - min_lon)
+    if high <= 180.0:
+        return [(low, high)]
+    return [(low, 180.0), (-180.0, high - 360.0)]
+
+
+def _prefix_terms(value: str) -> List[str]:
+    # Quote every token so user input can never inject FTS syntax
+    return ['"%s"*' % token for token in re.findall(r"\w+", value.lower())]
+
+
+def fts_query(query: Optional[str], cuisine: Optional[str]) -> Optional[str]:
+    """Build an FTS5 MATCH expression, or None when no text filter applies"""
+    clauses = []
+    if query:
+        terms = _prefix_terms(query)
+        if terms:
+            clauses.append("{name description} : (%s)" % " AND ".join(terms))
+    if cuisine:
+        terms = _prefix_terms(cuisine)
+        if terms:
+            clauses.append("cuisine_type : (%s)" % " AND ".join(terms))
+    return " AND ".join(clauses) if clauses else None
+
+
+def candidates(
+    db: Session,
+    latitude: float,
+    longitude: float,
+    radius: float,
+    query: Optional[str] = None,
+    cuisine: Optional[str] = None,
+    min_rating: Optional[int] = None,
+    vegan_only: bool = False,
+    vegetarian_only: bool = False,
+) -> Query:
+    """
+    Query for restaurants inside the bounding box of the search circle that
+    match the text filters. The index lookup runs as a subquery, so callers can
+    still add loader options. The exact distance is left to the caller.
+    """
+    return box_candidates(
+        db, bounding_box(latitude, longitude, radius),
+        query=query,
+        cuisine=cuisine,
+        min_rating=min_rating,
+        vegan_only=vegan_only,
+        vegetarian_only=vegetarian_only,
+    )
+
+
+def box_candidates(
+    db: Session,
+    box,
+    query: Optional[str] = None,
+    cuisine: Optional[str] = None,
+    min_rating: Optional[int] = None,
+    vegan_only: bool = False,
+    vegetarian_only: bool = False,
+) -> Query:
+    """
+    Like candidates(), for an explicit (min_lat, max_lat, min_lon, max_lon)
+    box. The box may cross the antimeridian.
+    """
+    min_lat, max_lat, min_lon, max_lon = box
+    params = {
+        "min_lat": max(min_lat, -90.0),
+        "max_lat": min(max_lat, 90.0),
+    }
+    lon_tests = []
+    for index, (low, high) in enumerate(longitude_ranges(min_lon, max_lon)):
+        lon_tests.append("(t.max_lon >= :min_lon%d AND t.min_lon <= :max_lon%d)" % (index, index))
+        params["min_lon%d" % index] = low
+        params["max_lon%d" % index] = high
+
+    sql = (
+        "SELECT r.id FROM restaurants_rtree t "
+        "JOIN restaurants_search_keys k ON k.key = t.id "
+        "JOIN restaurants r ON r.id = k.restaurant_id "
+    )
+
+    match = fts_query(query, cuisine)
+    if match:
+        sql += "JOIN restaurants_fts f ON f.rowid = t.id AND restaurants_fts MATCH :match "
+        params["match"] = match
+
+    # R*Tree stores 32-bit floats, so use overlap tests rather than containment
+    sql += (
+        "WHERE t.max_lat >= :min_lat AND t.min_lat <= :max_lat "
+        "AND (%s) " % " OR ".join(lon_tests)
+    )
+
+    if min_rating and min_rating > 0:
+        sql += "AND r.rating >= :min_rating "
+        params["min_rating"] = min_rating
+    if vegan_only:
+        sql += "AND r.is_vegan = 1 "
+    if vegetarian_only:
+        sql += "AND r.is_vegetarian = 1 "
+
+    indexed = text(sql).bindparams(**params).columns(column("id"))
+    return db.query(models.Restaurant).filter(models.Restaurant.id.in_(indexed))
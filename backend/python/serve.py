@@ -0,0 +1,36 @@
+"""
+Production serving mode: several worker processes, no reloader.
+
+    python serve.py [--workers N] [--host 0.0.0.0] [--port 8000]
+
+Each worker has its own read-only SQLite pool (see database.py) and, when
+DISTANCE_WORKERS is set, its own process pool for distance batches.
+"""
+import argparse
+import os
+
+import uvicorn
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve the VegFinder API with multiple workers")
+    parser.add_argument("--host", default=os.getenv("HOST", "0.0.0.0"))
+    parser.add_argument("--port", type=int, default=int(os.getenv("PORT", "8000")))
+    parser.add_argument("--workers", type=int, default=int(os.getenv("WEB_CONCURRENCY", os.cpu_count() or 1)))
+    args = parser.parse_args()
+
+    # Workers are spawned as fresh interpreters that import main again. Prepare
+    # the database once here, then tell them to skip it so they do not race
+    # each other creating tables and rebuilding indexes.
+    import main as app_module
+    os.environ[app_module.PREPARED_ENV] = "1"
+
+    uvicorn.run(
+        "main:app",
+        host=args.host,
+        port=args.port,
+        workers=args.workers,
+        access_log=False,
+    )
+
+if __name__ == "__main__":
+    main()
@@ -3,35 +3,37 @@ from sqlalchemy.orm import Session
 import models
 import os
 import jwt
+import logging
 from datetime import datetime
+from typing import Optional
 
 # JWT secret key
 JWT_SECRET = os.getenv("JWT_SECRET", "dev_secret_change_in_production")
 
-def sync_user_from_go_backend(db: Session, user_id: str, token: str) -> models.User:
+logger = logging.getLogger(__name__)
+
+def sync_user_from_claims(
+    db: Session,
+    user_id: str,
+    username: Optional[str],
+    name: Optional[str],
+    email: Optional[str]
+) -> Optional[models.User]:
     """
-    Create user in Python backend using JWT data from Go backend
+    Create or update the user from JWT claims issued by the Go backend.
+    Only writes when the user is missing or a claim actually changed.
     Returns the user if successful, None if failed
     """
+    if not all([user_id, username, name, email]):
+        logger.warning("Missing required user data in JWT for user %s", user_id)
+        return None
+
     try:
-        # Decode JWT to get user info
-        payload = jwt.decode(token, JWT_SECRET, algorithms=["HS256"])
-        
-        # Get user data from JWT
-        username = payload.get("username")  # This is the email from Go backend
-        name = payload.get("name")         # This is the display name
-        email = payload.get("email")       # This is the email
-        
-        if not all([user_id, username, name, email]):
-            print(f"Missing required user data in JWT. user_id: {user_id}, username: {username}, name: {name}, email: {email}")
-            return None
-            
         # Check if user exists in Python backend
         user = db.query(models.User).filter(models.User.id == user_id).first()
         
         if not user:
-            print(f"Creating new user in Python backend: {username} ({name})")
-            # Create new user in Python backend
+            logger.info("Creating user %s in Python backend", user_id)
             now = datetime.utcnow()
             user = models.User(
                 id=user_id,
@@ -44,9 +46,8 @@ def sync_user_from_go_backend(db: Session, user_id: str, token: str) -> models.U
             db.add(user)
             db.commit()
             db.refresh(user)
-        else:
-            print(f"User already exists in Python backend: {username} ({name})")
-            # Update the user's information
+        elif (user.username, user.name, user.email) != (username, name, email):
+            logger.info("Updating user %s from changed JWT claims", user_id)
             user.username = username
             user.name = name
             user.email = email
@@ -57,5 +58,26 @@ def sync_user_from_go_backend(db: Session, user_id: str, token: str) -> models.U
         return user
         
     except Exception as e:
-        print(f"Error creating user from JWT: {e}")
-        return None 
\ No newline at end of file
+        db.rollback()
+        logger.error("Error syncing user %s from JWT: %s", user_id, e)
+        return None
+
+def sync_user_from_go_backend(db: Session, user_id: str, token: str) -> Optional[models.User]:
+    """
+    Create user in Python backend using JWT data from Go backend
+    Returns the user if successful, None if failed
+    """
+    try:
+        # Decode JWT to get user info
+        payload = jwt.decode(token, JWT_SECRET, algorithms=["HS256"])
+    except jwt.PyJWTError as e:
+        logger.error("Error decoding JWT: %s", e)
+        return None
+
+    return sync_user_from_claims(
+        db,
+        user_id,
+        payload.get("username"),  # This is the email from Go backend
+        payload.get("name"),      # This is the display name
+        payload.get("email")      # This is the email
+    )
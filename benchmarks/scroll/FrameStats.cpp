@@ -0,0 +1,99 @@
+#include "FrameStats.h"
+#include <QQuickWindow>
+#include <QScreen>
+#include <QtMath>
+
+FrameStats::FrameStats(QObject *parent)
+    : QObject(parent)
+    , m_frameInterval(1000.0 / 60.0)
+    , m_running(false)
+    , m_frames(0)
+    , m_droppedFrames(0)
+    , m_worstFrameMs(0.0)
+    , m_totalFrameMs(0.0)
+{
+}
+
+void FrameStats::setWindow(QQuickWindow *window)
+{
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = window;
+    if (!window) {
+        return;
+    }
+
+    const qreal refreshRate = window->screen() ? window->screen()->refreshRate() : 60.0;
+    m_frameInterval = 1000.0 / (refreshRate > 0 ? refreshRate : 60.0);
+    connect(window, &QQuickWindow::frameSwapped, this, &FrameStats::onFrameSwapped, Qt::QueuedConnection);
+}
+
+int FrameStats::frames() const
+{
+    return m_frames;
+}
+
+int FrameStats::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+double FrameStats::worstFrameMs() const
+{
+    return m_worstFrameMs;
+}
+
+double FrameStats::averageFrameMs() const
+{
+    return m_frames > 0 ? m_totalFrameMs / m_frames : 0.0;
+}
+
+void FrameStats::start()
+{
+    m_frames = 0;
+    m_droppedFrames = 0;
+    m_worstFrameMs = 0.0;
+    m_totalFrameMs = 0.0;
+    m_frameTimer.invalidate();
+    m_running = true;
+    emit updated();
+}
+
+void FrameStats::stop()
+{
+    m_running = false;
+    emit updated();
+}
+
+QString FrameStats::report() const
+{
+    return QString("frames %1, dropped %2 (%3%), average %4 ms, worst %5 ms, interval %6 ms")
+        .arg(m_frames)
+        .arg(m_droppedFrames)
+        .arg(m_frames > 0 ? 100.0 * m_droppedFrames / (m_frames + m_droppedFrames) : 0.0, 0, 'f', 1)
+        .arg(averageFrameMs(), 0, 'f', 2)
+        .arg(m_worstFrameMs, 0, 'f', 2)
+        .arg(m_frameInterval, 0, 'f', 2);
+}
+
+void FrameStats::onFrameSwapped()
+{
+    if (!m_running) {
+        return;
+    }
+    if (!m_frameTimer.isValid()) {
+        m_frameTimer.start();
+        return;
+    }
+
+    const double elapsed = m_frameTimer.nsecsElapsed() / 1.0e6;
+    m_frameTimer.restart();
+
+    ++m_frames;
+    m_totalFrameMs += elapsed;
+    m_worstFrameMs = qMax(m_worstFrameMs, elapsed);
+    // Every whole interval beyond the first is a vsync we did not present on
+    m_droppedFrames += qMax(0, qRound(elapsed / m_frameInterval) - 1);
+    emit updated();
+}
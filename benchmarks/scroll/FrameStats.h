@@ -0,0 +1,50 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <QObject>
+#include <QPointer>
+#include <QElapsedTimer>
+
+class QQuickWindow;
+
+// Counts presented and dropped frames of a window between start() and stop().
+class FrameStats : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int frames READ frames NOTIFY updated)
+    Q_PROPERTY(int droppedFrames READ droppedFrames NOTIFY updated)
+    Q_PROPERTY(double worstFrameMs READ worstFrameMs NOTIFY updated)
+    Q_PROPERTY(double averageFrameMs READ averageFrameMs NOTIFY updated)
+
+public:
+    explicit FrameStats(QObject *parent = nullptr);
+
+    void setWindow(QQuickWindow *window);
+
+    int frames() const;
+    int droppedFrames() const;
+    double worstFrameMs() const;
+    double averageFrameMs() const;
+
+    Q_INVOKABLE void start();
+    Q_INVOKABLE void stop();
+    Q_INVOKABLE QString report() const;
+
+signals:
+    void updated();
+
+private slots:
+    void onFrameSwapped();
+
+private:
+    QPointer<QQuickWindow> m_window;
+    QElapsedTimer m_frameTimer;
+    double m_frameInterval;
+    bool m_running;
+    int m_frames;
+    int m_droppedFrames;
+    double m_worstFrameMs;
+    double m_totalFrameMs;
+};
+
+#endif // FRAMESTATS_H
@@ -0,0 +1,59 @@
+import QtQuick 2.15
+import QtQuick.Window 2.15
+import "pages/components"
+
+// Scrolls the whole restaurant list at a constant fling speed and reports
+// frame statistics. Run appveg-scroll [--no-reuse].
+Window {
+    id: window
+    width: 400
+    height: 800
+    visible: true
+    title: "Scroll benchmark"
+
+    // Pixels per second; a fast fling on a phone
+    readonly property int scrollSpeed: 8000
+
+    ListView {
+        id: list
+        anchors.fill: parent
+        model: restaurantModel
+        reuseItems: benchmarkReuseItems
+        cacheBuffer: 600
+
+        delegate: RestaurantCard {
+            required property var restaurant
+
+            width: list.width
+            restaurantName: restaurant.name
+            restaurantAddress: restaurant.address
+            restaurantDistance: restaurant.distance
+            restaurantRating: restaurant.rating
+            isVegan: restaurant.isVegan
+            isVegetarian: restaurant.isVegetarian
+            isFavorite: restaurant.isFavorite
+        }
+    }
+
+    SequentialAnimation {
+        running: true
+
+        // Let the first frames and initial delegates settle
+        PauseAnimation { duration: 1000 }
+        ScriptAction { script: frameStats.start() }
+        NumberAnimation {
+            target: list
+            property: "contentY"
+            from: 0
+            to: Math.max(0, list.contentHeight - list.height)
+            duration: Math.max(1000, 1000 * (list.contentHeight - list.height) / window.scrollSpeed)
+        }
+        ScriptAction {
+            script: {
+                frameStats.stop()
+                console.log("Scrolled " + list.count + " rows, reuseItems " + list.reuseItems + ": " + frameStats.report())
+                Qt.quit()
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include <QGuiApplication>
+#include <QQmlApplicationEngine>
+#include <QQmlContext>
+#include <QQuickWindow>
+
+#include "FrameBudgetIncubator.h"
+#include "FrameStats.h"
+#include "RestaurantStore.h"
+#include "ResturantModel.h"
+
+namespace {
+// Rows spread around one point like a dense city
+QVector<Restaurant> syntheticRestaurants(int count)
+{
+    static const char *const names[] = { "Green", "Garden", "Plant", "Leaf", "Sprout", "Harvest", "Root", "Seed" };
+    QVector<Restaurant> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Restaurant restaurant;
+        restaurant.id = QString::number(i);
+        restaurant.name = QString("%1 %2 %3").arg(names[i % 8], names[(i / 8) % 8]).arg(i);
+        restaurant.address = QString("%1 Plant Street").arg(i);
+        restaurant.latitude = 37.7749 + (i % 100) * 0.001;
+        restaurant.longitude = -122.4194 + (i / 100) * 0.001;
+        restaurant.rating = i % 6;
+        restaurant.isVegan = i % 3 == 0;
+        restaurant.isVegetarian = true;
+        restaurant.distance = i * 10.0;
+        restaurant.isFavorite = i % 7 == 0;
+        restaurant.detailed = true;
+        rows.append(restaurant);
+    }
+    return rows;
+}
+}
+
+// Scrolls 5,000 synthetic rows through the app's RestaurantCard with the
+// app's incubation controller and prints frame statistics.
+//
+//     appveg-scroll [--no-reuse]
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    qRegisterMetaType<Restaurant>();
+    qRegisterMetaType<PhotoModel *>();
+
+    RestaurantStore store;
+    RestaurantModel model(&store);
+    model.setRestaurants(syntheticRestaurants(5000));
+    FrameStats frameStats;
+
+    // Must be set before the window exists, as in the app
+    FrameBudgetIncubator incubator;
+
+    QQmlApplicationEngine engine;
+    engine.setIncubationController(&incubator);
+    engine.rootContext()->setContextProperty("restaurantModel", &model);
+    engine.rootContext()->setContextProperty("frameStats", &frameStats);
+    engine.rootContext()->setContextProperty("benchmarkReuseItems", !app.arguments().contains("--no-reuse"));
+
+    const QUrl url(QStringLiteral("qrc:/ScrollBenchmark.qml"));
+    QObject::connect(
+        &engine,
+        &QQmlApplicationEngine::objectCreated,
+        &app,
+        [url](QObject *obj, const QUrl &objUrl) {
+            if (!obj && url == objUrl)
+                QCoreApplication::exit(-1);
+        },
+        Qt::QueuedConnection);
+    engine.load(url);
+
+    const QList<QObject *> roots = engine.rootObjects();
+    if (!roots.isEmpty()) {
+        if (QQuickWindow *window = qobject_cast<QQuickWindow *>(roots.first())) {
+            incubator.setWindow(window);
+            frameStats.setWindow(window);
+        }
+    }
+
+    return app.exec();
+}
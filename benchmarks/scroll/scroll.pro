@@ -0,0 +1,39 @@
+# Scroll benchmark: flings 5,000 synthetic rows through the app's list delegate
+# and reports dropped frames. Built apart from the app so it never ships in it.
+QT += quick positioning network
+
+# Same QML and language setup as AppVeg.pro, so the numbers match the app
+CONFIG += qtquickcompiler
+CONFIG += c++2a
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
+
+TARGET = appveg-scroll
+
+APP_DIR = $$PWD/../..
+INCLUDEPATH += $$APP_DIR
+
+SOURCES += \
+        main.cpp \
+        FrameStats.cpp \
+        $$APP_DIR/CatalogFile.cpp \
+        $$APP_DIR/FrameBudgetIncubator.cpp \
+        $$APP_DIR/GeoHashIndex.cpp \
+        $$APP_DIR/PhotoModel.cpp \
+        $$APP_DIR/RestaurantStore.cpp \
+        $$APP_DIR/ResturantModel.cpp \
+        $$APP_DIR/SearchIndex.cpp
+
+HEADERS += \
+    FrameStats.h \
+    $$APP_DIR/CatalogFile.h \
+    $$APP_DIR/FrameBudgetIncubator.h \
+    $$APP_DIR/GeoHashIndex.h \
+    $$APP_DIR/PhotoModel.h \
+    $$APP_DIR/RestaurantStore.h \
+    $$APP_DIR/ResturantModel.h \
+    $$APP_DIR/SearchIndex.h
+
+# The app's resources provide RestaurantCard and its icons
+RESOURCES += \
+    scroll.qrc \
+    $$APP_DIR/qml.qrc
@@ -0,0 +1,75 @@
+#include "SimulatedPositionSource.h"
+#include <QtMath>
+
+namespace {
+const int kMinimumIntervalMs = 100;
+const int kDefaultIntervalMs = 1000;
+const double kAccuracyMeters = 8.0;
+}
+
+SimulatedPositionSource::SimulatedPositionSource(const QGeoCoordinate &centre, double radiusMeters,
+                                                 double speedMetersPerSecond, QObject *parent)
+    : QGeoPositionInfoSource(parent)
+    , m_timer(new QTimer(this))
+    , m_centre(centre)
+    , m_radius(qMax(1.0, radiusMeters))
+    , m_speed(qMax(0.0, speedMetersPerSecond))
+    , m_bearing(0.0)
+{
+    m_timer->setInterval(kDefaultIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &SimulatedPositionSource::advance);
+}
+
+void SimulatedPositionSource::setUpdateInterval(int msec)
+{
+    QGeoPositionInfoSource::setUpdateInterval(qMax(kMinimumIntervalMs, msec));
+    m_timer->setInterval(updateInterval());
+}
+
+QGeoPositionInfo SimulatedPositionSource::lastKnownPosition(bool) const
+{
+    return m_last;
+}
+
+QGeoPositionInfoSource::PositioningMethods SimulatedPositionSource::supportedPositioningMethods() const
+{
+    return AllPositioningMethods;
+}
+
+int SimulatedPositionSource::minimumUpdateInterval() const
+{
+    return kMinimumIntervalMs;
+}
+
+QGeoPositionInfoSource::Error SimulatedPositionSource::error() const
+{
+    return NoError;
+}
+
+void SimulatedPositionSource::startUpdates()
+{
+    advance();
+    m_timer->start();
+}
+
+void SimulatedPositionSource::stopUpdates()
+{
+    m_timer->stop();
+}
+
+void SimulatedPositionSource::requestUpdate(int)
+{
+    // Answer asynchronously, like a real source
+    QTimer::singleShot(0, this, &SimulatedPositionSource::advance);
+}
+
+void SimulatedPositionSource::advance()
+{
+    // Arc length covered since the last fix, as an angle around the centre
+    const double seconds = m_timer->interval() / 1000.0;
+    m_bearing = std::fmod(m_bearing + qRadiansToDegrees(m_speed * seconds / m_radius), 360.0);
+
+    m_last = QGeoPositionInfo(m_centre.atDistanceAndAzimuth(m_radius, m_bearing), QDateTime::currentDateTime());
+    m_last.setAttribute(QGeoPositionInfo::HorizontalAccuracy, kAccuracyMeters);
+    emit positionUpdated(m_last);
+}
@@ -0,0 +1,42 @@
+#ifndef SIMULATEDPOSITIONSOURCE_H
+#define SIMULATEDPOSITIONSOURCE_H
+
+#include <QGeoCoordinate>
+#include <QGeoPositionInfoSource>
+#include <QTimer>
+
+// Position source for headless runs: travels a circle around a centre at a
+// steady speed and reports a fix every update interval, so LocationService
+// sees real movement (and significant moves) without any positioning plugin.
+class SimulatedPositionSource : public QGeoPositionInfoSource
+{
+    Q_OBJECT
+
+public:
+    SimulatedPositionSource(const QGeoCoordinate &centre, double radiusMeters, double speedMetersPerSecond,
+                            QObject *parent = nullptr);
+
+    void setUpdateInterval(int msec) override;
+    QGeoPositionInfo lastKnownPosition(bool fromSatellitePositioningMethodsOnly = false) const override;
+    PositioningMethods supportedPositioningMethods() const override;
+    int minimumUpdateInterval() const override;
+    Error error() const override;
+
+public slots:
+    void startUpdates() override;
+    void stopUpdates() override;
+    void requestUpdate(int timeout = 0) override;
+
+private:
+    QTimer *m_timer;
+    QGeoCoordinate m_centre;
+    double m_radius;
+    double m_speed;
+    // Bearing from the centre, advanced on every fix
+    double m_bearing;
+    QGeoPositionInfo m_last;
+
+    void advance();
+};
+
+#endif // SIMULATEDPOSITIONSOURCE_H
@@ -0,0 +1,477 @@
+#include "SoakRunner.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <QtMath>
+#include "AppController.h"
+#include "NetworkService.h"
+#include "RestaurantStore.h"
+#include "UserController.h"
+
+namespace {
+// An operation still unsettled after this is counted as failed and left behind
+const int kOperationTimeoutMs = 60000;
+const double kBucketGrowth = 1.05;
+const int kToggleCandidates = 20;
+const int kSearchRadii[] = { 2000, 5000, 10000 };
+
+QString megabytes(qint64 bytes)
+{
+    return bytes < 0 ? QString("n/a") : QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+}
+
+void SoakRunner::Histogram::add(double ms)
+{
+    const int bucket = ms < 1.0 ? 0 : 1 + int(std::log(ms) / std::log(kBucketGrowth));
+    if (bucket >= m_buckets.size()) {
+        m_buckets.resize(bucket + 1);
+    }
+    m_buckets[bucket]++;
+    m_count++;
+    m_max = qMax(m_max, ms);
+}
+
+double SoakRunner::Histogram::percentile(double p) const
+{
+    if (m_count == 0) {
+        return 0.0;
+    }
+    const int target = qMax(1, qCeil(p * m_count));
+    int seen = 0;
+    for (int bucket = 0; bucket < m_buckets.size(); ++bucket) {
+        seen += m_buckets.at(bucket);
+        if (seen >= target) {
+            // Upper edge of the bucket, never above what was actually seen
+            return qMin(bucket == 0 ? 1.0 : std::pow(kBucketGrowth, bucket), m_max);
+        }
+    }
+    return m_max;
+}
+
+int SoakRunner::Histogram::count() const
+{
+    return m_count;
+}
+
+double SoakRunner::Histogram::max() const
+{
+    return m_max;
+}
+
+SoakRunner::SoakRunner(AppController *app, UserController *user, RestaurantStore *store, NetworkService *network,
+                       const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_app(app)
+    , m_user(user)
+    , m_store(store)
+    , m_network(network)
+    , m_options(options)
+    , m_nextTimer(new QTimer(this))
+    , m_reportTimer(new QTimer(this))
+    , m_watchdog(new QTimer(this))
+    , m_current(None)
+    , m_operationStartedMs(0)
+    , m_operationFailed(false)
+    , m_sequence(0)
+    , m_loggingIn(false)
+    , m_stopped(false)
+    , m_peakRss(-1)
+{
+    if (m_options.queries.isEmpty()) {
+        m_options.queries = QStringList{ "vegan", "vegetarian", "thai", "pizza", "burger", "cafe" };
+    }
+
+    m_nextTimer->setSingleShot(true);
+    m_nextTimer->setInterval(qMax(0, m_options.intervalMs));
+    connect(m_nextTimer, &QTimer::timeout, this, &SoakRunner::next);
+
+    m_reportTimer->setInterval(qMax(1, m_options.reportSeconds) * 1000);
+    connect(m_reportTimer, &QTimer::timeout, this, [this]() {
+        sampleMemory();
+        printProgress();
+    });
+
+    m_watchdog->setSingleShot(true);
+    m_watchdog->setInterval(kOperationTimeoutMs);
+    connect(m_watchdog, &QTimer::timeout, this, &SoakRunner::onTimeout);
+
+    connect(m_app, &AppController::loadingChanged, this, &SoakRunner::onLoadingChanged);
+    connect(m_app, &AppController::errorChanged, this, &SoakRunner::onErrorChanged);
+    connect(m_user, &UserController::authStateChanged, this, &SoakRunner::onAuthStateChanged);
+    connect(m_user, &UserController::errorMessageChanged, this, &SoakRunner::onLoginError);
+    connect(m_user->actionQueue(), &ActionQueue::actionCompleted, this,
+            [this](const QString &, const QByteArray &method, const QUrl &url, const QByteArray &) {
+                onActionDone(method, url, false);
+            });
+    connect(m_user->actionQueue(), &ActionQueue::actionRejected, this,
+            [this](const QString &, const QByteArray &method, const QUrl &url, const QString &) {
+                onActionDone(method, url, true);
+            });
+}
+
+void SoakRunner::start()
+{
+    m_clock.start();
+    m_reportTimer->start();
+    if (m_options.durationSeconds > 0) {
+        QTimer::singleShot(m_options.durationSeconds * 1000, this, &SoakRunner::stop);
+    }
+
+    if (!m_options.username.isEmpty() && !m_user->isLoggedIn()) {
+        login();
+        return;
+    }
+    m_nextTimer->start();
+}
+
+void SoakRunner::login()
+{
+    m_loggingIn = true;
+    m_user->login(m_options.username, m_options.password);
+}
+
+void SoakRunner::onAuthStateChanged()
+{
+    if (!m_loggingIn || !m_user->isLoggedIn()) {
+        return;
+    }
+    m_loggingIn = false;
+    qInfo().noquote() << "soak: logged in as" << m_user->username();
+    m_nextTimer->start();
+}
+
+void SoakRunner::onLoginError()
+{
+    if (!m_loggingIn || m_user->errorMessage().isEmpty()) {
+        return;
+    }
+    // Searches and refreshes still run; favorite toggles need a session
+    m_loggingIn = false;
+    qWarning().noquote() << "soak: login failed:" << m_user->errorMessage() << "- running without favorites";
+    m_user->clearError();
+    m_nextTimer->start();
+}
+
+void SoakRunner::next()
+{
+    if (m_stopped || m_current != None) {
+        return;
+    }
+
+    // Mostly list traffic, like a user browsing; every fourth operation a favorite
+    static const Operation pattern[] = { Search, Refresh, Search, ToggleFavorite };
+    const Operation operation = pattern[m_sequence++ % 4];
+
+    bool started = false;
+    if (operation == Search) {
+        started = runSearch();
+    } else if (operation == ToggleFavorite) {
+        started = runToggleFavorite();
+    }
+    if (!started) {
+        started = runRefresh();
+    }
+
+    // No position yet: wait for the first fix
+    if (!started) {
+        m_nextTimer->start();
+    }
+}
+
+bool SoakRunner::runSearch()
+{
+    if (!m_app->hasLocation()) {
+        return false;
+    }
+
+    m_current = Search;
+    m_operationStartedMs = m_clock.elapsed();
+    m_operationFailed = false;
+    m_watchdog->start();
+
+    const QString query = m_options.queries.at(m_sequence % m_options.queries.size());
+    m_app->searchRestaurants(query, kSearchRadii[m_sequence % 3]);
+
+    // A fresh cached answer settles without ever loading
+    if (m_current == Search && !m_app->loading()) {
+        finishOperation(m_operationFailed, true);
+    }
+    return true;
+}
+
+bool SoakRunner::runRefresh()
+{
+    if (!m_app->hasLocation()) {
+        return false;
+    }
+
+    m_current = Refresh;
+    m_operationStartedMs = m_clock.elapsed();
+    m_operationFailed = false;
+    m_watchdog->start();
+
+    m_app->refreshRestaurants();
+
+    if (m_current == Refresh && !m_app->loading()) {
+        finishOperation(m_operationFailed, true);
+    }
+    return true;
+}
+
+bool SoakRunner::runToggleFavorite()
+{
+    RestaurantModel *model = m_app->restaurantModel();
+    if (!m_user->isLoggedIn() || model->count() == 0) {
+        return false;
+    }
+
+    const QStringList ids = model->ids(0, qMin(model->count(), kToggleCandidates) - 1);
+    if (ids.isEmpty()) {
+        return false;
+    }
+    const QString id = ids.at(QRandomGenerator::global()->bounded(ids.size()));
+    const bool favorite = m_store->isFavorite(id);
+
+    m_current = ToggleFavorite;
+    m_operationStartedMs = m_clock.elapsed();
+    m_operationFailed = false;
+    m_watchdog->start();
+
+    // Settles when the action queue has delivered the change
+    m_sentActions.enqueue({ favorite ? QByteArray("DELETE") : QByteArray("POST"), id });
+    if (favorite) {
+        m_user->removeFromFavorites(id);
+    } else {
+        m_user->addToFavorites(id);
+    }
+    return true;
+}
+
+void SoakRunner::finishOperation(bool failed, bool local)
+{
+    if (m_current == None) {
+        return;
+    }
+    m_watchdog->stop();
+
+    Stats &stats = m_stats[m_current];
+    if (failed) {
+        stats.failures++;
+    } else {
+        stats.latency.add(m_clock.elapsed() - m_operationStartedMs);
+        if (local) {
+            stats.local++;
+        }
+    }
+
+    m_current = None;
+    if (!m_stopped) {
+        m_nextTimer->start();
+    }
+}
+
+void SoakRunner::onLoadingChanged()
+{
+    if ((m_current == Search || m_current == Refresh) && !m_app->loading()) {
+        // Served from the offline cache after a failed request counts as failed
+        finishOperation(m_operationFailed || m_app->offline());
+    }
+}
+
+void SoakRunner::onErrorChanged()
+{
+    if (m_app->error().isEmpty()) {
+        return;
+    }
+    if (m_current == Search || m_current == Refresh) {
+        m_operationFailed = true;
+    }
+    m_app->clearError();
+}
+
+void SoakRunner::onActionDone(const QByteArray &method, const QUrl &url, bool failed)
+{
+    if (m_sentActions.isEmpty()) {
+        return;
+    }
+
+    // Actions journaled by an earlier run are delivered too; only ours are timed
+    const SentAction &head = m_sentActions.head();
+    const bool ours = method == head.method
+                      && (method == "POST" || url.path().endsWith("/favorites/" + head.restaurantId));
+    if (!ours) {
+        return;
+    }
+    m_sentActions.dequeue();
+
+    // Earlier toggles the watchdog gave up on drain first
+    if (m_current == ToggleFavorite && m_sentActions.isEmpty()) {
+        finishOperation(failed);
+    }
+}
+
+void SoakRunner::onTimeout()
+{
+    if (m_current == None) {
+        return;
+    }
+    qWarning().noquote() << "soak:" << nameOf(m_current) << "did not settle within" << kOperationTimeoutMs << "ms";
+    finishOperation(true);
+}
+
+void SoakRunner::sampleMemory()
+{
+    const qint64 rss = residentBytes();
+    if (rss < 0) {
+        return;
+    }
+    m_rssSamples.append(qMakePair(m_clock.elapsed(), rss));
+    m_peakRss = qMax(m_peakRss, rss);
+}
+
+void SoakRunner::printProgress()
+{
+    qInfo().noquote() << report();
+}
+
+void SoakRunner::stop()
+{
+    if (m_stopped) {
+        return;
+    }
+    m_stopped = true;
+    m_nextTimer->stop();
+    m_reportTimer->stop();
+    m_watchdog->stop();
+
+    sampleMemory();
+    emit finished();
+}
+
+int SoakRunner::completed() const
+{
+    int total = 0;
+    for (const Stats &stats : m_stats) {
+        total += stats.latency.count() + stats.failures;
+    }
+    return total;
+}
+
+QString SoakRunner::report() const
+{
+    const double seconds = m_clock.elapsed() / 1000.0;
+    QStringList lines;
+    lines << QString("soak: %1 s, %2 operations, %3 ops/s")
+                 .arg(seconds, 0, 'f', 0)
+                 .arg(completed())
+                 .arg(seconds > 0.0 ? completed() / seconds : 0.0, 0, 'f', 2);
+
+    for (int operation = 0; operation < OperationCount; ++operation) {
+        const Stats &stats = m_stats[operation];
+        lines << QString("  %1 n=%2  p50 %3 ms  p90 %4 ms  p99 %5 ms  max %6 ms  failed %7  cached %8")
+                     .arg(nameOf(Operation(operation)), -9)
+                     .arg(stats.latency.count())
+                     .arg(stats.latency.percentile(0.50), 0, 'f', 0)
+                     .arg(stats.latency.percentile(0.90), 0, 'f', 0)
+                     .arg(stats.latency.percentile(0.99), 0, 'f', 0)
+                     .arg(stats.latency.max(), 0, 'f', 0)
+                     .arg(stats.failures)
+                     .arg(stats.local);
+    }
+
+    const NetworkHealth *health = m_network->health();
+    lines << QString("  network   %1 requests, %2 retries, %3 refused by open circuits")
+                 .arg(health->requests())
+                 .arg(health->retries())
+                 .arg(health->rejected());
+
+    if (!m_rssSamples.isEmpty()) {
+        const QPair<qint64, qint64> &first = m_rssSamples.first();
+        const QPair<qint64, qint64> &last = m_rssSamples.last();
+        const double hours = (last.first - first.first) / 3600000.0;
+        QString growth = QString("%1%2 since warm-up")
+                             .arg(last.second >= first.second ? "+" : "-")
+                             .arg(megabytes(qAbs(last.second - first.second)));
+        if (hours > 0.0) {
+            growth += QString(", %1 MB/h").arg((last.second - first.second) / (1024.0 * 1024.0) / hours, 0, 'f', 2);
+        }
+        lines << QString("  memory    rss %1, peak %2, %3").arg(megabytes(last.second), megabytes(m_peakRss), growth);
+    }
+    return lines.join('\n');
+}
+
+QJsonObject SoakRunner::toJson() const
+{
+    const double seconds = m_clock.elapsed() / 1000.0;
+
+    QJsonObject operations;
+    for (int operation = 0; operation < OperationCount; ++operation) {
+        const Stats &stats = m_stats[operation];
+        QJsonObject entry;
+        entry["count"] = stats.latency.count();
+        entry["failures"] = stats.failures;
+        entry["cached"] = stats.local;
+        entry["p50Ms"] = stats.latency.percentile(0.50);
+        entry["p90Ms"] = stats.latency.percentile(0.90);
+        entry["p99Ms"] = stats.latency.percentile(0.99);
+        entry["maxMs"] = stats.latency.max();
+        operations[nameOf(Operation(operation))] = entry;
+    }
+
+    const NetworkHealth *health = m_network->health();
+    QJsonObject network;
+    network["requests"] = health->requests();
+    network["retries"] = health->retries();
+    network["rejected"] = health->rejected();
+
+    QJsonArray samples;
+    for (const auto &sample : m_rssSamples) {
+        samples.append(QJsonArray{ double(sample.first), double(sample.second) });
+    }
+    QJsonObject memory;
+    memory["peakBytes"] = double(m_peakRss);
+    memory["samples"] = samples;
+
+    QJsonObject result;
+    result["seconds"] = seconds;
+    result["operations"] = completed();
+    result["throughput"] = seconds > 0.0 ? completed() / seconds : 0.0;
+    result["latency"] = operations;
+    result["network"] = network;
+    result["memory"] = memory;
+    return result;
+}
+
+QString SoakRunner::nameOf(Operation operation)
+{
+    switch (operation) {
+    case Search:
+        return "search";
+    case Refresh:
+        return "refresh";
+    case ToggleFavorite:
+        return "favorite";
+    default:
+        return QString();
+    }
+}
+
+qint64 SoakRunner::residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    // "VmRSS:     12345 kB"
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,129 @@
+#ifndef SOAKRUNNER_H
+#define SOAKRUNNER_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QQueue>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+#include <QPair>
+#include <QVector>
+
+class AppController;
+class UserController;
+class RestaurantStore;
+class NetworkService;
+
+// Drives the controllers the way a user would, one operation at a time:
+// searches, nearby refreshes and favorite toggles, with a pause between
+// them. Each operation is timed from the call until the controller has
+// settled (the list stopped loading, the favorite reached the backend), and
+// resident memory is sampled at every report to show growth over long runs.
+class SoakRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int durationSeconds = 600;
+        int intervalMs = 200;
+        int reportSeconds = 60;
+        QString username;
+        QString password;
+        QStringList queries;
+    };
+
+    SoakRunner(AppController *app, UserController *user, RestaurantStore *store, NetworkService *network,
+               const Options &options, QObject *parent = nullptr);
+
+    QString report() const;
+    QJsonObject toJson() const;
+
+public slots:
+    void start();
+
+signals:
+    void finished();
+
+private:
+    enum Operation {
+        None = -1,
+        Search,
+        Refresh,
+        ToggleFavorite,
+        OperationCount
+    };
+
+    // Log-spaced buckets, 5% wide: constant memory however long the run, so
+    // the statistics do not show up in the memory growth they measure
+    class Histogram
+    {
+    public:
+        void add(double ms);
+        double percentile(double p) const;
+        int count() const;
+        double max() const;
+
+    private:
+        QVector<int> m_buckets;
+        int m_count = 0;
+        double m_max = 0.0;
+    };
+
+    struct Stats {
+        Histogram latency;
+        int failures = 0;
+        // Answered from the offline cache without a request
+        int local = 0;
+    };
+
+    struct SentAction {
+        QByteArray method;
+        QString restaurantId;
+    };
+
+    AppController *m_app;
+    UserController *m_user;
+    RestaurantStore *m_store;
+    NetworkService *m_network;
+    Options m_options;
+    QElapsedTimer m_clock;
+    QTimer *m_nextTimer;
+    QTimer *m_reportTimer;
+    QTimer *m_watchdog;
+    Stats m_stats[OperationCount];
+    Operation m_current;
+    qint64 m_operationStartedMs;
+    bool m_operationFailed;
+    int m_sequence;
+    bool m_loggingIn;
+    bool m_stopped;
+    // Favorite changes handed to the action queue, in delivery order
+    QQueue<SentAction> m_sentActions;
+    // (run time ms, resident bytes) at every report; the first is the warmed-up baseline
+    QVector<QPair<qint64, qint64>> m_rssSamples;
+    qint64 m_peakRss;
+
+    void next();
+    void login();
+    void onAuthStateChanged();
+    void onLoginError();
+    bool runSearch();
+    bool runRefresh();
+    bool runToggleFavorite();
+    void finishOperation(bool failed, bool local = false);
+    void onLoadingChanged();
+    void onErrorChanged();
+    void onActionDone(const QByteArray &method, const QUrl &url, bool failed);
+    void onTimeout();
+    void sampleMemory();
+    void printProgress();
+    void stop();
+    int completed() const;
+    static QString nameOf(Operation operation);
+    static qint64 residentBytes();
+};
+
+#endif // SOAKRUNNER_H
@@ -0,0 +1,122 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QNmeaPositionInfoSource>
+#include <QTimer>
+#include <QDebug>
+
+#include "AppController.h"
+#include "LocationService.h"
+#include "NetworkService.h"
+#include "RestaurantStore.h"
+#include "TokenManager.h"
+#include "UserController.h"
+#include "SimulatedPositionSource.h"
+#include "SoakRunner.h"
+
+// Headless soak and throughput run: the app's controllers without QML or a
+// window, fed by a simulated (or recorded NMEA) position, driven in a loop
+// against the backend given on the command line.
+//
+//     appveg-soak --api http://staging:8000/api --auth http://staging:8085/auth \
+//                 --user soak --password secret --duration 3600 --json soak.json
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Own settings, offline caches and action journal; never the app's
+    QCoreApplication::setApplicationName("AppVegSoak");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs searches, refreshes and favorite toggles in a loop and reports "
+                                     "throughput, latency percentiles and memory growth.");
+    parser.addHelpOption();
+    const QCommandLineOption apiOption("api", "Restaurant API base URL.", "url", "http://localhost:8000/api");
+    const QCommandLineOption authOption("auth", "Auth service base URL.", "url", "http://localhost:8085/auth");
+    const QCommandLineOption userOption("user", "Log in as this user to exercise favorites.", "name");
+    const QCommandLineOption passwordOption("password", "Password for --user.", "password");
+    const QCommandLineOption latitudeOption("latitude", "Centre of the simulated route.", "degrees", "37.7749");
+    const QCommandLineOption longitudeOption("longitude", "Centre of the simulated route.", "degrees", "-122.4194");
+    const QCommandLineOption radiusOption("route-radius", "Radius of the simulated route.", "meters", "2000");
+    const QCommandLineOption speedOption("speed", "Speed along the simulated route.", "m/s", "15");
+    const QCommandLineOption nmeaOption("nmea", "Replay a recorded NMEA log instead of the simulated route.", "file");
+    const QCommandLineOption catalogOption("catalog", "Offline city catalog to open.", "file");
+    const QCommandLineOption queriesOption("queries", "Comma-separated search terms.", "terms");
+    const QCommandLineOption durationOption("duration", "Run time; 0 runs until killed.", "seconds", "600");
+    const QCommandLineOption intervalOption("interval", "Pause between operations.", "ms", "200");
+    const QCommandLineOption reportOption("report", "Progress report interval.", "seconds", "60");
+    const QCommandLineOption jsonOption("json", "Write the final report as JSON to this file.", "file");
+    parser.addOptions({ apiOption, authOption, userOption, passwordOption, latitudeOption, longitudeOption,
+                        radiusOption, speedOption, nmeaOption, catalogOption, queriesOption, durationOption,
+                        intervalOption, reportOption, jsonOption });
+    parser.process(app);
+
+    NetworkService networkService;
+
+    RestaurantStore restaurantStore;
+    if (parser.isSet(catalogOption) && QFileInfo::exists(parser.value(catalogOption))) {
+        restaurantStore.openCatalog(parser.value(catalogOption));
+    }
+
+    TokenManager tokenManager(&networkService);
+    tokenManager.setAuthUrl(parser.value(authOption));
+    UserController userController(&networkService, &restaurantStore, &tokenManager);
+    userController.setAuthUrl(parser.value(authOption));
+    userController.setApiUrl(parser.value(apiOption));
+
+    // The route stands in for the platform source LocationService would create
+    LocationService locationService;
+    if (parser.isSet(nmeaOption)) {
+        QNmeaPositionInfoSource *nmea = new QNmeaPositionInfoSource(QNmeaPositionInfoSource::SimulationMode);
+        QFile *log = new QFile(parser.value(nmeaOption), nmea);
+        if (!log->open(QIODevice::ReadOnly)) {
+            qCritical().noquote() << "soak: cannot open" << log->fileName();
+            return 1;
+        }
+        nmea->setDevice(log);
+        locationService.setSource(nmea);
+    } else {
+        const QGeoCoordinate centre(parser.value(latitudeOption).toDouble(), parser.value(longitudeOption).toDouble());
+        locationService.setSource(new SimulatedPositionSource(centre, parser.value(radiusOption).toDouble(),
+                                                              parser.value(speedOption).toDouble()));
+    }
+
+    AppController appController(&networkService, &restaurantStore, &locationService, &tokenManager);
+    appController.setBaseUrl(parser.value(apiOption));
+    appController.setLocationPermissionGranted(true);
+
+    SoakRunner::Options options;
+    options.durationSeconds = parser.value(durationOption).toInt();
+    options.intervalMs = parser.value(intervalOption).toInt();
+    options.reportSeconds = parser.value(reportOption).toInt();
+    options.username = parser.value(userOption);
+    options.password = parser.value(passwordOption);
+    if (parser.isSet(queriesOption)) {
+        options.queries = parser.value(queriesOption).split(',', Qt::SkipEmptyParts);
+    }
+
+    SoakRunner runner(&appController, &userController, &restaurantStore, &networkService, options);
+    const QString jsonPath = parser.value(jsonOption);
+    QObject::connect(&runner, &SoakRunner::finished, &app, [&]() {
+        qInfo().noquote() << runner.report();
+        if (!jsonPath.isEmpty()) {
+            QFile file(jsonPath);
+            if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                file.write(QJsonDocument(runner.toJson()).toJson());
+            } else {
+                qWarning().noquote() << "soak: cannot write" << jsonPath;
+            }
+        }
+        app.quit();
+    });
+
+    // Same order as the app after its first frame: positioning and connections, then traffic
+    QTimer::singleShot(0, &app, [&]() {
+        appController.startDeferred();
+        userController.startDeferred();
+        runner.start();
+    });
+
+    return app.exec();
+}
@@ -0,0 +1,58 @@
+# Headless soak and throughput run of the app's controllers: no QML, no window,
+# so it runs on CI machines. See main.cpp for the options.
+QT = core network positioning
+
+CONFIG += console
+CONFIG -= app_bundle
+
+# Same language setup as AppVeg.pro: network flows are C++20 coroutines
+CONFIG += c++2a
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
+
+TARGET = appveg-soak
+
+APP_DIR = $$PWD/../..
+INCLUDEPATH += $$APP_DIR
+
+SOURCES += \
+        main.cpp \
+        SimulatedPositionSource.cpp \
+        SoakRunner.cpp \
+        $$APP_DIR/ActionQueue.cpp \
+        $$APP_DIR/ApiBatch.cpp \
+        $$APP_DIR/AppController.cpp \
+        $$APP_DIR/AsyncReply.cpp \
+        $$APP_DIR/CatalogFile.cpp \
+        $$APP_DIR/GeoHashIndex.cpp \
+        $$APP_DIR/LocationService.cpp \
+        $$APP_DIR/NetworkHealth.cpp \
+        $$APP_DIR/NetworkService.cpp \
+        $$APP_DIR/OfflineCache.cpp \
+        $$APP_DIR/PhotoModel.cpp \
+        $$APP_DIR/PrefetchEngine.cpp \
+        $$APP_DIR/RestaurantStore.cpp \
+        $$APP_DIR/ResturantModel.cpp \
+        $$APP_DIR/SearchIndex.cpp \
+        $$APP_DIR/TokenManager.cpp \
+        $$APP_DIR/UserController.cpp
+
+HEADERS += \
+    SimulatedPositionSource.h \
+    SoakRunner.h \
+    $$APP_DIR/ActionQueue.h \
+    $$APP_DIR/ApiBatch.h \
+    $$APP_DIR/AppController.h \
+    $$APP_DIR/AsyncReply.h \
+    $$APP_DIR/CatalogFile.h \
+    $$APP_DIR/GeoHashIndex.h \
+    $$APP_DIR/LocationService.h \
+    $$APP_DIR/NetworkHealth.h \
+    $$APP_DIR/NetworkService.h \
+    $$APP_DIR/OfflineCache.h \
+    $$APP_DIR/PhotoModel.h \
+    $$APP_DIR/PrefetchEngine.h \
+    $$APP_DIR/RestaurantStore.h \
+    $$APP_DIR/ResturantModel.h \
+    $$APP_DIR/SearchIndex.h \
+    $$APP_DIR/TokenManager.h \
+    $$APP_DIR/UserController.h
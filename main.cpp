@@ -8,14 +8,49 @@
 
 #include "UserController.h"
 #include "ResturantModel.h"
+#include "RestaurantStore.h"
 #include "AppController.h"
+#include "LocationService.h"
+#include "NetworkService.h"
+#include "DetailService.h"
+#include "ImageService.h"
+#include "RemoteImageProvider.h"
+#include "FrameBudgetIncubator.h"
+#include "StartupTimeline.h"
+#include "StartupOrchestrator.h"
+#include "TokenManager.h"
+#include <QTimer>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+// Offline city catalog: --catalog <file>, else catalog.vcat in the app data directory
+QString catalogPath(const QStringList &arguments)
+{
+    const int flag = arguments.indexOf("--catalog");
+    if (flag >= 0 && flag + 1 < arguments.size()) {
+        return arguments.at(flag + 1);
+    }
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/catalog.vcat";
+}
+}
 
 int main(int argc, char *argv[])
 {
+    // Started first so every milestone is relative to process start
+    StartupTimeline timeline;
+
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 #endif
     QGuiApplication app(argc, argv);
+    timeline.setVerbose(app.arguments().contains("--startup-timeline"));
+    timeline.mark("application");
+
+    // Delegates read whole rows as Restaurant gadgets
+    qRegisterMetaType<Restaurant>();
+    qRegisterMetaType<PhotoModel *>();
 
     QTranslator translator;
     const QStringList uiLanguages = QLocale::system().uiLanguages();
@@ -27,17 +62,51 @@ int main(int argc, char *argv[])
         }
     }
 
+    // One network layer shared by all controllers
+    NetworkService networkService;
+    QObject::connect(&app, &QGuiApplication::applicationStateChanged, &networkService,
+                     [&networkService](Qt::ApplicationState state) {
+                         // Losing focus or an overlay (Inactive) is not going to the background
+                         networkService.setBackgrounded(state == Qt::ApplicationSuspended
+                                                        || state == Qt::ApplicationHidden);
+                     });
+
+    // Every restaurant is held once here; controllers and views only keep ids
+    RestaurantStore restaurantStore;
+    // Mapping is cheap: rows are decoded only when a view asks for them
+    const QString catalog = catalogPath(app.arguments());
+    if (QFileInfo::exists(catalog)) {
+        restaurantStore.openCatalog(catalog);
+    }
+    timeline.mark("catalog");
+
     // Instantiate your C++ controller classes
-    UserController userController;
-    RestaurantModel restaurantModel;
-    AppController appController;
+    // One session token for every controller; migrates the old per-controller settings keys
+    TokenManager tokenManager(&networkService);
+    UserController userController(&networkService, &restaurantStore, &tokenManager);
+    // Starts from the last saved position; the position source itself is created after the first frame
+    LocationService locationService;
+    AppController appController(&networkService, &restaurantStore, &locationService, &tokenManager);
+    ImageService imageService(&networkService);
+    DetailService detailService(&networkService, &restaurantStore, &tokenManager);
+    StartupOrchestrator startup(&networkService, &tokenManager, &appController, &userController, &timeline);
+    timeline.mark("controllers");
+
+    // Spread async delegate creation over frames; must be set before the window exists
+    FrameBudgetIncubator incubator;
 
     // Set context properties so QML can access them
     QQmlApplicationEngine engine;
+    engine.setIncubationController(&incubator);
+    engine.addImageProvider("remote", new RemoteImageProvider(&imageService));
     engine.rootContext()->setContextProperty("userController", &userController);
-    engine.rootContext()->setContextProperty("restaurantModel", &restaurantModel);
+    engine.rootContext()->setContextProperty("restaurantStore", &restaurantStore);
+    engine.rootContext()->setContextProperty("restaurantModel", appController.restaurantModel());
     engine.rootContext()->setContextProperty("appController", &appController);
-
+    engine.rootContext()->setContextProperty("detailService", &detailService);
+    engine.rootContext()->setContextProperty("startup", &startup);
+    engine.rootContext()->setContextProperty("networkHealth", networkService.health());
+    engine.rootContext()->setContextProperty("networkDebug", app.arguments().contains("--network-debug"));
 
     const QUrl url(QStringLiteral("qrc:/main.qml"));
     QObject::connect(
@@ -50,6 +119,7 @@ int main(int argc, char *argv[])
         },
         Qt::QueuedConnection);
     engine.load(url);
+    timeline.mark("qml loaded");
 
     // 🔽 Set minimum window size after loading the QML
     const QList<QObject *> roots = engine.rootObjects();
@@ -59,8 +129,23 @@ int main(int argc, char *argv[])
         if (window) {
             window->setMinimumWidth(400);
             window->setMinimumHeight(600);
+            incubator.setWindow(window);
+            timeline.watchFirstFrame(window);
         }
     }
 
+    // Everything not needed for the first frame starts once it is on screen
+    QObject::connect(&timeline, &StartupTimeline::firstFrameSwapped, &app, [&]() {
+        QTimer::singleShot(0, &app, [&]() {
+            startup.start();
+            timeline.mark("deferred init");
+        });
+    });
+    if (app.arguments().contains("--startup-timeline")) {
+        QObject::connect(&startup, &StartupOrchestrator::finishedChanged, &app, [&]() {
+            qInfo().noquote() << "startup timeline:" << timeline.report();
+        });
+    }
+
     return app.exec();
 }
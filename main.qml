@@ -25,8 +25,8 @@ ApplicationWindow {
         appController.initialize()
 
         if (userController.isLoggedIn) {
+            // Profile, favorites and nearby are fetched together after the first frame
             console.log("Loading home page")
-            userController.getFavorites()
             stackView.push(homeComponent)
         } else {
             console.log("Loading login page")
@@ -42,36 +42,17 @@ ApplicationWindow {
             console.log("Auth state changed, isLoggedIn:", userController.isLoggedIn)
             if (userController.isLoggedIn) {
                 // If we're not already on the home page, navigate there
+                // Login already fetches the profile and favorites
                 if (stackView.currentItem !== homeComponent) {
                     stackView.push(homeComponent)
                 }
-                userController.getFavorites()
             }
         }
     }
 
-    // Connect to favorite signals
+    // Favorite toggles from any page go through the shared store
     Connections {
-        target: userController
-        function onFavoritesUpdated(favoriteIds) {
-            // Update restaurant model with favorite status
-            for (var i = 0; i < favoriteIds.length; i++) {
-                restaurantModel.setFavoriteStatus(favoriteIds[i], true)
-            }
-        }
-
-        function onFavoriteAdded(restaurantId) {
-            restaurantModel.setFavoriteStatus(restaurantId, true)
-        }
-
-        function onFavoriteRemoved(restaurantId) {
-            restaurantModel.setFavoriteStatus(restaurantId, false)
-        }
-    }
-
-    // Connect to restaurant model favorite toggle
-    Connections {
-        target: restaurantModel
+        target: restaurantStore
         function onFavoriteToggled(id, isFavorite) {
             if (isLoggedIn) {
                 if (isFavorite) {
@@ -81,7 +62,7 @@ ApplicationWindow {
                 }
             } else {
                 // If not logged in, revert the toggle and show login prompt
-                restaurantModel.setFavoriteStatus(id, false)
+                restaurantStore.setFavorite(id, false)
                 loginPromptDialog.open()
             }
         }
@@ -119,27 +100,41 @@ ApplicationWindow {
         }
     }
 
-    // Restaurant detail component
+    // Restaurant detail component, loaded on first use
     Component {
         id: restaurantDetailComponent
-        RestaurantDetail {
-            restaurantId: currentRestaurantId
-            onBackClicked: stackView.pop()
-            onShowOnMap: {
-                stackView.pop()
-                stackView.push(mapComponent, { focusRestaurantId: currentRestaurantId })
+        PageLoader {
+            id: detailLoader
+            page: "pages/RestaurantDetail.qml"
+            pageProperties: ({ restaurantId: currentRestaurantId })
+
+            Connections {
+                target: detailLoader.item
+                function onBackClicked() { stackView.pop() }
+                function onShowOnMap() {
+                    stackView.pop()
+                    stackView.push(mapComponent, { focusRestaurantId: currentRestaurantId })
+                }
             }
         }
     }
 
-    // Map component
+    // Map component; QtLocation is only loaded when the map is first opened
     Component {
         id: mapComponent
-        MapView {
-            onBackClicked: stackView.pop()
-            onRestaurantSelected: {
-                currentRestaurantId = restaurantId
-                stackView.push(restaurantDetailComponent)
+        PageLoader {
+            id: mapLoader
+            property string focusRestaurantId: ""
+            page: "pages/MapView.qml"
+            pageProperties: ({ focusRestaurantId: focusRestaurantId })
+
+            Connections {
+                target: mapLoader.item
+                function onBackClicked() { stackView.pop() }
+                function onRestaurantSelected(restaurantId) {
+                    currentRestaurantId = restaurantId
+                    stackView.push(restaurantDetailComponent)
+                }
             }
         }
     }
@@ -152,7 +147,6 @@ ApplicationWindow {
             onLoginSuccessful: {
                 stackView.pop()  // Remove login page
                 stackView.push(homeComponent)  // Add home page
-                userController.getFavorites()  // Get favorites after navigation
             }
             onRegisterRequested: stackView.push(registerComponent)
         }
@@ -170,16 +164,22 @@ ApplicationWindow {
         }
     }
 
-    // Profile component
+    // Profile component, loaded on first use
     Component {
         id: profileComponent
-        ProfileView {
-            onBackClicked: stackView.pop()
-            onLogoutSuccessful: {
-                stackView.pop()
-                // Return to home and reset stack
-                while (stackView.depth > 1) {
+        PageLoader {
+            id: profileLoader
+            page: "pages/ProfileView.qml"
+
+            Connections {
+                target: profileLoader.item
+                function onBackClicked() { stackView.pop() }
+                function onLogoutSuccessful() {
                     stackView.pop()
+                    // Return to home and reset stack
+                    while (stackView.depth > 1) {
+                        stackView.pop()
+                    }
                 }
             }
         }
@@ -214,6 +214,17 @@ ApplicationWindow {
         }
     }
 
+    // Per-host network metrics, for --network-debug
+    NetworkHealthOverlay {
+        visible: networkDebug
+        anchors {
+            left: parent.left
+            bottom: parent.bottom
+            margins: 4
+        }
+        z: 100
+    }
+
     // Error notification
     Popup {
         id: errorPopup
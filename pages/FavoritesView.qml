@@ -11,11 +11,6 @@ Page {
     signal backClicked()
     signal restaurantSelected(string restaurantId)
     
-    Component.onCompleted: {
-        // Get user's favorite restaurants
-        userController.getFavorites()
-    }
-    
     header: ToolBar {
         RowLayout {
             anchors.fill: parent
@@ -23,7 +18,7 @@ Page {
             anchors.rightMargin: 10
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/arrow-left.svg"
+                icon.source: "qrc:/assets/icons/feather/arrow-left.svg"
                 onClicked: backClicked()
             }
             
@@ -36,7 +31,7 @@ Page {
             }
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/refresh-cw.svg"
+                icon.source: "qrc:/assets/icons/feather/refresh-cw.svg"
                 onClicked: userController.getFavorites()
                 enabled: !userController.loading
             }
@@ -51,63 +46,43 @@ Page {
         ListView {
             id: favoritesList
             width: parent.width
-            model: restaurantModel
+            // Projection of the store's favorites, not a filter over the search results
+            model: appController.favoritesModel
             clip: true
-            
-            // Custom filter to show only favorites
-            section.property: "isFavorite"
-            section.criteria: ViewSection.FullString
-            section.delegate: Item { visible: false; height: 0 }
-            
-            // Filters the model to only show favorites
-            Component.onCompleted: {
-                favoritesList.model = restaurantModel
-            }
+            reuseItems: true
+            cacheBuffer: 600
             
             delegate: RestaurantCard {
+                required property int index
+                required property var restaurant
+                
                 width: favoritesList.width
-                restaurantName: model.name
-                restaurantAddress: model.address
-                restaurantDistance: model.distance
-                restaurantRating: model.rating
-                isVegan: model.isVegan
-                isVegetarian: model.isVegetarian
-                isFavorite: model.isFavorite
-                visible: model.isFavorite
-                height: model.isFavorite ? implicitHeight : 0
+                restaurantName: restaurant.name
+                restaurantAddress: restaurant.address
+                restaurantDistance: restaurant.distance
+                restaurantRating: restaurant.rating
+                isVegan: restaurant.isVegan
+                isVegetarian: restaurant.isVegetarian
+                isFavorite: restaurant.isFavorite
                 
-                onClicked: {
-                    if (model.isFavorite) {
-                        restaurantSelected(model.id)
-                    }
-                }
+                onClicked: restaurantSelected(restaurant.id)
                 
                 onFavoriteToggled: {
-                    restaurantModel.toggleFavorite(index)
+                    favoritesList.model.toggleFavorite(index)
                 }
             }
             
             // Empty state
             Item {
                 anchors.fill: parent
-                visible: !hasVisibleItems() && !userController.loading
-                
-                function hasVisibleItems() {
-                    for (var i = 0; i < restaurantModel.rowCount(); i++) {
-                        var restaurant = restaurantModel.get(i)
-                        if (restaurant.isFavorite) {
-                            return true
-                        }
-                    }
-                    return false
-                }
+                visible: favoritesList.count === 0 && !userController.loading
                 
                 ColumnLayout {
                     anchors.centerIn: parent
                     spacing: 20
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/heart.svg"
+                        source: "qrc:/assets/icons/feather/heart.svg"
                         sourceSize.width: 48
                         sourceSize.height: 48
                         Layout.alignment: Qt.AlignHCenter
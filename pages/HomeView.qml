@@ -1,8 +1,6 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
-import QtLocation 5.15
-import QtPositioning 5.15
 
 Page {
     id: homePage
@@ -14,6 +12,14 @@ Page {
     signal openProfile()
     signal openFavorites()
     
+    // Warm the cache for the quick filters below so tapping them is instant
+    Component.onCompleted: {
+        appController.prefetchSearch("", 5000, "cafe")
+        appController.prefetchSearch("", 5000, "store")
+        appController.prefetchSearch("", 5000, "", 4)
+        appController.prefetchSearch("vegan", 5000)
+    }
+    
     header: ToolBar {
         height: 60
         
@@ -32,8 +38,8 @@ Page {
             
             ToolButton {
                 icon.source: userController.isLoggedIn ? 
-                    "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/user.svg" :
-                    "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/log-in.svg"
+                    "qrc:/assets/icons/feather/user.svg" :
+                    "qrc:/assets/icons/feather/log-in.svg"
                 onClicked: {
                     if (userController.isLoggedIn) {
                         openProfile()
@@ -122,7 +128,7 @@ Page {
                 
                 Button {
                     text: "View Map"
-                    icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/map.svg"
+                    icon.source: "qrc:/assets/icons/feather/map.svg"
                     Layout.fillWidth: true
                     height: 60
                     
@@ -135,7 +141,7 @@ Page {
                         spacing: 10
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/map.svg"
+                            source: "qrc:/assets/icons/feather/map.svg"
                             sourceSize.width: 24
                             sourceSize.height: 24
                             Layout.alignment: Qt.AlignVCenter
@@ -157,7 +163,7 @@ Page {
                 Button {
                     text: "My Favorites"
                     visible: userController.isLoggedIn
-                    icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/heart.svg"
+                    icon.source: "qrc:/assets/icons/feather/heart.svg"
                     Layout.fillWidth: true
                     height: 60
                     
@@ -170,7 +176,7 @@ Page {
                         spacing: 10
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/heart.svg"
+                            source: "qrc:/assets/icons/feather/heart.svg"
                             sourceSize.width: 24
                             sourceSize.height: 24
                             Layout.alignment: Qt.AlignVCenter
@@ -204,7 +210,7 @@ Page {
                     spacing: 15
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/map-pin.svg"
+                        source: "qrc:/assets/icons/feather/map-pin.svg"
                         sourceSize.width: 24
                         sourceSize.height: 24
                         Layout.alignment: Qt.AlignVCenter
@@ -246,7 +252,7 @@ Page {
                         spacing: 5
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/coffee.svg"
+                            source: "qrc:/assets/icons/feather/coffee.svg"
                             sourceSize.width: 32
                             sourceSize.height: 32
                             Layout.alignment: Qt.AlignHCenter
@@ -281,7 +287,7 @@ Page {
                         spacing: 5
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/shopping-bag.svg"
+                            source: "qrc:/assets/icons/feather/shopping-bag.svg"
                             sourceSize.width: 32
                             sourceSize.height: 32
                             Layout.alignment: Qt.AlignHCenter
@@ -316,7 +322,7 @@ Page {
                         spacing: 5
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/star.svg"
+                            source: "qrc:/assets/icons/feather/star.svg"
                             sourceSize.width: 32
                             sourceSize.height: 32
                             Layout.alignment: Qt.AlignHCenter
@@ -351,7 +357,7 @@ Page {
                         spacing: 5
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/check-circle.svg"
+                            source: "qrc:/assets/icons/feather/check-circle.svg"
                             sourceSize.width: 32
                             sourceSize.height: 32
                             Layout.alignment: Qt.AlignHCenter
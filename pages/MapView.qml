@@ -25,13 +25,10 @@ Page {
         
         // If a restaurant ID is provided, focus on it
         if (focusRestaurantId !== "") {
-            for (var i = 0; i < restaurantModel.rowCount(); i++) {
-                var restaurant = restaurantModel.get(i)
-                if (restaurant.id === focusRestaurantId) {
-                    map.center = QtPositioning.coordinate(restaurant.latitude, restaurant.longitude)
-                    map.zoomLevel = 15
-                    break
-                }
+            var restaurant = restaurantStore.get(focusRestaurantId)
+            if (restaurant.id !== undefined) {
+                map.center = QtPositioning.coordinate(restaurant.latitude, restaurant.longitude)
+                map.zoomLevel = 15
             }
         }
     }
@@ -43,7 +40,7 @@ Page {
             anchors.rightMargin: 10
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/arrow-left.svg"
+                icon.source: "qrc:/assets/icons/feather/arrow-left.svg"
                 onClicked: backClicked()
             }
             
@@ -56,8 +53,8 @@ Page {
             }
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/refresh-cw.svg"
-                onClicked: appController.refreshRestaurants()
+                icon.source: "qrc:/assets/icons/feather/refresh-cw.svg"
+                onClicked: startup.refresh()
                 enabled: !appController.loading
             }
         }
@@ -85,7 +82,7 @@ Page {
                 Image {
                     id: userMarkerImage
                     anchors.fill: parent
-                    source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/circle.svg"
+                    source: "qrc:/assets/icons/feather/circle.svg"
                     
 
                 }
@@ -109,7 +106,7 @@ Page {
                     Image {
                         id: restaurantMarkerImage
                         anchors.fill: parent
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/map-pin.svg"
+                        source: "qrc:/assets/icons/feather/map-pin.svg"
                         
 
                     }
@@ -144,7 +141,7 @@ Page {
             
             Image {
                 anchors.centerIn: parent
-                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/navigation.svg"
+                source: "qrc:/assets/icons/feather/navigation.svg"
                 width: 24
                 height: 24
 
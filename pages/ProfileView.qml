@@ -16,7 +16,7 @@ Page {
             anchors.rightMargin: 10
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/arrow-left.svg"
+                icon.source: "qrc:/assets/icons/feather/arrow-left.svg"
                 onClicked: backClicked()
             }
             
@@ -186,7 +186,7 @@ Page {
                             spacing: 15
                             
                             Image {
-                                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/settings.svg"
+                                source: "qrc:/assets/icons/feather/settings.svg"
                                 sourceSize.width: 24
                                 sourceSize.height: 24
                                 
@@ -201,7 +201,7 @@ Page {
                             }
                             
                             Image {
-                                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/chevron-right.svg"
+                                source: "qrc:/assets/icons/feather/chevron-right.svg"
                                 sourceSize.width: 20
                                 sourceSize.height: 20
                                 
@@ -240,7 +240,7 @@ Page {
                             spacing: 15
                             
                             Image {
-                                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/sliders.svg"
+                                source: "qrc:/assets/icons/feather/sliders.svg"
                                 sourceSize.width: 24
                                 sourceSize.height: 24
                                 
@@ -255,7 +255,7 @@ Page {
                             }
                             
                             Image {
-                                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/chevron-right.svg"
+                                source: "qrc:/assets/icons/feather/chevron-right.svg"
                                 sourceSize.width: 20
                                 sourceSize.height: 20
                                 
@@ -294,7 +294,7 @@ Page {
                             spacing: 15
                             
                             Image {
-                                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/help-circle.svg"
+                                source: "qrc:/assets/icons/feather/help-circle.svg"
                                 sourceSize.width: 24
                                 sourceSize.height: 24
                                 
@@ -309,7 +309,7 @@ Page {
                             }
                             
                             Image {
-                                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/chevron-right.svg"
+                                source: "qrc:/assets/icons/feather/chevron-right.svg"
                                 sourceSize.width: 20
                                 sourceSize.height: 20
                                 
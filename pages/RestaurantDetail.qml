@@ -14,12 +14,22 @@ Page {
     signal showOnMap()
     
     Component.onCompleted: {
-        // Find restaurant in the model by ID
-        for (var i = 0; i < restaurantModel.rowCount(); i++) {
-            var restaurant = restaurantModel.get(i)
-            if (restaurant.id === restaurantId) {
-                restaurantData = restaurant
-                break
+        restaurantData = restaurantStore.get(restaurantId)
+        // List rows are slim; the rest arrives through the store
+        detailService.load(restaurantId)
+    }
+    
+    // Favorite changes made on any page and fetched details show up here too
+    Connections {
+        target: restaurantStore
+        function onFavoriteChanged(id, isFavorite) {
+            if (id === restaurantId) {
+                restaurantData = restaurantStore.get(restaurantId)
+            }
+        }
+        function onRestaurantsChanged(ids) {
+            if (ids.indexOf(restaurantId) >= 0) {
+                restaurantData = restaurantStore.get(restaurantId)
             }
         }
     }
@@ -31,7 +41,7 @@ Page {
             anchors.rightMargin: 10
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/arrow-left.svg"
+                icon.source: "qrc:/assets/icons/feather/arrow-left.svg"
                 onClicked: backClicked()
             }
             
@@ -46,11 +56,11 @@ Page {
             ToolButton {
                 id: favoriteButton
                 icon.source: restaurantData && restaurantData.isFavorite ? 
-                    "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/heart.svg" :
-                    "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/heart.svg"
+                    "qrc:/assets/icons/feather/heart.svg" :
+                    "qrc:/assets/icons/feather/heart.svg"
                 
                 contentItem: Image {
-                    source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/heart.svg"
+                    source: "qrc:/assets/icons/feather/heart.svg"
                     sourceSize.width: 24
                     sourceSize.height: 24
                     fillMode: Image.PreserveAspectFit
@@ -58,18 +68,7 @@ Page {
 
                 }
                 
-                onClicked: {
-                    // Find index in model to toggle favorite
-                    for (var i = 0; i < restaurantModel.rowCount(); i++) {
-                        var restaurant = restaurantModel.get(i)
-                        if (restaurant.id === restaurantId) {
-                            restaurantModel.toggleFavorite(i)
-                            // Update local data
-                            restaurantData.isFavorite = !restaurantData.isFavorite
-                            break
-                        }
-                    }
-                }
+                onClicked: restaurantStore.toggleFavorite(restaurantId)
             }
         }
     }
@@ -113,6 +112,29 @@ Page {
                 Layout.margins: 15
                 spacing: 15
                 
+                // Photos, decoded off the GUI thread by the "remote" image provider
+                ListView {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 160
+                    orientation: ListView.Horizontal
+                    spacing: 8
+                    clip: true
+                    visible: restaurantData && restaurantData.photos && restaurantData.photos.count > 0
+                    // Child model of the restaurant row; no list is copied into QML
+                    model: restaurantData ? restaurantData.photos : null
+                    
+                    delegate: Image {
+                        required property string url
+                        
+                        width: 220
+                        height: 160
+                        source: "image://remote/" + encodeURIComponent(url)
+                        sourceSize.width: 220
+                        sourceSize.height: 160
+                        fillMode: Image.PreserveAspectCrop
+                    }
+                }
+                
                 // Tags row
                 RowLayout {
                     Layout.fillWidth: true
@@ -176,7 +198,7 @@ Page {
                         Layout.alignment: Qt.AlignRight
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/star.svg"
+                            source: "qrc:/assets/icons/feather/star.svg"
                             width: 18
                             height: 18
                             anchors.verticalCenter: parent.verticalCenter
@@ -199,7 +221,7 @@ Page {
                     spacing: 10
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/map-pin.svg"
+                        source: "qrc:/assets/icons/feather/map-pin.svg"
                         sourceSize.width: 20
                         sourceSize.height: 20
                         Layout.alignment: Qt.AlignTop
@@ -222,7 +244,7 @@ Page {
                     spacing: 10
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/navigation.svg"
+                        source: "qrc:/assets/icons/feather/navigation.svg"
                         sourceSize.width: 20
                         sourceSize.height: 20
                         
@@ -246,7 +268,7 @@ Page {
                     visible: restaurantData && restaurantData.phoneNumber !== ""
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/phone.svg"
+                        source: "qrc:/assets/icons/feather/phone.svg"
                         sourceSize.width: 20
                         sourceSize.height: 20
                         
@@ -267,7 +289,7 @@ Page {
                     visible: restaurantData && restaurantData.website !== ""
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/globe.svg"
+                        source: "qrc:/assets/icons/feather/globe.svg"
                         sourceSize.width: 20
                         sourceSize.height: 20
                         
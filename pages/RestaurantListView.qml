@@ -26,7 +26,7 @@ Page {
             anchors.rightMargin: 10
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/arrow-left.svg"
+                icon.source: "qrc:/assets/icons/feather/arrow-left.svg"
                 onClicked: backClicked()
             }
             
@@ -39,8 +39,8 @@ Page {
             }
             
             ToolButton {
-                icon.source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/refresh-cw.svg"
-                onClicked: appController.refreshRestaurants()
+                icon.source: "qrc:/assets/icons/feather/refresh-cw.svg"
+                onClicked: startup.refresh()
                 enabled: !appController.loading
             }
         }
@@ -56,13 +56,8 @@ Page {
             Layout.fillWidth: true
             Layout.preferredHeight: 60
             
-            onQueryChanged: {
-                    if (query.length >= 3) {
-                        appController.searchRestaurants(query)
-                    } else if (query.length === 0) {
-                        appController.refreshRestaurants()
-                    }
-                }
+            // Answered locally per keystroke; the controller falls back to the server
+            onQueryChanged: appController.typeahead(query)
         }
         
         // Filter bar
@@ -85,6 +80,21 @@ Page {
             }
         }
         
+        // Offline notice
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 32
+            color: "#fff8e1"
+            visible: appController.offline
+
+            Label {
+                anchors.centerIn: parent
+                text: "Offline - showing saved results"
+                font.pixelSize: 13
+                color: "#8d6e63"
+            }
+        }
+
         // Restaurant list
         ScrollView {
             Layout.fillWidth: true
@@ -96,19 +106,45 @@ Page {
                 width: parent.width
                 model: restaurantModel
                 clip: true
+                // Recycle delegates on fling
+                reuseItems: true
+                cacheBuffer: 600
+                
+                // Details for the rows on screen, once scrolling settles
+                function prefetchVisible() {
+                    var first = indexAt(0, contentY)
+                    var last = indexAt(0, contentY + height - 1)
+                    if (first < 0) {
+                        return
+                    }
+                    detailService.prefetch(restaurantModel.ids(first, last < 0 ? count - 1 : last))
+                }
+                
+                onContentYChanged: prefetchTimer.restart()
+                onCountChanged: prefetchTimer.restart()
+                
+                Timer {
+                    id: prefetchTimer
+                    interval: 250
+                    onTriggered: restaurantListView.prefetchVisible()
+                }
                 
                 delegate: RestaurantCard {
+                    // Required properties: the view fetches only these roles, no model context object
+                    required property int index
+                    required property var restaurant
+                    
                     width: restaurantListView.width
-                    restaurantName: model.name
-                    restaurantAddress: model.address
-                    restaurantDistance: model.distance
-                    restaurantRating: model.rating
-                    isVegan: model.isVegan
-                    isVegetarian: model.isVegetarian
-                    isFavorite: model.isFavorite
+                    restaurantName: restaurant.name
+                    restaurantAddress: restaurant.address
+                    restaurantDistance: restaurant.distance
+                    restaurantRating: restaurant.rating
+                    isVegan: restaurant.isVegan
+                    isVegetarian: restaurant.isVegetarian
+                    isFavorite: restaurant.isFavorite
                     
                     onClicked: {
-                        restaurantSelected(model.id)
+                        restaurantSelected(restaurant.id)
                     }
                     
                     onFavoriteToggled: {
@@ -126,7 +162,7 @@ Page {
                         spacing: 20
                         
                         Image {
-                            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/search.svg"
+                            source: "qrc:/assets/icons/feather/search.svg"
                             sourceSize.width: 48
                             sourceSize.height: 48
                             Layout.alignment: Qt.AlignHCenter
@@ -150,7 +186,7 @@ Page {
                         Button {
                             text: "Refresh"
                             Layout.alignment: Qt.AlignHCenter
-                            onClicked: appController.refreshRestaurants()
+                            onClicked: startup.refresh()
                         }
                     }
                 }
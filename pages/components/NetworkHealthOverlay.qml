@@ -0,0 +1,50 @@
+import QtQuick 2.15
+import QtQuick.Layouts 1.15
+
+// Debug overlay with networkHealth per host: round trip, timeout, error rate
+// and circuit state. Shown when the app is started with --network-debug.
+Rectangle {
+    id: overlay
+
+    width: content.implicitWidth + 16
+    height: content.implicitHeight + 12
+    radius: 4
+    color: "#cc212121"
+
+    function stateColor(state) {
+        if (state === "open") return "#ef5350"
+        if (state === "half-open") return "#ffb74d"
+        return "#81c784"
+    }
+
+    ColumnLayout {
+        id: content
+        anchors.centerIn: parent
+        spacing: 2
+
+        Text {
+            text: "requests " + networkHealth.requests
+                  + "  retries " + networkHealth.retries
+                  + "  refused " + networkHealth.rejected
+            color: networkHealth.degraded ? "#ffb74d" : "white"
+            font.pixelSize: 11
+            font.family: "monospace"
+        }
+
+        Repeater {
+            model: networkHealth.hosts
+
+            Text {
+                text: modelData.host
+                      + "  " + modelData.state
+                      + "  rtt " + (modelData.rttMs < 0 ? "-" : modelData.rttMs + "±" + modelData.rttVarMs) + " ms"
+                      + "  timeout " + modelData.timeoutMs + " ms"
+                      + "  err " + Math.round(modelData.errorRate * 100) + "%"
+                      + " (" + modelData.failures + "/" + modelData.requests + ")"
+                color: overlay.stateColor(modelData.state)
+                font.pixelSize: 11
+                font.family: "monospace"
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+
+// Loads a page file the first time it is shown, so its imports (QtLocation
+// for the map) and types are not compiled during startup
+Loader {
+    id: loader
+
+    property url page
+    property var pageProperties: ({})
+
+    asynchronous: true
+
+    Component.onCompleted: setSource(page, pageProperties)
+
+    BusyIndicator {
+        anchors.centerIn: parent
+        running: loader.status === Loader.Loading
+    }
+}
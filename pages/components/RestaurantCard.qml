@@ -84,7 +84,7 @@ Rectangle {
                 spacing: 4
                 
                 Image {
-                    source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/map-pin.svg"
+                    source: "qrc:/assets/icons/feather/map-pin.svg"
                     sourceSize.width: 14
                     sourceSize.height: 14
                     
@@ -110,7 +110,7 @@ Rectangle {
                     spacing: 4
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/navigation.svg"
+                        source: "qrc:/assets/icons/feather/navigation.svg"
                         sourceSize.width: 14
                         sourceSize.height: 14
                         
@@ -129,7 +129,7 @@ Rectangle {
                     spacing: 4
                     
                     Image {
-                        source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/star.svg"
+                        source: "qrc:/assets/icons/feather/star.svg"
                         sourceSize.width: 14
                         sourceSize.height: 14
                         
@@ -175,7 +175,7 @@ Rectangle {
             
             Image {
                 anchors.centerIn: parent
-                source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/heart.svg"
+                source: "qrc:/assets/icons/feather/heart.svg"
                 sourceSize.width: 22
                 sourceSize.height: 22
                 
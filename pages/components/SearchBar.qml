@@ -24,7 +24,7 @@ Rectangle {
 
         // Search icon
         Image {
-            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/search.svg"
+            source: "qrc:/assets/icons/feather/search.svg"
             sourceSize.width: 24
             sourceSize.height: 24
             Layout.alignment: Qt.AlignVCenter
@@ -49,7 +49,7 @@ Rectangle {
 
         // Clear button
         Image {
-            source: "https://cdn.jsdelivr.net/npm/feather-icons/dist/icons/x.svg"
+            source: "qrc:/assets/icons/feather/x.svg"
             sourceSize.width: 20
             sourceSize.height: 20
             Layout.alignment: Qt.AlignVCenter
@@ -0,0 +1,27 @@
+QT = core positioning sql testlib
+CONFIG += testcase console c++2a
+CONFIG -= app_bundle
+
+TARGET = tst_catalogfile
+
+APP_DIR = $$PWD/../..
+INCLUDEPATH += $$APP_DIR
+# The catalog is built by the backend script, so the test runs the real writer
+DEFINES += BUILD_CATALOG_SCRIPT=\\\"$$APP_DIR/backend/python/build_catalog.py\\\"
+
+SOURCES += \
+        tst_catalogfile.cpp \
+        $$APP_DIR/CatalogFile.cpp \
+        $$APP_DIR/GeoHashIndex.cpp \
+        $$APP_DIR/PhotoModel.cpp \
+        $$APP_DIR/RestaurantStore.cpp \
+        $$APP_DIR/ResturantModel.cpp \
+        $$APP_DIR/SearchIndex.cpp
+
+HEADERS += \
+    $$APP_DIR/CatalogFile.h \
+    $$APP_DIR/GeoHashIndex.h \
+    $$APP_DIR/PhotoModel.h \
+    $$APP_DIR/RestaurantStore.h \
+    $$APP_DIR/ResturantModel.h \
+    $$APP_DIR/SearchIndex.h
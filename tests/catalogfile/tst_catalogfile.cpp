@@ -0,0 +1,169 @@
+#include <QtTest>
+#include <QtEndian>
+#include <QProcess>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include "CatalogFile.h"
+
+class TestCatalogFile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void readsBuiltCatalog();
+    void findsRowsById();
+    void coversNearbyCells();
+    void rejectsBadPrecision_data();
+    void rejectsBadPrecision();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_path;
+
+    bool createDatabase(const QString &path);
+};
+
+bool TestCatalogFile::createDatabase(const QString &path)
+{
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "catalog");
+        db.setDatabaseName(path);
+        if (db.open()) {
+            QSqlQuery query(db);
+            ok = query.exec("CREATE TABLE restaurants (id TEXT PRIMARY KEY, name TEXT, address TEXT, "
+                            "phone_number TEXT, website TEXT, cuisine_type TEXT, description TEXT, "
+                            "latitude REAL, longitude REAL, rating INTEGER, is_vegan INTEGER, is_vegetarian INTEGER)")
+                    && query.exec("CREATE TABLE photos (id INTEGER PRIMARY KEY, restaurant_id TEXT, url TEXT)")
+                    // Two rows in one cell, so the writer has to break a tie
+                    && query.exec("INSERT INTO restaurants VALUES "
+                                  "('b-berlin', 'Café Grün', 'Torstraße 1', '', '', 'Vegan', 'Plant based', 52.5200, 13.4050, 5, 1, 1), "
+                                  "('a-berlin', 'Kohl', 'Torstraße 2', '', '', 'German', '', 52.5201, 13.4051, 3, 0, 1), "
+                                  "('c-tokyo', 'Ain Soph', '', '', '', 'Vegan', '', 35.6762, 139.6503, 4, 1, 1)")
+                    && query.exec("INSERT INTO photos (restaurant_id, url) VALUES "
+                                  "('b-berlin', 'https://example.com/1.jpg'), "
+                                  "('c-tokyo', 'https://example.com/3.jpg'), "
+                                  "('b-berlin', 'https://example.com/2.jpg')");
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("catalog");
+    return ok;
+}
+
+void TestCatalogFile::initTestCase()
+{
+    if (!QSqlDatabase::isDriverAvailable("QSQLITE")) {
+        QSKIP("Needs the QSQLITE driver");
+    }
+    QVERIFY(m_dir.isValid());
+    const QString db = m_dir.filePath("vegfinder.db");
+    m_path = m_dir.filePath("catalog.vcat");
+    QVERIFY(createDatabase(db));
+
+    QProcess python;
+    python.setWorkingDirectory(QFileInfo(BUILD_CATALOG_SCRIPT).absolutePath());
+    python.start("python3", { BUILD_CATALOG_SCRIPT, "--db", db, "--out", m_path });
+    if (!python.waitForStarted()) {
+        QSKIP("Needs python3 to build the catalog");
+    }
+    QVERIFY(python.waitForFinished(30000));
+    const QByteArray errors = python.readAllStandardError();
+    if (errors.contains("ModuleNotFoundError")) {
+        QSKIP("Needs the backend's Python dependencies");
+    }
+    QVERIFY2(python.exitCode() == 0, errors.constData());
+}
+
+void TestCatalogFile::readsBuiltCatalog()
+{
+    CatalogFile catalog;
+    QVERIFY2(catalog.open(m_path), qPrintable(catalog.errorString()));
+    QCOMPARE(catalog.size(), 3);
+
+    const Restaurant cafe = catalog.restaurant(catalog.indexOf("b-berlin"));
+    QCOMPARE(cafe.id, QString("b-berlin"));
+    QCOMPARE(cafe.name, QString("Café Grün"));
+    QCOMPARE(cafe.address, QString("Torstraße 1"));
+    QCOMPARE(cafe.cuisineType, QString("Vegan"));
+    QCOMPARE(cafe.description, QString("Plant based"));
+    QCOMPARE(cafe.latitude, 52.52);
+    QCOMPARE(cafe.longitude, 13.405);
+    QCOMPARE(cafe.rating, 5);
+    QVERIFY(cafe.isVegan);
+    QVERIFY(cafe.isVegetarian);
+    QVERIFY(cafe.detailed);
+    QCOMPARE(cafe.photos, QStringList({ "https://example.com/1.jpg", "https://example.com/2.jpg" }));
+
+    const Restaurant kohl = catalog.restaurant(catalog.indexOf("a-berlin"));
+    QVERIFY(!kohl.isVegan);
+    QVERIFY(kohl.isVegetarian);
+    QVERIFY(kohl.photos.isEmpty());
+    QCOMPARE(catalog.nameBytes(catalog.indexOf("a-berlin")), QByteArray("Kohl"));
+}
+
+void TestCatalogFile::findsRowsById()
+{
+    CatalogFile catalog;
+    QVERIFY(catalog.open(m_path));
+
+    for (const QString &id : { "a-berlin", "b-berlin", "c-tokyo" }) {
+        const int row = catalog.indexOf(id);
+        QVERIFY(row >= 0);
+        QCOMPARE(catalog.id(row), id);
+    }
+    QCOMPARE(catalog.indexOf("missing"), -1);
+    QCOMPARE(catalog.indexOf(""), -1);
+
+    // Ties within a cell are ordered by id
+    QCOMPARE(catalog.indexOf("b-berlin"), catalog.indexOf("a-berlin") + 1);
+}
+
+void TestCatalogFile::coversNearbyCells()
+{
+    CatalogFile catalog;
+    QVERIFY(catalog.open(m_path));
+
+    const QVector<int> berlin = catalog.candidates(52.52, 13.405, 500);
+    QVERIFY(berlin.contains(catalog.indexOf("a-berlin")));
+    QVERIFY(berlin.contains(catalog.indexOf("b-berlin")));
+    QVERIFY(!berlin.contains(catalog.indexOf("c-tokyo")));
+
+    QCOMPARE(catalog.candidates(35.6762, 139.6503, 500), QVector<int>({ catalog.indexOf("c-tokyo") }));
+    QVERIFY(catalog.candidates(0.0, 0.0, 500).isEmpty());
+}
+
+void TestCatalogFile::rejectsBadPrecision_data()
+{
+    QTest::addColumn<quint32>("precision");
+    QTest::newRow("zero") << quint32(0);
+    QTest::newRow("too fine") << quint32(13);
+    QTest::newRow("garbage") << quint32(0xFFFFFFFF);
+}
+
+void TestCatalogFile::rejectsBadPrecision()
+{
+    QFETCH(quint32, precision);
+
+    QFile built(m_path);
+    QVERIFY(built.open(QIODevice::ReadOnly));
+    QByteArray data = built.readAll();
+    // Header: magic[8], version, row count, cell count, precision
+    qToLittleEndian(precision, data.data() + 20);
+
+    const QString path = m_dir.filePath("precision.vcat");
+    QFile corrupt(path);
+    QVERIFY(corrupt.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(corrupt.write(data), qint64(data.size()));
+    corrupt.close();
+
+    CatalogFile catalog;
+    QVERIFY(!catalog.open(path));
+    QCOMPARE(catalog.errorString(), QString("Catalog file is corrupt"));
+    QVERIFY(!catalog.isOpen());
+}
+
+QTEST_GUILESS_MAIN(TestCatalogFile)
+#include "tst_catalogfile.moc"
@@ -0,0 +1,22 @@
+QT = core network testlib
+CONFIG += testcase console c++2a
+CONFIG -= app_bundle
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
+
+TARGET = tst_networkservice
+
+APP_DIR = $$PWD/../..
+INCLUDEPATH += $$APP_DIR
+
+SOURCES += \
+        tst_networkservice.cpp \
+        $$APP_DIR/AsyncReply.cpp \
+        $$APP_DIR/NetworkHealth.cpp \
+        $$APP_DIR/NetworkService.cpp \
+        $$APP_DIR/OfflineCache.cpp
+
+HEADERS += \
+    $$APP_DIR/AsyncReply.h \
+    $$APP_DIR/NetworkHealth.h \
+    $$APP_DIR/NetworkService.h \
+    $$APP_DIR/OfflineCache.h
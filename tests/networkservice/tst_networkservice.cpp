@@ -0,0 +1,204 @@
+#include <QtTest>
+#include <QTcpServer>
+#include "AsyncReply.h"
+#include "NetworkService.h"
+
+// A server that accepts connections and never answers, so requests stay in flight
+class SilentServer : public QTcpServer
+{
+public:
+    QUrl url() const
+    {
+        return QUrl(QString("http://127.0.0.1:%1/").arg(serverPort()));
+    }
+};
+
+class TestNetworkService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void backgroundingFinishesDroppedRequestsOnce();
+    void backgroundingCancelsAsyncReply();
+    void transferTimeoutIsReportedAsTimeout();
+    void cancelIsNotReportedAsTimeout();
+    void interactiveCountsAgainstGlobalLimit();
+    void interactivePreemptsSpeculativeWork();
+};
+
+void TestNetworkService::backgroundingFinishesDroppedRequestsOnce()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    NetworkService network;
+    network.setClassLimit(NetworkService::Prefetch, 1);
+    network.setClassLimit(NetworkService::Background, 1);
+
+    // Calls per request and whether each came without a reply
+    QHash<QString, int> calls;
+    QHash<QString, bool> dropped;
+    auto send = [&](const QString &name, NetworkService::Priority priority) {
+        QUrl url = server.url();
+        url.setPath("/" + name);
+        network.get(QNetworkRequest(url), priority, this, [&, name](QNetworkReply *reply) {
+            calls[name]++;
+            dropped[name] = reply == nullptr;
+            if (reply) {
+                reply->deleteLater();
+            }
+        });
+    };
+
+    send("prefetch-in-flight", NetworkService::Prefetch);
+    send("prefetch-queued", NetworkService::Prefetch);
+    send("background-in-flight", NetworkService::Background);
+    send("background-queued", NetworkService::Background);
+    send("normal", NetworkService::Normal);
+
+    network.setBackgrounded(true);
+
+    QCOMPARE(calls.value("prefetch-in-flight"), 1);
+    QCOMPARE(calls.value("prefetch-queued"), 1);
+    QCOMPARE(calls.value("background-queued"), 1);
+    QVERIFY(dropped.value("prefetch-in-flight"));
+    QVERIFY(dropped.value("prefetch-queued"));
+    QVERIFY(dropped.value("background-queued"));
+
+    // Already on the wire and not speculative: left to finish
+    QCOMPARE(calls.value("background-in-flight"), 0);
+    QCOMPARE(calls.value("normal"), 0);
+
+    // The aborted reply's finished() must not call the handler a second time
+    QTest::qWait(200);
+    QCOMPARE(calls.value("prefetch-in-flight"), 1);
+    QCOMPARE(calls.value("prefetch-queued"), 1);
+    QCOMPARE(calls.value("background-queued"), 1);
+}
+
+void TestNetworkService::backgroundingCancelsAsyncReply()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    NetworkService network;
+    network.setClassLimit(NetworkService::Prefetch, 1);
+    AsyncReply inFlight = AsyncReply::get(&network, QNetworkRequest(server.url()), NetworkService::Prefetch, this);
+    AsyncReply queued = AsyncReply::get(&network, QNetworkRequest(server.url()), NetworkService::Prefetch, this);
+    QVERIFY(!inFlight.isFinished());
+    QVERIFY(!queued.isFinished());
+
+    network.setBackgrounded(true);
+
+    QVERIFY(inFlight.isFinished());
+    QVERIFY(queued.isFinished());
+    QVERIFY(inFlight.await_resume().cancelled);
+    QVERIFY(queued.await_resume().cancelled);
+    QVERIFY(!queued.await_resume().timedOut);
+}
+
+void TestNetworkService::transferTimeoutIsReportedAsTimeout()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    NetworkService network;
+    QNetworkRequest request(server.url());
+    request.setTransferTimeout(100);
+    // A POST, so the scheduler does not retry it
+    AsyncReply reply = AsyncReply::post(&network, request, QByteArray(), NetworkService::Normal, this);
+
+    QTRY_VERIFY(reply.isFinished());
+    QVERIFY(reply.await_resume().timedOut);
+    QVERIFY(!reply.await_resume().cancelled);
+    QCOMPARE(network.health()->hosts().size(), 1);
+    QCOMPARE(network.health()->hosts().first().toMap().value("failures").toInt(), 1);
+}
+
+void TestNetworkService::cancelIsNotReportedAsTimeout()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    NetworkService network;
+    AsyncReply reply = AsyncReply::get(&network, QNetworkRequest(server.url()), NetworkService::Normal, this);
+    QTest::qWait(50);
+    reply.cancel();
+
+    QVERIFY(reply.isFinished());
+    QVERIFY(reply.await_resume().cancelled);
+    QVERIFY(!reply.await_resume().timedOut);
+
+    // The breaker only hears about the host, not about callers changing their mind
+    QTest::qWait(100);
+    QVERIFY(network.health()->hosts().isEmpty()
+            || network.health()->hosts().first().toMap().value("failures").toInt() == 0);
+}
+
+void TestNetworkService::interactiveCountsAgainstGlobalLimit()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    // Plain HTTP/1.1: one connection per request on the wire
+    int connections = 0;
+    connect(&server, &QTcpServer::newConnection, this, [&]() {
+        connections++;
+    });
+
+    NetworkService network;
+    network.setMaxConcurrentRequests(2);
+    auto ignore = [](QNetworkReply *reply) {
+        if (reply) {
+            reply->deleteLater();
+        }
+    };
+    const quint64 normal = network.get(QNetworkRequest(server.url()), NetworkService::Normal, this, ignore);
+    network.get(QNetworkRequest(server.url()), NetworkService::Normal, this, ignore);
+    network.get(QNetworkRequest(server.url()), NetworkService::Interactive, this, ignore);
+
+    // Normal requests cannot be preempted, so the interactive one waits for a slot
+    QTRY_COMPARE(connections, 2);
+    QTest::qWait(200);
+    QCOMPARE(connections, 2);
+
+    network.cancel(normal);
+    QTRY_COMPARE(connections, 3);
+}
+
+void TestNetworkService::interactivePreemptsSpeculativeWork()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    int connections = 0;
+    connect(&server, &QTcpServer::newConnection, this, [&]() {
+        connections++;
+    });
+
+    NetworkService network;
+    network.setMaxConcurrentRequests(2);
+    int prefetchCalls = 0;
+    auto prefetched = [&](QNetworkReply *reply) {
+        prefetchCalls++;
+        if (reply) {
+            reply->deleteLater();
+        }
+    };
+    network.get(QNetworkRequest(server.url()), NetworkService::Prefetch, this, prefetched);
+    network.get(QNetworkRequest(server.url()), NetworkService::Prefetch, this, prefetched);
+    QTRY_COMPARE(connections, 2);
+
+    network.get(QNetworkRequest(server.url()), NetworkService::Interactive, this, [](QNetworkReply *reply) {
+        if (reply) {
+            reply->deleteLater();
+        }
+    });
+
+    // One prefetch is pushed back to the queue to make room, and stays within the limit
+    QTRY_COMPARE(connections, 3);
+    QTest::qWait(200);
+    QCOMPARE(connections, 3);
+    QCOMPARE(prefetchCalls, 0);
+}
+
+QTEST_GUILESS_MAIN(TestNetworkService)
+#include "tst_networkservice.moc"
@@ -0,0 +1,15 @@
+QT = core testlib
+CONFIG += testcase console c++2a
+CONFIG -= app_bundle
+
+TARGET = tst_searchindex
+
+APP_DIR = $$PWD/../..
+INCLUDEPATH += $$APP_DIR
+
+SOURCES += \
+        tst_searchindex.cpp \
+        $$APP_DIR/SearchIndex.cpp
+
+HEADERS += \
+    $$APP_DIR/SearchIndex.h
@@ -0,0 +1,146 @@
+#include <QtTest>
+#include "SearchIndex.h"
+
+namespace {
+// About a whole-city offline catalog
+const int kCatalogSize = 50000;
+
+QStringList ids(const QVector<SearchIndex::Match> &matches)
+{
+    QStringList result;
+    for (const SearchIndex::Match &match : matches) {
+        result.append(match.id);
+    }
+    return result;
+}
+}
+
+class TestSearchIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void matchesWordPrefixes();
+    void requiresEveryToken();
+    void ranksNamesFirst();
+    void foldsCaseAndAccents();
+    void fallsBackToTrigrams();
+    void shortPrefixOnLargeIndex();
+    void searchLatency_data();
+    void searchLatency();
+
+private:
+    SearchIndex m_catalog;
+};
+
+void TestSearchIndex::initTestCase()
+{
+    for (int i = 0; i < kCatalogSize; ++i) {
+        m_catalog.insert(QString("r%1").arg(i), QString("Pizza Place %1").arg(i),
+                         QString("Pasta and pizza on street %1").arg(i % 500));
+    }
+    m_catalog.insert("pho", "Pho Unique", "Noodle soup");
+    QCOMPARE(m_catalog.size(), kCatalogSize + 1);
+}
+
+void TestSearchIndex::matchesWordPrefixes()
+{
+    SearchIndex index;
+    index.insert("garden", "Green Garden", "Fresh salads and soups");
+
+    QCOMPARE(ids(index.search("gar", 10)), QStringList({ "garden" }));
+    QCOMPARE(ids(index.search("Sal", 10)), QStringList({ "garden" }));
+    QCOMPARE(ids(index.search("green garden", 10)), QStringList({ "garden" }));
+    // Too short for trigrams, and not the start of a word
+    QVERIFY(index.search("ar", 10).isEmpty());
+    QVERIFY(index.search("pizza", 10).isEmpty());
+    QVERIFY(index.search("  ", 10).isEmpty());
+}
+
+void TestSearchIndex::requiresEveryToken()
+{
+    SearchIndex index;
+    index.insert("garden", "Green Garden", "Fresh salads and soups");
+    index.insert("barn", "Burger Barn", "Grilled patties");
+
+    QCOMPARE(ids(index.search("gr", 10)).size(), 2);
+    QCOMPARE(ids(index.search("green sal", 10)), QStringList({ "garden" }));
+    QCOMPARE(ids(index.search("bur gr", 10)), QStringList({ "barn" }));
+    QVERIFY(index.search("sal bur", 10).isEmpty());
+}
+
+void TestSearchIndex::ranksNamesFirst()
+{
+    SearchIndex index;
+    index.insert("oven", "Trattoria", "Wood fired pizza oven");
+    index.insert("roma", "Pizza Roma", "Family run");
+    index.insert("napoli", "Da Pizza Napoli", "Family run");
+
+    // Name starts with the query, then name word, then description word
+    QCOMPARE(ids(index.search("pizza", 10)), QStringList({ "roma", "napoli", "oven" }));
+    QCOMPARE(ids(index.search("pizza", 1)), QStringList({ "roma" }));
+}
+
+void TestSearchIndex::foldsCaseAndAccents()
+{
+    QCOMPARE(SearchIndex::fold("Café  GRÜN!"), QString("cafe grun"));
+    QCOMPARE(SearchIndex::fold("Crème-Brûlée"), QString("creme brulee"));
+
+    SearchIndex index;
+    index.insert("cafe", "Café Grün", "Crème brûlée");
+
+    QCOMPARE(ids(index.search("cafe grun", 10)), QStringList({ "cafe" }));
+    QCOMPARE(ids(index.search("CAFÉ", 10)), QStringList({ "cafe" }));
+    QCOMPARE(ids(index.search("creme brul", 10)), QStringList({ "cafe" }));
+}
+
+void TestSearchIndex::fallsBackToTrigrams()
+{
+    SearchIndex index;
+    index.insert("falafel", "Falafel House", "Wraps");
+
+    // A typo and an infix match; neither starts a word
+    QCOMPARE(ids(index.search("falafle", 10)), QStringList({ "falafel" }));
+    QCOMPARE(ids(index.search("afel", 10)), QStringList({ "falafel" }));
+    QVERIFY(index.search("zzzz", 10).isEmpty());
+
+    // Clean prefix hits rank above trigram matches
+    index.insert("afeli", "Afeli", "");
+    QCOMPARE(ids(index.search("afel", 10)), QStringList({ "afeli", "falafel" }));
+}
+
+void TestSearchIndex::shortPrefixOnLargeIndex()
+{
+    QCOMPARE(m_catalog.search("p", 10).size(), 10);
+    QCOMPARE(m_catalog.search("pi", 10).size(), 10);
+    QCOMPARE(ids(m_catalog.search("pho", 10)), QStringList({ "pho" }));
+
+    // A short token among selective ones still filters exactly
+    QCOMPARE(ids(m_catalog.search("p uniq", 10)), QStringList({ "pho" }));
+    QCOMPARE(ids(m_catalog.search("uniq p", 10)), QStringList({ "pho" }));
+    QCOMPARE(ids(m_catalog.search("n pho", 10)), QStringList({ "pho" }));
+    QVERIFY(m_catalog.search("x uniq", 10).isEmpty());
+}
+
+void TestSearchIndex::searchLatency_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::newRow("one char") << "p";
+    QTest::newRow("two chars") << "pi";
+    QTest::newRow("word") << "pizza";
+    QTest::newRow("two short tokens") << "p p";
+    QTest::newRow("word and short token") << "pizza pl";
+}
+
+void TestSearchIndex::searchLatency()
+{
+    QFETCH(QString, query);
+
+    QBENCHMARK {
+        m_catalog.search(query, 20);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestSearchIndex)
+#include "tst_searchindex.moc"
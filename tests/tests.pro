@@ -0,0 +1,7 @@
+# Unit tests, built apart from the app like benchmarks/soak; run with `make check`
+TEMPLATE = subdirs
+SUBDIRS += \
+    catalogfile \
+    networkservice \
+    searchindex \
+    usercontroller
@@ -0,0 +1,86 @@
+#include <QtTest>
+#include <QTcpServer>
+#include "NetworkService.h"
+#include "RestaurantStore.h"
+#include "TokenManager.h"
+#include "UserController.h"
+
+// A server that accepts connections and never answers, so requests stay in flight
+class SilentServer : public QTcpServer
+{
+public:
+    QString url(const QString &path) const
+    {
+        return QString("http://127.0.0.1:%1%2").arg(serverPort()).arg(path);
+    }
+};
+
+class TestUserController : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void logoutDuringLoginClearsLoading();
+    void logoutDuringFavoritesClearsLoading();
+};
+
+void TestUserController::initTestCase()
+{
+    // Settings, offline caches and the action journal go to throwaway locations
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication::setApplicationName("tst_usercontroller");
+}
+
+void TestUserController::logoutDuringLoginClearsLoading()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    NetworkService network;
+    RestaurantStore store;
+    TokenManager tokens(&network);
+    UserController user(&network, &store, &tokens);
+    user.setAuthUrl(server.url("/auth"));
+    user.setApiUrl(server.url("/api"));
+
+    user.login("alice", "secret");
+    QVERIFY(user.loading());
+
+    user.logout();
+    QVERIFY(!user.loading());
+
+    // The cancelled login must not turn the spinner back on
+    QTest::qWait(100);
+    QVERIFY(!user.loading());
+    QVERIFY(!user.isLoggedIn());
+}
+
+void TestUserController::logoutDuringFavoritesClearsLoading()
+{
+    SilentServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    NetworkService network;
+    RestaurantStore store;
+    TokenManager tokens(&network);
+    UserController user(&network, &store, &tokens);
+    user.setAuthUrl(server.url("/auth"));
+    user.setApiUrl(server.url("/api"));
+    tokens.setToken("token");
+    QVERIFY(user.isLoggedIn());
+
+    user.getFavorites();
+    QVERIFY(user.loading());
+
+    QSignalSpy loadingChanged(&user, &UserController::loadingChanged);
+    user.logout();
+    QVERIFY(!user.loading());
+    QCOMPARE(loadingChanged.count(), 1);
+
+    QTest::qWait(100);
+    QVERIFY(!user.loading());
+}
+
+QTEST_GUILESS_MAIN(TestUserController)
+#include "tst_usercontroller.moc"
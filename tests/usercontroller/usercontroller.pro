@@ -0,0 +1,42 @@
+QT = core network positioning testlib
+CONFIG += testcase console c++2a
+CONFIG -= app_bundle
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
+
+TARGET = tst_usercontroller
+
+APP_DIR = $$PWD/../..
+INCLUDEPATH += $$APP_DIR
+
+SOURCES += \
+        tst_usercontroller.cpp \
+        $$APP_DIR/ActionQueue.cpp \
+        $$APP_DIR/ApiBatch.cpp \
+        $$APP_DIR/AsyncReply.cpp \
+        $$APP_DIR/CatalogFile.cpp \
+        $$APP_DIR/GeoHashIndex.cpp \
+        $$APP_DIR/NetworkHealth.cpp \
+        $$APP_DIR/NetworkService.cpp \
+        $$APP_DIR/OfflineCache.cpp \
+        $$APP_DIR/PhotoModel.cpp \
+        $$APP_DIR/RestaurantStore.cpp \
+        $$APP_DIR/ResturantModel.cpp \
+        $$APP_DIR/SearchIndex.cpp \
+        $$APP_DIR/TokenManager.cpp \
+        $$APP_DIR/UserController.cpp
+
+HEADERS += \
+    $$APP_DIR/ActionQueue.h \
+    $$APP_DIR/ApiBatch.h \
+    $$APP_DIR/AsyncReply.h \
+    $$APP_DIR/CatalogFile.h \
+    $$APP_DIR/GeoHashIndex.h \
+    $$APP_DIR/NetworkHealth.h \
+    $$APP_DIR/NetworkService.h \
+    $$APP_DIR/OfflineCache.h \
+    $$APP_DIR/PhotoModel.h \
+    $$APP_DIR/RestaurantStore.h \
+    $$APP_DIR/ResturantModel.h \
+    $$APP_DIR/SearchIndex.h \
+    $$APP_DIR/TokenManager.h \
+    $$APP_DIR/UserController.h